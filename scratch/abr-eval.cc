@@ -0,0 +1,714 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Trace-driven evaluation of the adaptation algorithms without the network
+//   simulation, for quick iteration before a run of scratch/dash
+// - Every session streams the video over a throughput trace: a segment
+//   arrives one rtt after its request plus its size over the throughput of
+//   the trace; buffer and playback follow TcpStreamClient::Controller
+// - The sessions, every algorithm on every trace from several start offsets,
+//   run on a pool of threads; one line per session is written to the output
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("AbrEval");
+
+namespace {
+
+// split a comma separated command line value
+std::vector<std::string> Split(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+// creating and destroying ns-3 objects copies the shared attribute values
+// and checkers of their TypeId, whose reference counts are not atomic
+std::mutex g_objectMutex;
+
+/**
+ * \brief A throughput trace, repeated for as long as a session lasts.
+ *
+ * One "time throughput" line per step, in seconds and Mbit/s; every
+ * throughput holds until the time of the next line, the last one as long as
+ * the step before it. The bits delivered up to every step are summed up
+ * once, so the arrival time of a download is a binary search.
+ */
+class ThroughputTrace {
+ public:
+  bool Load(const std::string &file) {
+    std::ifstream trace(file.c_str());
+    if (!trace) return false;
+    std::vector<double> times;
+    std::string temp;
+    while (std::getline(trace, temp)) {
+      std::istringstream fields(temp);
+      double time, throughput;
+      if (fields >> time >> throughput) {
+        times.push_back(time);
+        m_rate.push_back(std::max(throughput, 0.0));  // Mbit/s = bit/us
+      }
+    }
+    if (times.empty()) return false;
+    for (uint32_t i = 0; i < times.size(); i++) {
+      m_time.push_back((times[i] - times.front()) * 1000000);
+    }
+    int64_t last = m_time.size() > 1
+                       ? m_time.back() - m_time[m_time.size() - 2]
+                       : 1000000;
+    m_period = m_time.back() + std::max<int64_t>(last, 1);
+    m_bits.push_back(0);
+    for (uint32_t i = 0; i + 1 < m_time.size(); i++) {
+      m_bits.push_back(m_bits.back() +
+                       m_rate[i] * (m_time[i + 1] - m_time[i]));
+    }
+    m_periodBits = m_bits.back() + m_rate.back() * (m_period - m_time.back());
+    return m_periodBits > 0;
+  }
+
+  /**
+   * \return the time in microseconds when bytes sent from start have
+   * arrived
+   */
+  int64_t Transfer(int64_t start, int64_t bytes) const {
+    if (bytes <= 0) return start;
+    // bits delivered since the start of the trace
+    int64_t cycles = start / m_period;
+    int64_t within = start - cycles * m_period;
+    uint32_t step =
+        std::upper_bound(m_time.begin(), m_time.end(), within) -
+        m_time.begin() - 1;
+    double target = cycles * m_periodBits + m_bits[step] +
+                    m_rate[step] * (within - m_time[step]) + 8.0 * bytes;
+    // the step the last bit arrives in
+    cycles = (int64_t)(target / m_periodBits);
+    double rest = std::max(target - cycles * m_periodBits, 0.0);
+    uint32_t reach =
+        std::lower_bound(m_bits.begin(), m_bits.end(), rest) - m_bits.begin();
+    step = reach > 0 ? reach - 1 : 0;
+    int64_t end = cycles * m_period + m_time[step];
+    if (rest > m_bits[step]) {
+      // bits are only delivered in a step with throughput
+      end += (int64_t)std::ceil((rest - m_bits[step]) / m_rate[step]);
+    }
+    return std::max(end, start);
+  }
+
+  int64_t GetPeriod(void) const { return m_period; }
+
+ private:
+  std::vector<int64_t> m_time;  //!< start of every step in microseconds
+  std::vector<double> m_rate;   //!< throughput of every step in bit/us
+  std::vector<double> m_bits;   //!< bits delivered before every step
+  int64_t m_period;             //!< duration of the trace in microseconds
+  double m_periodBits;          //!< bits delivered over the whole trace
+};
+
+/**
+ * \brief One streaming session: an algorithm on a trace from an offset.
+ */
+struct sessionConfig {
+  std::string algorithm;
+  TypeId adaptation;
+  TypeId bandwidth;
+  TypeId userinfo;
+  uint32_t trace;  //!< index of the trace
+  int64_t offset;  //!< time of the trace the session starts at, us
+};
+
+/**
+ * \brief The QoE metrics of a session.
+ */
+struct sessionResult {
+  bool valid;
+  double averageBitrate;  //!< mean bitrate of the played segments, bps
+  int64_t switches;       //!< representation changes
+  int64_t rebuffers;      //!< number of stalls after the start
+  double rebufferTime;    //!< seconds stalled after the start
+  double startupDelay;    //!< seconds until the first segment plays
+  double duration;        //!< seconds until the last segment played
+  int64_t decisions;      //!< calls of the adaptation algorithm
+};
+
+/**
+ * \brief Streams the video over a throughput trace in virtual time.
+ *
+ * Holds the videoData, playbackData, bufferData and throughputData of a
+ * client, and fills them exactly as TcpStreamClient does: the state machine
+ * of Controller, SegmentReceivedHandle and PlaybackHandle is the one of the
+ * client, only the network is replaced by the trace.
+ */
+class StreamingSession {
+ public:
+  StreamingSession(const videoData &video, const ThroughputTrace &trace,
+                   const sessionConfig &config, int64_t rtt)
+      : m_videoData(video),
+        m_trace(trace),
+        m_config(config),
+        m_rtt(rtt),
+        m_now(0),
+        m_sequence(0),
+        state(initial),
+        m_segmentCounter(0),
+        m_currentRepIndex(0),
+        m_currentPlaybackIndex(0),
+        m_segmentsInBuffer(0),
+        m_bufferUnderrun(false),
+        m_underrunStart(0),
+        m_bDelay(0),
+        m_downloadRequestSent(0),
+        m_transmissionStart(0) {
+    m_lastSegmentIndex = (int64_t)m_videoData.segmentSize[0][0].size() - 1;
+    m_result.valid = false;
+    m_result.switches = 0;
+    m_result.rebuffers = 0;
+    m_result.rebufferTime = 0;
+    m_result.decisions = 0;
+  }
+
+  sessionResult Run(void) {
+    {
+      std::lock_guard<std::mutex> lock(g_objectMutex);
+      userinfoAlgo = AlgorithmRegistry<UserinfoAlgorithm>::Create(
+          m_config.userinfo, m_videoData, m_playbackData, m_bufferData,
+          m_throughput);
+      bandwidthAlgo = AlgorithmRegistry<BandwidthAlgorithm>::Create(
+          m_config.bandwidth, m_videoData, m_playbackData, m_bufferData,
+          m_throughput);
+      algo = AlgorithmRegistry<AdaptationAlgorithm>::Create(
+          m_config.adaptation, m_videoData, m_playbackData, m_bufferData,
+          m_throughput);
+      if (algo != 0 && bandwidthAlgo != 0 && userinfoAlgo != 0) {
+        userinfoAlgo->Initialize();
+        bandwidthAlgo->Initialize();
+        algo->Initialize();
+      }
+    }
+    if (algo != 0 && bandwidthAlgo != 0 && userinfoAlgo != 0) {
+      AlgorithmClock::SetThreadClock(&m_now);
+      Controller(downloadFinished);
+      while (state != terminal && !m_events.empty()) {
+        scheduledEvent next = m_events.top();
+        m_events.pop();
+        m_now = next.time;
+        if (next.event == segmentReceived) {
+          SegmentReceivedHandle();
+        } else {
+          Controller(next.event);
+        }
+      }
+      AlgorithmClock::SetThreadClock(0);
+      Summarize();
+    }
+    std::lock_guard<std::mutex> lock(g_objectMutex);
+    if (algo != 0) algo->Dispose();
+    if (bandwidthAlgo != 0) bandwidthAlgo->Dispose();
+    if (userinfoAlgo != 0) userinfoAlgo->Dispose();
+    algo = 0;
+    bandwidthAlgo = 0;
+    userinfoAlgo = 0;
+    return m_result;
+  }
+
+ private:
+  // the events of TcpStreamClient::Controller, and the arrival of the last
+  // byte of a segment, which calls SegmentReceivedHandle in the client
+  enum sessionEvent {
+    downloadFinished,
+    playbackFinished,
+    irdFinished,
+    segmentReceived
+  };
+  enum controllerState {
+    initial,
+    downloading,
+    downloadingPlaying,
+    playing,
+    terminal
+  };
+  struct scheduledEvent {
+    int64_t time;
+    uint64_t sequence;  //!< events at the same time run in schedule order
+    sessionEvent event;
+    bool operator<(const scheduledEvent &other) const {
+      return time != other.time ? time > other.time
+                                : sequence > other.sequence;
+    }
+  };
+
+  void Schedule(int64_t delay, sessionEvent event) {
+    scheduledEvent scheduled;
+    scheduled.time = m_now + delay;
+    scheduled.sequence = m_sequence++;
+    scheduled.event = event;
+    m_events.push(scheduled);
+  }
+
+  void Controller(sessionEvent event) {
+    if (state == initial) {
+      RequestRepIndex();
+      state = downloading;
+      RequestSegment();
+      return;
+    }
+    if (state == downloading) {
+      PlaybackHandle();
+      if (m_currentPlaybackIndex <= m_lastSegmentIndex) {
+        m_segmentCounter++;
+        RequestRepIndex();
+        state = downloadingPlaying;
+        RequestSegment();
+      } else {
+        state = playing;
+      }
+      Schedule(m_videoData.segmentDuration, playbackFinished);
+      return;
+    } else if (state == downloadingPlaying) {
+      if (event == downloadFinished) {
+        if (m_segmentCounter < m_lastSegmentIndex) {
+          m_segmentCounter++;
+          RequestRepIndex();
+        }
+        if (m_bDelay > 0 && m_segmentCounter <= m_lastSegmentIndex) {
+          state = playing;
+          Schedule(m_bDelay, irdFinished);
+        } else if (m_segmentCounter == m_lastSegmentIndex) {
+          state = playing;
+        } else {
+          RequestSegment();
+        }
+      } else if (event == playbackFinished) {
+        if (!PlaybackHandle()) {
+          Schedule(m_videoData.segmentDuration, playbackFinished);
+        } else {
+          state = downloading;
+        }
+      }
+      return;
+    } else if (state == playing) {
+      if (event == irdFinished) {
+        state = downloadingPlaying;
+        RequestSegment();
+      } else if (event == playbackFinished &&
+                 m_currentPlaybackIndex < m_lastSegmentIndex) {
+        PlaybackHandle();
+        Schedule(m_videoData.segmentDuration, playbackFinished);
+      } else if (event == playbackFinished &&
+                 m_currentPlaybackIndex == m_lastSegmentIndex) {
+        PlaybackHandle();
+        state = terminal;
+      }
+      return;
+    }
+  }
+
+  void RequestRepIndex(void) {
+    userinfoAlgoReply userinfoanswer =
+        userinfoAlgo->UserinfoAlgo(m_segmentCounter, 0);
+    if (userinfoanswer.viewpoint >= 0 &&
+        userinfoanswer.viewpoint < (int64_t)m_videoData.segmentSize.size()) {
+      m_videoData.userInfo.at(m_segmentCounter) = userinfoanswer.viewpoint;
+    }
+    bandwidthAlgoReply bandwidthanswer =
+        bandwidthAlgo->BandwidthAlgo(m_segmentCounter, 0);
+    algorithmReply answer = algo->GetNextRep(
+        m_segmentCounter, 0, bandwidthanswer.bandwidthEstimate);
+    m_result.decisions++;
+
+    m_videoData.repIndex.push_back(answer.nextRepIndex);
+    m_currentRepIndex = answer.nextRepIndex;
+    m_faceRepIndex = answer.faceRepIndex;
+    m_playbackData.playbackIndex.push_back(answer.nextRepIndex);
+    m_bDelay = answer.nextDownloadDelay;
+  }
+
+  int64_t GetFaceBytes(uint32_t face) const {
+    return m_videoData.segmentSize.at(face)
+        .at(m_faceRepIndex.at(face))
+        .at(m_segmentCounter);
+  }
+
+  void RequestSegment(void) {
+    m_downloadRequestSent = m_now;
+    // the trace is shifted by the offset of the session
+    int64_t arrival = m_now + m_config.offset;
+    if (m_faceRepIndex.empty()) {
+      arrival += m_rtt;
+      m_transmissionStart = arrival - m_config.offset;
+      arrival = m_trace.Transfer(
+          arrival, m_videoData.segmentSize
+                       .at(m_videoData.userInfo.at(m_segmentCounter))
+                       .at(m_currentRepIndex)
+                       .at(m_segmentCounter));
+    } else {
+      // the client requests every face once the previous one arrived
+      for (uint32_t face = 0; face < m_faceRepIndex.size(); face++) {
+        arrival += m_rtt;
+        if (face == 0) m_transmissionStart = arrival - m_config.offset;
+        arrival = m_trace.Transfer(arrival, GetFaceBytes(face));
+      }
+    }
+    Schedule(arrival - m_config.offset - m_now, segmentReceived);
+  }
+
+  int64_t GetSegmentBytes(void) const {
+    if (m_faceRepIndex.empty()) {
+      return m_videoData.segmentSize
+          .at(m_videoData.userInfo.at(m_segmentCounter))
+          .at(m_currentRepIndex)
+          .at(m_segmentCounter);
+    }
+    int64_t bytes = 0;
+    for (uint32_t face = 0; face < m_faceRepIndex.size(); face++) {
+      bytes += GetFaceBytes(face);
+    }
+    return bytes;
+  }
+
+  void SegmentReceivedHandle(void) {
+    m_bufferData.timeNow.push_back(m_now);
+    if (m_segmentCounter > 0) {
+      m_bufferData.bufferLevelOld.push_back(std::max(
+          m_bufferData.bufferLevelNew.back() -
+              (m_now - m_throughput.transmissionEnd.back()),
+          (int64_t)0));
+    } else {
+      m_bufferData.bufferLevelOld.push_back(0);  // first segment
+    }
+    m_bufferData.bufferLevelNew.push_back(m_bufferData.bufferLevelOld.back() +
+                                          m_videoData.segmentDuration);
+
+    m_throughput.bytesReceived.push_back(GetSegmentBytes());
+    m_throughput.transmissionStart.push_back(m_transmissionStart);
+    m_throughput.transmissionRequested.push_back(m_downloadRequestSent);
+    m_throughput.transmissionEnd.push_back(m_now);
+
+    // the quality the segment is played in
+    const std::vector<double> &bitrates = m_videoData.averageBitrate.at(
+        m_videoData.userInfo.at(m_segmentCounter));
+    m_playedBitrates.push_back(bitrates.at(m_currentRepIndex));
+    if (m_segmentCounter > 0 &&
+        m_videoData.repIndex.at(m_segmentCounter) !=
+            m_videoData.repIndex.at(m_segmentCounter - 1)) {
+      m_result.switches++;
+    }
+
+    m_segmentsInBuffer++;
+    if (m_segmentCounter == m_lastSegmentIndex) {
+      m_bDelay = 0;
+    }
+    Controller(downloadFinished);
+  }
+
+  bool PlaybackHandle(void) {
+    if (m_segmentsInBuffer == 0 &&
+        m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun) {
+      m_bufferUnderrun = true;
+      m_underrunStart = m_now;
+      return true;
+    } else if (m_segmentsInBuffer > 0) {
+      if (m_bufferUnderrun) {
+        m_bufferUnderrun = false;
+        m_result.rebuffers++;
+        m_result.rebufferTime += (m_now - m_underrunStart) / 1000000.0;
+      }
+      m_playbackData.playbackStart.push_back(m_now);
+      m_segmentsInBuffer--;
+      m_currentPlaybackIndex++;
+      return false;
+    }
+    return true;
+  }
+
+  void Summarize(void) {
+    if (m_playbackData.playbackStart.empty()) {
+      return;
+    }
+    m_result.valid = state == terminal;
+    m_result.averageBitrate =
+        std::accumulate(m_playedBitrates.begin(), m_playedBitrates.end(),
+                        0.0) /
+        m_playedBitrates.size();
+    m_result.startupDelay = m_playbackData.playbackStart.front() / 1000000.0;
+    m_result.duration =
+        (m_playbackData.playbackStart.back() + m_videoData.segmentDuration) /
+        1000000.0;
+  }
+
+  videoData m_videoData;  //!< copied, the viewport predictor writes into it
+  playbackData m_playbackData;
+  bufferData m_bufferData;
+  throughputData m_throughput;
+  const ThroughputTrace &m_trace;
+  const sessionConfig &m_config;
+  const int64_t m_rtt;
+
+  int64_t m_now;  //!< virtual time of the session in microseconds
+  uint64_t m_sequence;
+  std::priority_queue<scheduledEvent> m_events;
+
+  Ptr<AdaptationAlgorithm> algo;
+  Ptr<BandwidthAlgorithm> bandwidthAlgo;
+  Ptr<UserinfoAlgorithm> userinfoAlgo;
+
+  controllerState state;
+  int64_t m_segmentCounter;
+  int64_t m_lastSegmentIndex;
+  int64_t m_currentRepIndex;
+  std::vector<int64_t> m_faceRepIndex;
+  int64_t m_currentPlaybackIndex;
+  int64_t m_segmentsInBuffer;
+  bool m_bufferUnderrun;
+  int64_t m_underrunStart;
+  int64_t m_bDelay;
+  int64_t m_downloadRequestSent;
+  int64_t m_transmissionStart;
+  std::vector<double> m_playedBitrates;
+  sessionResult m_result;
+};
+
+// the segment sizes and average bitrates exactly as
+// TcpStreamClient::ReadInBitrateValues reads them
+bool ReadVideo(const std::vector<std::string> &segmentSizeFiles,
+               const std::string &userInfoFile, int64_t segmentDuration,
+               videoData &video) {
+  video.segmentDuration = segmentDuration;
+  for (uint32_t i = 0; i < segmentSizeFiles.size(); i++) {
+    std::ifstream sizes(segmentSizeFiles[i].c_str());
+    if (!sizes) return false;
+    std::vector<std::vector<int64_t>> comb;
+    std::vector<double> avBit;
+    std::string temp;
+    while (std::getline(sizes, temp)) {
+      if (temp.empty()) break;
+      std::istringstream buffer(temp);
+      std::vector<int64_t> line((std::istream_iterator<int64_t>(buffer)),
+                                std::istream_iterator<int64_t>());
+      if (segmentDuration != 1000000) {
+        int64_t alpha = segmentDuration / 1000000;
+        for (auto it = line.begin(); it != line.end(); ++it) {
+          *it = *it * alpha;
+        }
+      }
+      int64_t averageByteSize =
+          (int64_t)std::accumulate(line.begin(), line.end(), 0.0) /
+          line.size();
+      avBit.push_back((8.0 * averageByteSize) /
+                      (segmentDuration / 1000000.0));
+      comb.push_back(line);
+    }
+    if (comb.empty()) return false;
+    video.segmentSize.push_back(comb);
+    video.averageBitrate.push_back(avBit);
+    video.ladders.push_back(BitrateLadder(comb, avBit));
+  }
+  std::ifstream info(userInfoFile.c_str());
+  for (int64_t s; info >> s;) video.userInfo.push_back(s);
+  if (video.userInfo.size() < video.segmentSize[0][0].size()) {
+    video.userInfo.resize(video.segmentSize[0][0].size(), 0);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  LogComponentEnable("AbrEval", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 1000000;
+  std::string segmentSizeFiles = "SegmentSize.txt";  // one per viewpoint
+  std::string userInfoFile = "UserInfo.txt";
+  std::string algorithms = "tobasco,tomato,festive,sara";
+  std::string traces = "";
+  uint32_t offsets = 1;
+  int64_t rtt = 20000;
+  uint32_t threads = std::thread::hardware_concurrency();
+  std::string output = "abr-eval.txt";
+
+  CommandLine cmd;
+  cmd.Usage("Trace-driven evaluation of the adaptation algorithms.\n");
+  cmd.AddValue("segmentDuration",
+               "The duration of a video segment in microseconds",
+               segmentDuration);
+  cmd.AddValue("segmentSizeFiles",
+               "Comma separated segment size files, one per viewpoint",
+               segmentSizeFiles);
+  cmd.AddValue("userInfoFile", "File with the viewpoint of every segment",
+               userInfoFile);
+  cmd.AddValue("algorithms",
+               "Comma separated algorithms, presets or TypeId names as for "
+               "adaptationAlgo of scratch/dash",
+               algorithms);
+  cmd.AddValue("traces",
+               "Comma separated throughput traces, one \"time throughput\" "
+               "line per step in s and Mbit/s",
+               traces);
+  cmd.AddValue("offsets",
+               "Number of sessions per algorithm and trace, starting at "
+               "evenly spread times of the trace",
+               offsets);
+  cmd.AddValue("rtt",
+               "Microseconds from a request to the first byte of the segment",
+               rtt);
+  cmd.AddValue("threads", "Number of threads running sessions", threads);
+  cmd.AddValue("output", "The file the result of every session is written to",
+               output);
+  cmd.Parse(argc, argv);
+
+  videoData video;
+  if (!ReadVideo(Split(segmentSizeFiles), userInfoFile, segmentDuration,
+                 video)) {
+    NS_LOG_ERROR("Opening test bitrate file failed.");
+    return 1;
+  }
+  std::vector<std::string> traceFiles = Split(traces);
+  std::vector<ThroughputTrace> throughputTraces(traceFiles.size());
+  for (uint32_t i = 0; i < traceFiles.size(); i++) {
+    if (!throughputTraces[i].Load(traceFiles[i])) {
+      NS_LOG_ERROR("Reading the throughput trace " << traceFiles[i]
+                                                   << " failed.");
+      return 1;
+    }
+  }
+  if (throughputTraces.empty()) {
+    NS_LOG_ERROR("No throughput trace given.");
+    return 1;
+  }
+
+  // the estimator and predictor of non-preset algorithms are those the
+  // client is configured with
+  Ptr<TcpStreamClient> client = CreateObject<TcpStreamClient>();
+  TypeIdValue bandwidthTid, userinfoTid;
+  client->GetAttribute("BandwidthAlgorithm", bandwidthTid);
+  client->GetAttribute("UserinfoAlgorithm", userinfoTid);
+
+  std::vector<sessionConfig> sessions;
+  std::vector<std::string> algorithmNames = Split(algorithms);
+  for (uint32_t a = 0; a < algorithmNames.size(); a++) {
+    sessionConfig config;
+    config.algorithm = algorithmNames[a];
+    config.bandwidth = bandwidthTid.Get();
+    config.userinfo = userinfoTid.Get();
+    if (!TcpStreamClient::LookupAlgorithms(config.algorithm, config.adaptation,
+                                           config.bandwidth,
+                                           config.userinfo)) {
+      NS_LOG_ERROR("Invalid algorithm name " << config.algorithm << ".");
+      return 1;
+    }
+    for (uint32_t t = 0; t < throughputTraces.size(); t++) {
+      for (uint32_t o = 0; o < offsets; o++) {
+        config.trace = t;
+        config.offset = throughputTraces[t].GetPeriod() / offsets * o;
+        sessions.push_back(config);
+      }
+    }
+  }
+
+  // every worker takes the next session until all are done
+  std::vector<sessionResult> results(sessions.size());
+  std::atomic<uint32_t> next(0);
+  std::vector<std::thread> workers;
+  threads = std::max<uint32_t>(
+      1, std::min<uint32_t>(threads, sessions.size()));
+  NS_LOG_INFO("Running " << sessions.size() << " sessions on " << threads
+                         << " threads");
+  SystemWallClockMs clock;
+  clock.Start();
+  for (uint32_t w = 0; w < threads; w++) {
+    workers.push_back(std::thread([&]() {
+      for (uint32_t s = next++; s < sessions.size(); s = next++) {
+        StreamingSession session(video, throughputTraces[sessions[s].trace],
+                                 sessions[s], rtt);
+        results[s] = session.Run();
+      }
+    }));
+  }
+  for (uint32_t w = 0; w < workers.size(); w++) {
+    workers[w].join();
+  }
+  int64_t elapsed = std::max<int64_t>(clock.End(), 1);
+
+  std::ofstream out(output.c_str());
+  out << "Algorithm Trace Offset AvgBitrate Switches Rebuffers RebufferTime "
+         "StartupDelay Duration\n";
+  // per algorithm: sessions, bitrate, switches, rebuffer time, startup delay
+  std::map<std::string, std::vector<double>> summary;
+  for (uint32_t s = 0; s < sessions.size(); s++) {
+    const sessionResult &result = results[s];
+    if (!result.valid) {
+      NS_LOG_INFO("Session " << s << " of " << sessions[s].algorithm
+                             << " did not finish");
+      continue;
+    }
+    out << sessions[s].algorithm << " " << traceFiles[sessions[s].trace] << " "
+        << sessions[s].offset / 1000000.0 << " " << std::fixed
+        << std::setprecision(0) << result.averageBitrate << " "
+        << result.switches << " " << result.rebuffers << " "
+        << std::setprecision(3) << result.rebufferTime << " "
+        << result.startupDelay << " " << result.duration << "\n";
+    out.unsetf(std::ios_base::floatfield);
+    std::vector<double> &total = summary[sessions[s].algorithm];
+    total.resize(5, 0.0);
+    total[0] += 1;
+    total[1] += result.averageBitrate;
+    total[2] += result.switches;
+    total[3] += result.rebufferTime;
+    total[4] += result.startupDelay;
+  }
+  out.close();
+  if (!out) {
+    NS_LOG_ERROR("Writing " << output << " failed.");
+    return 1;
+  }
+
+  for (std::map<std::string, std::vector<double>>::const_iterator it =
+           summary.begin();
+       it != summary.end(); ++it) {
+    const std::vector<double> &total = it->second;
+    NS_LOG_INFO(it->first << ": " << total[0] << " sessions, bitrate "
+                          << total[1] / total[0] / 1000000.0
+                          << " Mbps, switches " << total[2] / total[0]
+                          << ", rebuffering " << total[3] / total[0]
+                          << " s, startup " << total[4] / total[0] << " s");
+  }
+  NS_LOG_INFO(sessions.size() << " sessions in " << elapsed << " ms, "
+                              << sessions.size() * 1000.0 / elapsed
+                              << " sessions/s, written to " << output);
+  return 0;
+}
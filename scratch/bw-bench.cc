@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Accuracy and cost of the bandwidth estimators on recorded sessions,
+//   without the network simulation
+// - A session is the downloadLog of a client of scratch/dash, optionally with
+//   its packets: the throughputLog of the client, or the DlRxPhyStats of the
+//   PhyRxStatsCalculator with the IMSI of the client
+// - Every estimator replays every session: before the request of every
+//   segment it is fed the packets received so far and predicts the
+//   throughput of the download, which is then compared to the recorded one
+// - The error distribution and the wall-clock time per call of every
+//   estimator are written to the output
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("BwBench");
+
+namespace {
+
+// split a list of values separated by delimiter
+std::vector<std::string> Split(const std::string &list, char delimiter) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, delimiter)) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+/**
+ * \brief The download of a segment, in microseconds and bytes.
+ */
+struct segmentRecord {
+  int64_t requested;
+  int64_t start;
+  int64_t end;
+  int64_t bytes;
+};
+
+/**
+ * \brief A recorded streaming session.
+ */
+struct recordedSession {
+  std::string name;
+  std::vector<segmentRecord> segments;
+  std::vector<std::pair<int64_t, uint32_t>> packets;  //!< (time, bytes)
+};
+
+// "segment requested start end bytes ..." per line, times in seconds, as
+// TcpStreamClient::LogDownload writes them
+bool ReadDownloadLog(const std::string &file, recordedSession &session) {
+  std::ifstream log(file.c_str());
+  if (!log) return false;
+  std::string temp;
+  while (std::getline(log, temp)) {
+    std::istringstream fields(temp);
+    int64_t segment, bytes;
+    double requested, start, end;
+    if (fields >> segment >> requested >> start >> end >> bytes) {
+      segmentRecord record;
+      record.requested = std::llround(requested * 1000000);
+      record.start = std::llround(start * 1000000);
+      record.end = std::llround(end * 1000000);
+      record.bytes = bytes;
+      session.segments.push_back(record);
+    }
+  }
+  return !session.segments.empty();
+}
+
+// "time bytes [pushed bytes]" per line, time in seconds, as
+// TcpStreamClient::LogThroughput writes them
+bool ReadThroughputLog(const std::string &file, recordedSession &session) {
+  std::ifstream log(file.c_str());
+  if (!log) return false;
+  std::string temp;
+  while (std::getline(log, temp)) {
+    std::istringstream fields(temp);
+    double time;
+    uint32_t bytes, pushed = 0;
+    if (fields >> time >> bytes) {
+      fields >> pushed;
+      session.packets.push_back(
+          std::make_pair(std::llround(time * 1000000), bytes + pushed));
+    }
+  }
+  return true;
+}
+
+// the correctly received transport blocks of one IMSI in the DlRxPhyStats of
+// PhyRxStatsCalculator, "time cellId imsi rnti txMode layer mcs size rv ndi
+// correctness ccId" per line, time in milliseconds
+bool ReadPhyStats(const std::string &file, uint64_t imsi,
+                  recordedSession &session) {
+  std::ifstream log(file.c_str());
+  if (!log) return false;
+  std::string temp;
+  while (std::getline(log, temp)) {
+    if (temp.empty() || temp[0] == '%') continue;
+    std::istringstream fields(temp);
+    int64_t time;
+    uint64_t tbImsi;
+    uint32_t cellId, rnti, txMode, layer, mcs, size, rv, ndi, correctness;
+    if (fields >> time >> cellId >> tbImsi >> rnti >> txMode >> layer >> mcs >>
+            size >> rv >> ndi >> correctness &&
+        tbImsi == imsi && correctness == 1) {
+      session.packets.push_back(std::make_pair(time * 1000, size));
+    }
+  }
+  std::sort(session.packets.begin(), session.packets.end());
+  return true;
+}
+
+/**
+ * \brief The predictions and call times of an estimator over all sessions.
+ */
+struct estimatorResult {
+  std::vector<double> errors;      //!< |prediction - throughput| in bps
+  std::vector<double> relative;    //!< |ln(prediction / throughput)|
+  int64_t overestimates;           //!< predictions above the throughput
+  int64_t missing;                 //!< decisions without an estimate
+  std::vector<double> callTimes;   //!< of BandwidthAlgo in microseconds
+  double packetTime;               //!< of PacketReceived in microseconds
+  int64_t packets;
+};
+
+// replay a session through a new instance of the estimator tid
+void Replay(const recordedSession &session, TypeId tid,
+            int64_t segmentDuration, estimatorResult &result) {
+  // a ladder of the recorded segments, for the estimators which read it
+  std::vector<int64_t> sizes;
+  for (uint32_t i = 0; i < session.segments.size(); i++) {
+    sizes.push_back(session.segments[i].bytes);
+  }
+  videoData video;
+  video.segmentDuration = segmentDuration;
+  video.segmentSize.push_back(std::vector<std::vector<int64_t>>(1, sizes));
+  video.averageBitrate.push_back(std::vector<double>(
+      1, 8.0 * std::accumulate(sizes.begin(), sizes.end(), 0.0) /
+             sizes.size() / (segmentDuration / 1000000.0)));
+  video.ladders.push_back(
+      BitrateLadder(video.segmentSize[0], video.averageBitrate[0]));
+  video.userInfo.assign(sizes.size(), 0);
+  playbackData playback;
+  bufferData buffer;
+  throughputData throughput;
+
+  Ptr<BandwidthAlgorithm> estimator = AlgorithmRegistry<BandwidthAlgorithm>::
+      Create(tid, video, playback, buffer, throughput);
+  estimator->Initialize();
+  int64_t now = 0;
+  AlgorithmClock::SetThreadClock(&now);
+  uint32_t packet = 0;
+  for (uint32_t s = 0; s < session.segments.size(); s++) {
+    const segmentRecord &segment = session.segments[s];
+    now = segment.requested;
+    std::chrono::steady_clock::time_point begin =
+        std::chrono::steady_clock::now();
+    for (; packet < session.packets.size() &&
+           session.packets[packet].first <= now;
+         packet++) {
+      estimator->PacketReceived(session.packets[packet].first,
+                                session.packets[packet].second);
+      result.packets++;
+    }
+    std::chrono::steady_clock::time_point fed =
+        std::chrono::steady_clock::now();
+    bandwidthAlgoReply reply = estimator->BandwidthAlgo(s, 0);
+    std::chrono::steady_clock::time_point end =
+        std::chrono::steady_clock::now();
+    result.packetTime +=
+        std::chrono::duration<double, std::micro>(fed - begin).count();
+    result.callTimes.push_back(
+        std::chrono::duration<double, std::micro>(end - fed).count());
+
+    const double actual =
+        segment.end > segment.start
+            ? 8.0 * segment.bytes * 1000000.0 / (segment.end - segment.start)
+            : 0.0;
+    if (!(reply.bandwidthEstimate > 0) || std::isinf(reply.bandwidthEstimate)) {
+      result.missing++;
+    } else if (actual > 0) {
+      result.errors.push_back(std::fabs(reply.bandwidthEstimate - actual));
+      result.relative.push_back(
+          std::fabs(std::log(reply.bandwidthEstimate / actual)));
+      if (reply.bandwidthEstimate > actual) result.overestimates++;
+    }
+
+    throughput.transmissionRequested.push_back(segment.requested);
+    throughput.transmissionStart.push_back(segment.start);
+    throughput.transmissionEnd.push_back(segment.end);
+    throughput.bytesReceived.push_back(segment.bytes);
+  }
+  AlgorithmClock::SetThreadClock(0);
+  estimator->Dispose();
+}
+
+double Mean(const std::vector<double> &values) {
+  if (values.empty()) return 0;
+  return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+// the value below which a share p of the values lie, 0 if there are none
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0;
+  uint32_t rank = std::min<uint32_t>(
+      values.size() - 1, (uint32_t)std::ceil(p * values.size()) - 1);
+  std::nth_element(values.begin(), values.begin() + rank, values.end());
+  return values[rank];
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  LogComponentEnable("BwBench", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 1000000;
+  std::string sessions = "";
+  std::string estimators = "";
+  std::string output = "bw-bench.txt";
+
+  CommandLine cmd;
+  cmd.Usage("Accuracy and cost of the bandwidth estimators on recorded "
+            "sessions.\n");
+  cmd.AddValue("segmentDuration",
+               "The duration of a video segment in microseconds",
+               segmentDuration);
+  cmd.AddValue("sessions",
+               "Comma separated sessions, each downloadLog[:throughputLog] "
+               "or downloadLog:DlRxPhyStats:imsi",
+               sessions);
+  cmd.AddValue("estimators",
+               "Comma separated BandwidthAlgorithm TypeId names, all "
+               "registered ones if empty",
+               estimators);
+  cmd.AddValue("output", "The file the result of every estimator is written "
+               "to", output);
+  cmd.Parse(argc, argv);
+
+  std::vector<recordedSession> recorded;
+  std::vector<std::string> sessionList = Split(sessions, ',');
+  for (uint32_t i = 0; i < sessionList.size(); i++) {
+    std::vector<std::string> files = Split(sessionList[i], ':');
+    recordedSession session;
+    session.name = sessionList[i];
+    bool read = !files.empty() && files.size() <= 3 &&
+                ReadDownloadLog(files[0], session);
+    if (read && files.size() == 2) {
+      read = ReadThroughputLog(files[1], session);
+    } else if (read && files.size() == 3) {
+      read = ReadPhyStats(files[1], std::stoull(files[2]), session);
+    }
+    if (!read) {
+      NS_LOG_ERROR("Reading the session " << sessionList[i] << " failed.");
+      return 1;
+    }
+    recorded.push_back(session);
+  }
+  if (recorded.empty()) {
+    NS_LOG_ERROR("No session given.");
+    return 1;
+  }
+
+  std::vector<TypeId> tids;
+  std::vector<std::string> names = Split(estimators, ',');
+  for (uint32_t i = 0; i < names.size(); i++) {
+    TypeId tid;
+    if (!TypeId::LookupByNameFailSafe(names[i], &tid)) {
+      NS_LOG_ERROR("Invalid estimator name " << names[i] << ".");
+      return 1;
+    }
+    tids.push_back(tid);
+  }
+  if (tids.empty()) {
+    tids = AlgorithmRegistry<BandwidthAlgorithm>::GetRegistered();
+  }
+
+  std::ofstream out(output.c_str());
+  out << "Estimator Predictions Missing MAE MeanLogError OverRate P95Error "
+         "CallMean CallP95 PacketMean\n";
+  for (uint32_t e = 0; e < tids.size(); e++) {
+    estimatorResult result;
+    result.overestimates = 0;
+    result.missing = 0;
+    result.packetTime = 0;
+    result.packets = 0;
+    for (uint32_t s = 0; s < recorded.size(); s++) {
+      Replay(recorded[s], tids[e], segmentDuration, result);
+    }
+    const double predictions = std::max<double>(result.errors.size(), 1);
+    const double mae = Mean(result.errors);
+    const double overRate = result.overestimates / predictions;
+    const double p95 = Percentile(result.errors, 0.95);
+    const double packetMean =
+        result.packets > 0 ? result.packetTime / result.packets : 0;
+    // errors in Mbit/s, times in microseconds
+    out << tids[e].GetName() << " " << result.errors.size() << " "
+        << result.missing << " " << std::fixed << std::setprecision(3)
+        << mae / 1000000.0 << " " << Mean(result.relative) << " " << overRate
+        << " " << p95 / 1000000.0 << " " << Mean(result.callTimes) << " "
+        << Percentile(result.callTimes, 0.95) << " " << packetMean << "\n";
+    out.unsetf(std::ios_base::floatfield);
+    NS_LOG_INFO(tids[e].GetName()
+                << ": MAE " << mae / 1000000.0 << " Mbps, over-estimates "
+                << overRate * 100 << " %, p95 " << p95 / 1000000.0
+                << " Mbps, " << Mean(result.callTimes) << " us per call");
+  }
+  out.close();
+  if (!out) {
+    NS_LOG_ERROR("Writing " << output << " failed.");
+    return 1;
+  }
+  NS_LOG_INFO(tids.size() << " estimators on " << recorded.size()
+                          << " sessions, written to " << output);
+  return 0;
+}
@@ -24,15 +24,26 @@
 #include <ns3/buildings-module.h>
 #include <ns3/config-store-module.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "ns3/applications-module.h"
 #include "ns3/building-position-allocator.h"
 #include "ns3/core-module.h"
+#include "ns3/default-simulator-impl.h"
 #include "ns3/epc-helper.h"
 #include "ns3/flow-monitor-module.h"
 #include "ns3/internet-module.h"
@@ -52,26 +63,311 @@ std::string ToString(T val) {
   return stream.str();
 }
 
+// split a comma separated command line value
+std::vector<std::string> Split(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
 using namespace ns3;
+
 NS_LOG_COMPONENT_DEFINE("TcpStreamExample");
 
-static void ACEvent(Ptr<ConstantAccelerationMobilityModel> cvmm, Vector &speed,
-                    Vector &delta) {
-  cvmm->SetVelocityAndAcceleration(speed, delta);
+/**
+ * \brief How the UEs of a path move.
+ */
+struct uePath {
+  uePath() : area(false), randomWalk(false), speed(0) {}
+  Vector position;                  //!< without waypoints, the position
+  bool area;                        //!< start at random in areaBounds
+  Rectangle areaBounds;             //!< of the start positions
+  std::vector<Waypoint> waypoints;  //!< if not empty, the UE follows them
+  bool randomWalk;                  //!< walk randomly from the position
+  double speed;                     //!< of the random walk in m/s
+  Rectangle bounds;                 //!< of the random walk
+};
+
+/**
+ * \brief UEs which follow the same path and stream at the same time.
+ */
+struct clientGroup {
+  uint32_t count;
+  std::string path;
+  double start;           //!< s
+  double stop;            //!< s
+  std::string algorithm;  //!< adaptationAlgo if empty
+};
+
+/**
+ * \brief A scenario: the eNBs, the UEs, their mobility and lifetimes.
+ */
+struct scenarioConfig {
+  std::string fadingTrace;  //!< the trace of fading_model if empty
+  double stopTime;          //!< s
+  std::vector<Vector> enbs;
+  std::map<std::string, uePath> paths;
+  std::vector<clientGroup> groups;
+};
+
+// read a scenario file, one directive per line:
+//   fading <trace file>
+//   stop <s>
+//   enb <x> <y> <z>
+//   enbgrid <columns> <rows> <distance> <z>
+//   position <path> <x> <y> <z>
+//   area <path> <xMin> <xMax> <yMin> <yMax>
+//   waypoint <path> <s> <x> <y> <z>
+//   walk <path> <speed> <xMin> <xMax> <yMin> <yMax>
+//   clients <count> <path> <start s> <stop s> [algorithm]
+//   include <file, relative to this one>
+// # starts a comment
+bool ReadScenario(const std::string &file, scenarioConfig &scenario) {
+  std::ifstream input(file.c_str());
+  if (!input) {
+    NS_LOG_ERROR("Could not read the scenario file " << file);
+    return false;
+  }
+  const std::string dir = file.substr(0, file.find_last_of('/') + 1);
+  std::string temp;
+  for (uint32_t line = 1; std::getline(input, temp); line++) {
+    std::istringstream fields(temp.substr(0, temp.find('#')));
+    std::string directive;
+    if (!(fields >> directive)) continue;
+    bool valid = true;
+    if (directive == "fading") {
+      valid = static_cast<bool>(fields >> scenario.fadingTrace);
+    } else if (directive == "stop") {
+      valid = static_cast<bool>(fields >> scenario.stopTime);
+    } else if (directive == "enb") {
+      Vector position;
+      valid = static_cast<bool>(fields >> position.x >> position.y >>
+                                position.z);
+      scenario.enbs.push_back(position);
+    } else if (directive == "enbgrid") {
+      uint32_t columns, rows;
+      double distance, z;
+      valid = static_cast<bool>(fields >> columns >> rows >> distance >> z);
+      for (uint32_t i = 0; valid && i < rows; i++) {
+        for (uint32_t j = 0; j < columns; j++) {
+          scenario.enbs.push_back(Vector(j * distance, i * distance, z));
+        }
+      }
+    } else if (directive == "position") {
+      std::string name;
+      Vector position;
+      valid = static_cast<bool>(fields >> name >> position.x >> position.y >>
+                                position.z);
+      scenario.paths[name].position = position;
+    } else if (directive == "area") {
+      std::string name;
+      double xMin, xMax, yMin, yMax;
+      valid = static_cast<bool>(fields >> name >> xMin >> xMax >> yMin >>
+                                yMax);
+      scenario.paths[name].area = true;
+      scenario.paths[name].areaBounds = Rectangle(xMin, xMax, yMin, yMax);
+    } else if (directive == "waypoint") {
+      std::string name;
+      double time;
+      Vector position;
+      valid = static_cast<bool>(fields >> name >> time >> position.x >>
+                                position.y >> position.z);
+      std::vector<Waypoint> &waypoints = scenario.paths[name].waypoints;
+      valid = valid && (waypoints.empty() ||
+                        Seconds(time) > waypoints.back().time);
+      waypoints.push_back(Waypoint(Seconds(time), position));
+    } else if (directive == "walk") {
+      std::string name;
+      double speed, xMin, xMax, yMin, yMax;
+      valid = static_cast<bool>(fields >> name >> speed >> xMin >> xMax >>
+                                yMin >> yMax);
+      uePath &path = scenario.paths[name];
+      path.randomWalk = true;
+      path.speed = speed;
+      path.bounds = Rectangle(xMin, xMax, yMin, yMax);
+    } else if (directive == "clients") {
+      clientGroup group;
+      valid = static_cast<bool>(fields >> group.count >> group.path >>
+                                group.start >> group.stop);
+      fields >> group.algorithm;
+      scenario.groups.push_back(group);
+    } else if (directive == "include") {
+      std::string included;
+      valid = static_cast<bool>(fields >> included) &&
+              ReadScenario(dir + included, scenario);
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      NS_LOG_ERROR(file << ":" << line << ": invalid directive: " << temp);
+      return false;
+    }
+  }
+  return true;
+}
+
+// install the mobility of path on a UE, without scheduling any event: the
+// waypoints are only looked up when the position is. random draws the start
+// positions of the paths with an area
+void InstallMobility(Ptr<Node> ue, const uePath &path,
+                     Ptr<UniformRandomVariable> random) {
+  Vector position = path.position;
+  if (path.area) {
+    position.x = random->GetValue(path.areaBounds.xMin, path.areaBounds.xMax);
+    position.y = random->GetValue(path.areaBounds.yMin, path.areaBounds.yMax);
+  }
+  if (!path.waypoints.empty()) {
+    Ptr<WaypointMobilityModel> mobility =
+        CreateObjectWithAttributes<WaypointMobilityModel>(
+            "LazyNotify", BooleanValue(true));
+    if (path.waypoints.front().time > Seconds(0)) {
+      mobility->AddWaypoint(
+          Waypoint(Seconds(0), path.waypoints.front().position));
+    }
+    for (uint32_t i = 0; i < path.waypoints.size(); i++) {
+      mobility->AddWaypoint(path.waypoints[i]);
+    }
+    ue->AggregateObject(mobility);
+  } else if (path.randomWalk) {
+    Ptr<RandomWalk2dMobilityModel> mobility =
+        CreateObjectWithAttributes<RandomWalk2dMobilityModel>(
+            "Mode", StringValue("Time"), "Time", StringValue("1s"), "Speed",
+            StringValue("ns3::ConstantRandomVariable[Constant=" +
+                        ToString(path.speed) + "]"),
+            "Bounds", RectangleValue(path.bounds));
+    ue->AggregateObject(mobility);
+    mobility->SetPosition(position);
+  } else {
+    Ptr<ConstantPositionMobilityModel> mobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    ue->AggregateObject(mobility);
+    mobility->SetPosition(position);
+  }
 }
-static void COEvent(Ptr<ConstantVelocityMobilityModel> cvmm, Vector &speed) {
-  cvmm->SetVelocity(speed);
+
+// the absolute paths of a comma separated list of files, the ones which do
+// not exist are kept as they are
+std::string AbsolutePaths(const std::string &list) {
+  std::vector<std::string> files = Split(list);
+  std::string paths;
+  for (uint32_t i = 0; i < files.size(); i++) {
+    char *path = realpath(files[i].c_str(), NULL);
+    paths += (i > 0 ? "," : "") + (path ? std::string(path) : files[i]);
+    free(path);
+  }
+  return paths;
+}
+
+/**
+ * \brief Fork one process per algorithm from the simulation as it is.
+ *
+ * A child returns true with algorithm set to the one it runs, in its own
+ * working directory fork-<algorithm>/. The parent waits for all children
+ * and returns false, with failed set to the number of children which did not
+ * exit with 0.
+ */
+bool ForkAlgorithms(const std::vector<std::string> &algorithms,
+                    std::string &algorithm, uint32_t &failed) {
+  std::map<pid_t, std::string> children;
+  failed = 0;
+  std::cout.flush();
+  std::cerr.flush();
+  for (uint32_t i = 0; i < algorithms.size(); i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      std::string dir = "fork-" + algorithms[i];
+      mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+      if (chdir(dir.c_str()) != 0) {
+        NS_LOG_ERROR("Cannot enter " << dir << ": " << strerror(errno));
+        _exit(1);
+      }
+      algorithm = algorithms[i];
+      return true;
+    }
+    if (pid < 0) {
+      NS_LOG_ERROR("Cannot fork for " << algorithms[i] << ": "
+                                      << strerror(errno));
+      failed++;
+      continue;
+    }
+    children[pid] = algorithms[i];
+  }
+  while (!children.empty()) {
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      break;
+    }
+    if (children.find(pid) == children.end()) {
+      continue;
+    }
+    if (WIFEXITED(status)) {
+      NS_LOG_INFO("Fork " << children[pid] << ": exit "
+                          << WEXITSTATUS(status));
+    } else {
+      NS_LOG_INFO("Fork " << children[pid] << ": signal "
+                          << WTERMSIG(status));
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed++;
+    }
+    children.erase(pid);
+  }
+  failed += children.size();
+  return false;
 }
 
+/**
+ * \brief The default simulator, counting the events scheduled for the
+ * runtime report.
+ */
+class EventCountingSimulatorImpl : public DefaultSimulatorImpl {
+ public:
+  static TypeId GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::EventCountingSimulatorImpl")
+                            .SetParent<DefaultSimulatorImpl>()
+                            .AddConstructor<EventCountingSimulatorImpl>();
+    return tid;
+  }
+  EventCountingSimulatorImpl() : m_events(0) {}
+
+  virtual EventId Schedule(Time const &delay, EventImpl *event) {
+    m_events++;
+    return DefaultSimulatorImpl::Schedule(delay, event);
+  }
+  virtual void ScheduleWithContext(uint32_t context, Time const &delay,
+                                   EventImpl *event) {
+    m_events++;
+    DefaultSimulatorImpl::ScheduleWithContext(context, delay, event);
+  }
+  virtual EventId ScheduleNow(EventImpl *event) {
+    m_events++;
+    return DefaultSimulatorImpl::ScheduleNow(event);
+  }
+  uint64_t GetEvents(void) const { return m_events; }
+
+ private:
+  uint64_t m_events;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(EventCountingSimulatorImpl);
+
 int main(int argc, char *argv[]) {
   LogComponentEnable("TcpStreamExample", LOG_LEVEL_INFO);
   LogComponentEnable("TcpStreamClientApplication", LOG_LEVEL_INFO);
   LogComponentEnable("TcpStreamServerApplication", LOG_LEVEL_INFO);
+  std::chrono::steady_clock::time_point wallStart =
+      std::chrono::steady_clock::now();
 
   uint64_t segmentDuration = 10000000;
   uint32_t simulationId = 4;
-  uint32_t numberOfClients = 20;  // limit by 40
-  uint32_t numberOfEnbs = 1;      // 1
+  uint32_t numberOfClients = 0;  // the clients of the scenario
+  uint32_t numberOfEnbs = 1;     // if the scenario has no eNB
+  double enbDistance = 500;      // m, between them
   uint32_t scenarioId = 0;
   std::string adaptationAlgo = "tobasco";  //
   std::string app_type = "Dash";           // Bulk sender | On-Off Sender | Dash
@@ -82,21 +378,58 @@ int main(int argc, char *argv[]) {
   int tx_mode = 2;
   int bandwidth = 75;
   std::string data_rate = "100Gbps";  // 100Gbps
+  std::string serverScheduler = "none";  // none | edf | wfq
+  bool serverPush = false;
+  uint64_t cacheSize = 0;  // 0 = no edge cache
+  std::string cachePolicy = "lru";         // lru | lfu | popularity
+  std::string originDataRate = "100Mbps";  // edge cache -> origin
+  double originDelay = 0.02;               // s
+  uint16_t numberOfServers = 1;
+  std::string serverSelection = "rtt";  // rtt | load | hash
+  std::string serverDataRates = "";     // comma separated, per extra server
+  std::string serverDelays = "";        // comma separated s, per extra server
+  std::string segmentSizeFiles = "SegmentSize.txt";  // one per viewpoint
+  std::string userInfoFile = "UserInfo.txt";
+  bool profileDecisions = false;
+  bool coordinateCells = false;
+  std::string scenarioFile = "";  // scenarios/sim<id>-<scenarioId>.txt
+  std::string forkAlgorithms = "";  // comma separated, empty = no fork
+  bool lteTraces = true;
+  // with more than one eNB
+  std::string handoverAlgorithm = "ns3::A3RsrpHandoverAlgorithm";
+  double handoverHorizon = 0;  // s, 0 = no pre-buffering
+  double handoverHysteresis = 3.0;  // dB, A3 event
+  double handoverTimeToTrigger = 256;  // ms, A3 event
 
   CommandLine cmd;
   cmd.Usage("Simulation of streaming with DASH.\n");
-  cmd.AddValue("simulationId", "The simulation's index (for logging purposes)",
+  cmd.AddValue("simulationId",
+               "The simulation's index, for logging purposes and the default "
+               "scenario file",
                simulationId);
-  cmd.AddValue("numberOfClients", "The number of clients", numberOfClients);
-  cmd.AddValue("numberOfEnbs", "The number of eNodeBs", numberOfEnbs);
-  cmd.AddValue("scenarioId", "The Id of scenrio", scenarioId);
+  cmd.AddValue("numberOfEnbs",
+               "The number of eNodeBs, on a square grid from the origin, if "
+               "the scenario places none",
+               numberOfEnbs);
+  cmd.AddValue("enbDistance",
+               "The distance in m between the eNodeBs of numberOfEnbs"
+               "[default:500]",
+               enbDistance);
+  cmd.AddValue("scenarioId", "The Id of the scenario, for the default "
+               "scenario file", scenarioId);
+  cmd.AddValue("scenario",
+               "The scenario file: eNBs, UE mobility, client lifetimes and "
+               "fading trace[default:scenarios/sim<simulationId>-"
+               "<scenarioId>.txt]",
+               scenarioFile);
   cmd.AddValue("segmentDuration",
                "The duration of a video segment in microseconds",
                segmentDuration);
   cmd.AddValue("adaptationAlgo",
                "The adaptation algorithm that the client uses for the "
                "simulation[festive | tobasco | sara | tomato | "
-               "constbitrateW/H/T/WH/C...]",
+               "constbitrateW/H/T/WH/C... | TypeId name, e.g. "
+               "ns3::SaraAlgorithm]",
                adaptationAlgo);
   cmd.AddValue("app_type", "source model[Bulk | OnOff | Dash][defalt:Dash]",
                app_type);
@@ -114,6 +447,92 @@ int main(int argc, char *argv[]) {
   cmd.AddValue("DataRate",
                "DataRate for PointToPoint(pgw->remoteHost)[Default=100Gbps]",
                data_rate);
+  cmd.AddValue("serverScheduler",
+               "How the server shares its send rate between the clients[none | "
+               "edf | wfq][default:none]",
+               serverScheduler);
+  cmd.AddValue("serverPush",
+               "Let the server push the next segment at the current "
+               "representation[default:false]",
+               serverPush);
+  cmd.AddValue("cacheSize",
+               "Byte budget of an edge cache between the pgw and the origin "
+               "server, 0 for no cache[default:0]",
+               cacheSize);
+  cmd.AddValue("cachePolicy",
+               "Replacement policy of the edge cache[lru | lfu | "
+               "popularity][default:lru]",
+               cachePolicy);
+  cmd.AddValue("originDataRate",
+               "DataRate for PointToPoint(edge cache->origin)[Default=100Mbps]",
+               originDataRate);
+  cmd.AddValue("originDelay",
+               "Delay in s of PointToPoint(edge cache->origin)[Default=0.02]",
+               originDelay);
+  cmd.AddValue("numberOfServers",
+               "The number of servers the clients choose from, each attached "
+               "to the pgw by its own link[default:1]",
+               numberOfServers);
+  cmd.AddValue("serverSelection",
+               "How the clients choose the server for every segment[rtt | "
+               "load | hash][default:rtt]",
+               serverSelection);
+  cmd.AddValue("serverDataRates",
+               "Comma separated DataRates of the links pgw->server of the "
+               "servers after the first, the last one is repeated[Default="
+               "DataRate]",
+               serverDataRates);
+  cmd.AddValue("serverDelays",
+               "Comma separated delays in s of the links pgw->server of the "
+               "servers after the first, the last one is repeated"
+               "[Default=0.001]",
+               serverDelays);
+  cmd.AddValue("segmentSizeFiles",
+               "Comma separated segment size files, one per viewpoint, e.g. "
+               "Help_CMP0_segmentSize.txt,...,Help_CMP5_segmentSize.txt for "
+               "adaptationAlgo=viewport[default:SegmentSize.txt]",
+               segmentSizeFiles);
+  cmd.AddValue("userInfoFile",
+               "The viewpoint of every segment[default:UserInfo.txt]",
+               userInfoFile);
+  cmd.AddValue("coordinateCells",
+               "Share every cell among its clients with a CellCoordinator, "
+               "which caps their bitrates by the measured cell load"
+               "[default:false]",
+               coordinateCells);
+  cmd.AddValue("profileDecisions",
+               "Time the stages of every adaptation decision and write their "
+               "latencies to sim<id>_decisionLatency.txt[default:false]",
+               profileDecisions);
+  cmd.AddValue("lteTraces",
+               "Write all the LTE traces, otherwise only the downlink PHY "
+               "receptions which the cross-layer estimate needs"
+               "[default:true]",
+               lteTraces);
+  cmd.AddValue("forkAlgorithms",
+               "Comma separated adaptation algorithms: simulate the network "
+               "up to the first client start once, then fork one process per "
+               "algorithm, which runs in fork-<algorithm>/ with it in place "
+               "of adaptationAlgo[default:none]",
+               forkAlgorithms);
+  cmd.AddValue("handoverAlgorithm",
+               "The handover algorithm of the eNBs when there are several, "
+               "connected by X2, or none[default:ns3::A3RsrpHandoverAlgorithm]",
+               handoverAlgorithm);
+  cmd.AddValue("handoverHorizon",
+               "Build up the buffer when a handover is predicted within this "
+               "many seconds, off if 0[default:0]",
+               handoverHorizon);
+  cmd.AddValue("handoverHysteresis",
+               "Hysteresis in dB of the A3 event, set on "
+               "ns3::A3RsrpHandoverAlgorithm and used by the clients to "
+               "predict the handovers[default:3]",
+               handoverHysteresis);
+  cmd.AddValue("handoverTimeToTrigger",
+               "Time to trigger in ms of the A3 event, set on "
+               "ns3::A3RsrpHandoverAlgorithm and used by the clients to "
+               "predict the handovers[default:256]",
+               handoverTimeToTrigger);
   cmd.Parse(argc, argv);
 
   Config::SetDefault("ns3::LteSpectrumPhy::CtrlErrorModelEnabled",
@@ -134,6 +553,65 @@ int main(int argc, char *argv[]) {
   input_config.ConfigureDefaults();
   cmd.Parse(argc, argv);
 
+  // count the events for the runtime report, unless another simulator was
+  // asked for
+  StringValue simulatorType;
+  GlobalValue::GetValueByName("SimulatorImplementationType", simulatorType);
+  if (simulatorType.Get() == "ns3::DefaultSimulatorImpl") {
+    GlobalValue::Bind("SimulatorImplementationType",
+                      StringValue("ns3::EventCountingSimulatorImpl"));
+  }
+  // every client keeps its six logs open
+  struct rlimit files;
+  if (getrlimit(RLIMIT_NOFILE, &files) == 0 &&
+      files.rlim_cur < files.rlim_max) {
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+  }
+
+  if (scenarioFile.empty()) {
+    scenarioFile = "scenarios/sim" + ToString(simulationId) + "-" +
+                   ToString(scenarioId) + ".txt";
+  }
+  scenarioConfig scenario;
+  scenario.stopTime = 121;
+  if (!ReadScenario(scenarioFile, scenario)) {
+    return 1;
+  }
+  if (scenario.groups.empty()) {
+    NS_LOG_ERROR("The scenario " << scenarioFile << " has no clients");
+    return 1;
+  }
+  numberOfClients = 0;
+  for (uint32_t i = 0; i < scenario.groups.size(); i++) {
+    if (scenario.paths.find(scenario.groups[i].path) ==
+        scenario.paths.end()) {
+      NS_LOG_ERROR("The scenario has no path " << scenario.groups[i].path);
+      return 1;
+    }
+    numberOfClients += scenario.groups[i].count;
+  }
+  if (!scenario.enbs.empty()) {
+    numberOfEnbs = scenario.enbs.size();
+  }
+  // the prediction extrapolates the A3 event, other algorithms hand over on
+  // other criteria
+  if (handoverHorizon > 0 &&
+      (numberOfEnbs < 2 ||
+       handoverAlgorithm != "ns3::A3RsrpHandoverAlgorithm")) {
+    NS_LOG_INFO("No handover prediction without "
+                "ns3::A3RsrpHandoverAlgorithm, handoverHorizon ignored");
+    handoverHorizon = 0;
+  }
+  // every UE of a cell needs its own SRS offset, so the SRS periodicity
+  // bounds the UEs per cell (40 by default): allow for all of them in one
+  uint32_t srsPeriodicity = 40;
+  while (srsPeriodicity < numberOfClients && srsPeriodicity < 320) {
+    srsPeriodicity *= 2;
+  }
+  Config::SetDefault("ns3::LteEnbRrc::SrsPeriodicity",
+                     UintegerValue(srsPeriodicity));
+
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper>();
   Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper>();
   lteHelper->SetEpcHelper(epcHelper);
@@ -144,15 +622,12 @@ int main(int argc, char *argv[]) {
   std::ifstream ifTraceFile;
   std::string fading_trace_path;
 
-  if (simulationId == 1) fading_model = 0;
-  if (simulationId == 2) fading_model = 0;
-  if (simulationId == 3) fading_model = 0;
-  if (simulationId == 4) fading_model = 1;
-
-  if (fading_model == 0)
+  if (!scenario.fadingTrace.empty())
+    fading_trace_path = "../../" + scenario.fadingTrace;
+  else if (fading_model == 0)
     fading_trace_path =
         "../../src/lte/model/fading-traces/fading_trace_ETU_3kmph.fad";
-  if (fading_model == 1)
+  else if (fading_model == 1)
     fading_trace_path =
         "../../src/lte/model/fading-traces/fading_trace_EVA_60kmph.fad";
 
@@ -181,20 +656,75 @@ int main(int argc, char *argv[]) {
   InternetStackHelper internet;
   internet.Install(remote_host_container);
   std::cout << "remoteHost Id:  " << remote_host->GetId() << std::endl;
+  // with an edge cache, the clients reach the cache through the pgw and the
+  // cache reaches the origin (remote_host) through a constrained link
+  Ptr<Node> edge_cache;
+  if (cacheSize > 0) {
+    NodeContainer edge_cache_container;
+    edge_cache_container.Create(1);
+    edge_cache = edge_cache_container.Get(0);
+    internet.Install(edge_cache_container);
+    std::cout << "edgeCache Id:  " << edge_cache->GetId() << std::endl;
+  }
+  Ptr<Node> pgw_peer = cacheSize > 0 ? edge_cache : remote_host;
   PointToPointHelper p2ph;
   p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate(data_rate)));
   p2ph.SetDeviceAttribute("Mtu", UintegerValue(1500));
   p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.001)));
-  NetDeviceContainer internetDevices = p2ph.Install(pgw, remote_host);
+  NetDeviceContainer internetDevices = p2ph.Install(pgw, pgw_peer);
   Ipv4AddressHelper ipv4h;
   ipv4h.SetBase("1.0.0.0", "255.0.0.0");
   ipv4h.SetBase("1.0.0.0", "255.0.0.0");
   Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(internetDevices);
   Ipv4StaticRoutingHelper ipv4RoutingHelper;
   Ptr<Ipv4StaticRouting> remote_host_static_routing =
-      ipv4RoutingHelper.GetStaticRouting(remote_host->GetObject<Ipv4>());
+      ipv4RoutingHelper.GetStaticRouting(pgw_peer->GetObject<Ipv4>());
   remote_host_static_routing->AddNetworkRouteTo(Ipv4Address("7.0.0.0"),
                                                 Ipv4Mask("255.0.0.0"), 1);
+  Ipv4InterfaceContainer originIpIfaces;
+  if (cacheSize > 0) {
+    PointToPointHelper originP2ph;
+    originP2ph.SetDeviceAttribute("DataRate",
+                                  DataRateValue(DataRate(originDataRate)));
+    originP2ph.SetDeviceAttribute("Mtu", UintegerValue(1500));
+    originP2ph.SetChannelAttribute("Delay", TimeValue(Seconds(originDelay)));
+    NetDeviceContainer originDevices =
+        originP2ph.Install(edge_cache, remote_host);
+    ipv4h.SetBase("2.0.0.0", "255.0.0.0");
+    originIpIfaces = ipv4h.Assign(originDevices);
+  }
+  // additional servers, each on its own link to the pgw
+  std::vector<std::string> extraDataRates = Split(serverDataRates);
+  std::vector<std::string> extraDelays = Split(serverDelays);
+  NodeContainer extra_server_container;
+  std::vector<Ipv4Address> extraServerAddresses;
+  // a /24 of 3.0.0.0/8 per server, which holds all 65535 of them
+  ipv4h.SetBase("3.0.0.0", "255.255.255.0");
+  for (uint16_t i = 1; i < numberOfServers; i++) {
+    Ptr<Node> server = CreateObject<Node>();
+    extra_server_container.Add(server);
+    internet.Install(server);
+    std::cout << "server " << i << " Id:  " << server->GetId() << std::endl;
+    std::string rate =
+        extraDataRates.empty()
+            ? data_rate
+            : extraDataRates.at(std::min(i - 1, (int)extraDataRates.size() - 1));
+    double delay =
+        extraDelays.empty()
+            ? 0.001
+            : atof(extraDelays.at(std::min(i - 1, (int)extraDelays.size() - 1))
+                       .c_str());
+    PointToPointHelper serverP2ph;
+    serverP2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate(rate)));
+    serverP2ph.SetDeviceAttribute("Mtu", UintegerValue(1500));
+    serverP2ph.SetChannelAttribute("Delay", TimeValue(Seconds(delay)));
+    NetDeviceContainer serverDevices = serverP2ph.Install(pgw, server);
+    Ipv4InterfaceContainer serverIpIfaces = ipv4h.Assign(serverDevices);
+    ipv4h.NewNetwork();
+    extraServerAddresses.push_back(serverIpIfaces.GetAddress(1));
+    ipv4RoutingHelper.GetStaticRouting(server->GetObject<Ipv4>())
+        ->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+  }
   NodeContainer eNb_nodes;
   NodeContainer ue_nodes;
   Ipv4InterfaceContainer ueIpIface;
@@ -204,229 +734,54 @@ int main(int argc, char *argv[]) {
   Ptr<ListPositionAllocator> positionAlloc_eNB =
       CreateObject<ListPositionAllocator>();
 
-  positionAlloc_eNB->Add(Vector(0, 0, 0));  // eNB_0
+  if (scenario.enbs.empty()) {
+    // numberOfEnbs on the smallest square grid which holds them
+    const uint32_t columns = std::ceil(std::sqrt((double)numberOfEnbs));
+    for (uint32_t i = 0; i < numberOfEnbs; i++) {
+      positionAlloc_eNB->Add(Vector((i % columns) * enbDistance,
+                                    (i / columns) * enbDistance, 0));
+    }
+  }
+  for (uint32_t i = 0; i < scenario.enbs.size(); i++) {
+    positionAlloc_eNB->Add(scenario.enbs[i]);
+  }
 
   enbMobility.SetPositionAllocator(positionAlloc_eNB);
   enbMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
   enbMobility.Install(eNb_nodes);
 
-  // create folder
-  std::string dir = "mylogs/";
-  std::string subdir = dir + adaptationAlgo + "/";
-  std::string ssubdir = subdir + ToString(numberOfClients) + "/";
-  const char *mylogsDir = (dir).c_str();
-  mkdir(mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-  const char *algoDir = (subdir).c_str();
-  mkdir(algoDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-  const char *logdir = (ssubdir).c_str();
-  mkdir(logdir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-
-  std::ofstream clientPosLog;
-  std::string clientPos =
-      ssubdir + "sim" + ToString(simulationId) + "_" + "clientPos.txt";
-  clientPosLog.open(clientPos.c_str());
-  NS_ASSERT_MSG(clientPosLog.is_open(), "Couldn't open clientPosLog file");
-
-  switch (simulationId) {
-    case 1: {  //固定位置
-      Ptr<ListPositionAllocator> positionAlloc =
-          CreateObject<ListPositionAllocator>();
-      Ptr<RandomDiscPositionAllocator> randPosAlloc =
-          CreateObject<RandomDiscPositionAllocator>();
-      for (uint i = 0; i < numberOfClients; i++) {
-        Vector pos = Vector(30, 25, 0);
-        positionAlloc->Add(pos);
-
-        clientPosLog << ToString(pos.x) << ", " << ToString(pos.y) << ", "
-                     << ToString(pos.z) << "\n";
-        clientPosLog.flush();
-      }
-      MobilityHelper ueMobility_1;
-      ueMobility_1.SetPositionAllocator(positionAlloc);
-      ueMobility_1.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-      ueMobility_1.Install(ue_nodes);
-      break;
-    }
-    case 2: {  //隨機走動
-      MobilityHelper ueMobility_2;
-      ueMobility_2.SetMobilityModel(
-          "ns3::RandomWalk2dMobilityModel", "Mode", StringValue("Time"), "Time",
-          StringValue("1s"), "Speed",
-          StringValue("ns3::ConstantRandomVariable[Constant=0.83333]"),
-          "Bounds", RectangleValue(Rectangle(40, 20, 40, 20)));
-      for (uint i = 0; i < numberOfClients; i++) {
-        ueMobility_2.Install(ue_nodes.Get(i));
-      }
-      break;
-    }
-    case 3: {  //步行穿小區
-      MobilityHelper ueMobility_4;
-      ueMobility_4.SetMobilityModel("ns3::ConstantVelocityMobilityModel");
-      ueMobility_4.SetPositionAllocator(
-          "ns3::UniformDiscPositionAllocator", "X", DoubleValue(-90.0), "Y",
-          DoubleValue(-10), "rho", DoubleValue(0));
-      ueMobility_4.Install(ue_nodes);
-      for (int64_t i = 0; i < ue_nodes.GetN(); i++) {
-        Ptr<ConstantVelocityMobilityModel> cvmm =
-            ue_nodes.Get(i)->GetObject<ConstantVelocityMobilityModel>();
-        cvmm->SetVelocity(Vector(0.833, 0.0, 0.0));
-        Simulator::Schedule(Seconds(180), &COEvent, cvmm,
-                            Vector(-0.833, 0.0, 0.0));
-      }
-      break;
-    }
-    case 4: {  //車載穿小區
-      MobilityHelper ueMobility_5;
-      ueMobility_5.SetMobilityModel("ns3::ConstantAccelerationMobilityModel");
-      ueMobility_5.SetPositionAllocator(
-          "ns3::UniformDiscPositionAllocator", "X", DoubleValue(-90.0), "Y",
-          DoubleValue(0.0), "rho", DoubleValue(0));
-      ueMobility_5.Install(ue_nodes);
-      for (int64_t i = 0; i < ue_nodes.GetN(); i++) {
-        Ptr<ConstantAccelerationMobilityModel> cvmm =
-            ue_nodes.Get(i)->GetObject<ConstantAccelerationMobilityModel>();
-        if (scenarioId == 0) {
-          cvmm->SetVelocityAndAcceleration(Vector(45, 0, 0), Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(2.0), &ACEvent, cvmm, Vector(0, 0, 0),
-                              Vector(0, 0, 0));
-        } else if (scenarioId == 6) {
-          cvmm->SetVelocityAndAcceleration(Vector(6, 0, 0), Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(30.0), &ACEvent, cvmm, Vector(-6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(60.0), &ACEvent, cvmm, Vector(6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(90.0), &ACEvent, cvmm, Vector(-6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(120.0), &ACEvent, cvmm, Vector(6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(150.0), &ACEvent, cvmm, Vector(-6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(180.0), &ACEvent, cvmm, Vector(6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(210.0), &ACEvent, cvmm, Vector(-6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(240.0), &ACEvent, cvmm, Vector(6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(270.0), &ACEvent, cvmm, Vector(-6, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(300.0), &ACEvent, cvmm, Vector(6, 0, 0),
-                              Vector(0, 0, 0));
-        } else if (scenarioId == 12) {
-          cvmm->SetVelocityAndAcceleration(Vector(12, 0, 0), Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(15), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(30), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(45), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(60), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(75), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(90), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(105), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(120), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(135), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(150), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(165), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(180), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(195), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(210), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(225), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(240), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(255), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(270), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(285), &ACEvent, cvmm, Vector(12, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(300), &ACEvent, cvmm, Vector(-12, 0, 0),
-                              Vector(0, 0, 0));
-        } else if (scenarioId == 18) {
-          cvmm->SetVelocityAndAcceleration(Vector(18, 0, 0), Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(10), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(20), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(30), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(40), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(50), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(60), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(70), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(80), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(90), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(100), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(110), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(120), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(130), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(140), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(150), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(160), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(170), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(180), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(190), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(200), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(210), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(220), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(230), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(240), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(250), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(260), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(270), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(280), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(290), &ACEvent, cvmm, Vector(-18, 0, 0),
-                              Vector(0, 0, 0));
-          Simulator::Schedule(Seconds(300), &ACEvent, cvmm, Vector(18, 0, 0),
-                              Vector(0, 0, 0));
-        } else {
-          NS_ASSERT_MSG(scenarioId == 6 || scenarioId == 12 ||
-                            scenarioId == 18 || scenarioId == 0,
-                        "Invalid speed!");
-        }
-      }
-      break;
-    }
+  // the UEs of every group of the scenario, in order
+  std::vector<uint32_t> ueGroup;
+  std::ostringstream clientPositions;  // at the start, for clientPos.txt
+  Ptr<UniformRandomVariable> positions = CreateObject<UniformRandomVariable>();
+  for (uint32_t i = 0; i < scenario.groups.size(); i++) {
+    ueGroup.insert(ueGroup.end(), scenario.groups[i].count, i);
+  }
+  for (uint32_t i = 0; i < ue_nodes.GetN(); i++) {
+    InstallMobility(ue_nodes.Get(i),
+                    scenario.paths[scenario.groups[ueGroup[i]].path],
+                    positions);
+    Vector pos = ue_nodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+    clientPositions << ToString(pos.x) << ", " << ToString(pos.y) << ", "
+                    << ToString(pos.z) << "\n";
   }
 
+  if (numberOfEnbs > 1) {
+    lteHelper->SetHandoverAlgorithmType(handoverAlgorithm == "none"
+                                            ? "ns3::NoOpHandoverAlgorithm"
+                                            : handoverAlgorithm);
+    if (handoverAlgorithm == "ns3::A3RsrpHandoverAlgorithm") {
+      lteHelper->SetHandoverAlgorithmAttribute(
+          "Hysteresis", DoubleValue(handoverHysteresis));
+      lteHelper->SetHandoverAlgorithmAttribute(
+          "TimeToTrigger", TimeValue(MilliSeconds(handoverTimeToTrigger)));
+    }
+  }
   NetDeviceContainer eNb_devs = lteHelper->InstallEnbDevice(eNb_nodes);
   NetDeviceContainer ue_devs = lteHelper->InstallUeDevice(ue_nodes);
+  if (numberOfEnbs > 1) {
+    lteHelper->AddX2Interface(eNb_nodes);
+  }
 
   internet.Install(ue_nodes);
   ueIpIface = epcHelper->AssignUeIpv4Address(NetDeviceContainer(ue_devs));
@@ -440,22 +795,90 @@ int main(int argc, char *argv[]) {
     ue_static_routing->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(),
                                        1);
   }
-  lteHelper->EnableTraces();
 
-  std::vector<std::pair<Ptr<Node>, std::string>> clients;
-  for (NodeContainer::Iterator i = ue_nodes.Begin(); i != ue_nodes.End(); ++i) {
-    std::pair<Ptr<Node>, std::string> client(*i, adaptationAlgo);
-    clients.push_back(client);
-  }
   if (app_type.compare("Dash") == 0) {
     const Ptr<PhyRxStatsCalculator> lte_phy_rx_stats =
         lteHelper->GetPhyRxStats();
     uint16_t port = 80;
     TcpStreamServerHelper serverHelper(port);
+    serverHelper.SetAttribute("Scheduler", StringValue(serverScheduler));
     ApplicationContainer serverApp =
         serverHelper.Install(remote_host_container.Get(0));
     serverApp.Start(Seconds(1.0));
+    ApplicationContainer extraServerApps =
+        serverHelper.Install(extra_server_container);
+    extraServerApps.Start(Seconds(1.0));
+
+    Ptr<TcpStreamCache> cache;
+    if (cacheSize > 0) {
+      TcpStreamCacheHelper cacheHelper(originIpIfaces.GetAddress(1), port);
+      cacheHelper.SetAttribute("CacheSize", UintegerValue(cacheSize));
+      cacheHelper.SetAttribute("ReplacementPolicy", StringValue(cachePolicy));
+      cacheHelper.SetAttribute("Scheduler", StringValue(serverScheduler));
+      ApplicationContainer cacheApp = cacheHelper.Install(edge_cache);
+      cacheApp.Start(Seconds(1.0));
+      cache = cacheApp.Get(0)->GetObject<TcpStreamCache>();
+    }
+
+    // the network up to the first client start is the same for every
+    // algorithm: simulate it once and fork one process per algorithm there
+    double warmup = 0;  // s
+    std::chrono::steady_clock::time_point setupEnd;
+    std::vector<std::string> algorithms = Split(forkAlgorithms);
+    if (!algorithms.empty()) {
+      warmup = scenario.groups[0].start;
+      for (uint32_t i = 1; i < scenario.groups.size(); i++) {
+        warmup = std::min(warmup, scenario.groups[i].start);
+      }
+      // the children run in their own directories
+      segmentSizeFiles = AbsolutePaths(segmentSizeFiles);
+      userInfoFile = AbsolutePaths(userInfoFile);
+      NS_LOG_INFO("Warm up to " << warmup << " s.");
+      setupEnd = std::chrono::steady_clock::now();
+      Simulator::Stop(Seconds(warmup));
+      Simulator::Run();
+      uint32_t failed;
+      if (!ForkAlgorithms(algorithms, adaptationAlgo, failed)) {
+        Simulator::Destroy();
+        NS_LOG_INFO("Done, " << failed << " of " << algorithms.size()
+                             << " forks failed.");
+        return failed > 0 ? 1 : 0;
+      }
+    }
+    // the traces are enabled after the fork, so that every child writes its
+    // own files
+    if (lteTraces) {
+      lteHelper->EnableTraces();
+    } else {
+      lteHelper->EnableDlRxPhyTraces();
+    }
 
+    // create folder
+    std::string dir = "mylogs/";
+    std::string subdir = dir + adaptationAlgo + "/";
+    std::string ssubdir = subdir + ToString(numberOfClients) + "/";
+    const char *mylogsDir = (dir).c_str();
+    mkdir(mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    const char *algoDir = (subdir).c_str();
+    mkdir(algoDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    const char *logdir = (ssubdir).c_str();
+    mkdir(logdir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+    std::ofstream clientPosLog;
+    std::string clientPos =
+        ssubdir + "sim" + ToString(simulationId) + "_" + "clientPos.txt";
+    clientPosLog.open(clientPos.c_str());
+    NS_ASSERT_MSG(clientPosLog.is_open(), "Couldn't open clientPosLog file");
+    clientPosLog << clientPositions.str();
+    clientPosLog.close();
+
+    std::vector<std::pair<Ptr<Node>, std::string>> clients;
+    for (uint32_t i = 0; i < ue_nodes.GetN(); i++) {
+      const std::string &algorithm = scenario.groups[ueGroup[i]].algorithm;
+      std::pair<Ptr<Node>, std::string> client(
+          ue_nodes.Get(i), algorithm.empty() ? adaptationAlgo : algorithm);
+      clients.push_back(client);
+    }
     TcpStreamClientHelper clientHelper(internetIpIfaces.GetAddress(1), port,
                                        lte_phy_rx_stats);
     clientHelper.SetAttribute("SegmentDuration",
@@ -463,284 +886,164 @@ int main(int argc, char *argv[]) {
     clientHelper.SetAttribute("NumberOfClients",
                               UintegerValue(numberOfClients));
     clientHelper.SetAttribute("SimulationId", UintegerValue(simulationId));
+    clientHelper.SetAttribute("ServerPush", BooleanValue(serverPush));
+    clientHelper.SetAttribute("ServerSelection", StringValue(serverSelection));
+    clientHelper.SetAttribute("SegmentSizeFiles",
+                              StringValue(segmentSizeFiles));
+    clientHelper.SetAttribute("UserInfoFile", StringValue(userInfoFile));
+    clientHelper.SetAttribute(
+        "HandoverHorizon",
+        IntegerValue((int64_t)(handoverHorizon * 1000000)));
+    clientHelper.SetAttribute("HandoverHysteresis",
+                              DoubleValue(handoverHysteresis));
+    clientHelper.SetAttribute(
+        "HandoverTimeToTrigger",
+        IntegerValue((int64_t)(handoverTimeToTrigger * 1000)));
+    for (uint32_t i = 0; i < extraServerAddresses.size(); i++) {
+      clientHelper.AddServer(extraServerAddresses.at(i), port);
+    }
 
     ApplicationContainer clientApps = clientHelper.Install(clients);
-    clientApps.Get(0)->SetStartTime(Seconds(2));
-    clientApps.Get(0)->SetStopTime(Seconds(302));
-    
-    int *clientsNum;
-    int numOfeNbs = 0;
-    int intervaleNb = 0;
-    int clientsNum_0[7] = {2,4,1,7,6,2,9};//25
-    int intervalNum_0[7] = {0};
-    int clientsNum_6[3] = {1,6,3};//8
-    int clientsNum_12[6] = {2,4,1,6,8,3};//19
-    int clientsNum_18[9] = {2,1,3,7,9,3,5,1,7};//30
-    if (scenarioId == 6){
-      clientsNum = clientsNum_6;
-      numOfeNbs = 3;
-      intervaleNb = 30;
-    }else if(scenarioId == 12){
-      clientsNum = clientsNum_12;
-      numOfeNbs = 6;
-      intervaleNb = 15;
-    }else if(scenarioId == 18){
-      clientsNum = clientsNum_18;
-      numOfeNbs = 9;
-      intervaleNb = 10;
-    }else{
-      for(int m=0;m<7;m++){
-        intervalNum_0[m] = rand() % 15 + 5;
-      }
-      clientsNum = clientsNum_0;
-      numOfeNbs = 0;
+    for (uint32_t i = 0; i < clientApps.GetN(); i++) {
+      // the cross-layer estimate reads the transport blocks of the own UE
+      uint64_t imsi = ue_devs.Get(i)->GetObject<LteUeNetDevice>()->GetImsi();
+      clientApps.Get(i)->SetAttribute("Imsi", UintegerValue(imsi));
     }
-    int client_id = 1;
-    std::cout <<"scenarioId: " <<scenarioId<<std::endl;
-    if (numOfeNbs != 0){
-      //std::cout << "wrong!!!"<<std::endl;
-      for(int i=0;i<numOfeNbs;i++){
-        for (int j=0;j<clientsNum[i]-1;j++){
-          if (i==0){
-          clientApps.Get(client_id)->SetStartTime(Seconds(2));
-          clientApps.Get(client_id)->SetStopTime(Seconds(intervaleNb));
-          std::cout << client_id << "start at:" << 2 << "\t"
-                  << "end at:" << intervaleNb
-                  << std::endl;
-          client_id++;
-          }else{
-          clientApps.Get(client_id)->SetStartTime(Seconds(i*intervaleNb));
-          clientApps.Get(client_id)->SetStopTime(Seconds(i*intervaleNb+intervaleNb));
-          std::cout << client_id << "start at:" << i*intervaleNb<< "\t"
-                  << "end at:" << i*intervaleNb+intervaleNb
-                  << std::endl;
-          client_id++;
-          }
-        }
+    if (coordinateCells) {
+      // one coordinator per cell, every client joins the one of the serving
+      // cell of its UE and follows the UE at handovers
+      std::map<uint16_t, Ptr<CellCoordinator>> coordinators;
+      for (uint32_t i = 0; i < eNb_devs.GetN(); i++) {
+        Ptr<LteEnbNetDevice> enb =
+            eNb_devs.Get(i)->GetObject<LteEnbNetDevice>();
+        Ptr<CellCoordinator> coordinator = CreateObject<CellCoordinator>();
+        coordinator->SetCell(lte_phy_rx_stats, enb->GetCellId(),
+                             enb->GetDlBandwidth());
+        coordinators[enb->GetCellId()] = coordinator;
       }
-    }else{
-       int interTemp = 2;
-       for(int i=0;i<7;i++){
-        for (int j=0;j<clientsNum[i]-1;j++){
-          if (i==0){
-          clientApps.Get(client_id)->SetStartTime(Seconds(2));
-          clientApps.Get(client_id)->SetStopTime(Seconds(2+intervalNum_0[0]));
-          std::cout << client_id << "start at:" << 2 << "\t"
-                  << "end at:" << 2+intervalNum_0[0]
-                  << std::endl;
-          client_id++;
-          }else{
-          clientApps.Get(client_id)->SetStartTime(Seconds(interTemp));
-          clientApps.Get(client_id)->SetStopTime(Seconds(interTemp + intervalNum_0[i]));
-          std::cout << client_id << "start at:" <<interTemp<< "\t"
-                  << "end at:" << interTemp + intervalNum_0[i]
-                  << std::endl;
-          client_id++;
-          }
-        }
-        interTemp = interTemp + intervalNum_0[i];
+      for (uint32_t i = 0; i < clientApps.GetN(); i++) {
+        Ptr<TcpStreamClient> client =
+            clientApps.Get(i)->GetObject<TcpStreamClient>();
+        uint16_t cellId =
+            ue_devs.Get(i)->GetObject<LteUeNetDevice>()->GetRrc()->GetCellId();
+        client->SetAttribute("Coordinator",
+                             PointerValue(coordinators.at(cellId)));
+        client->SetCoordinators(coordinators);
       }
     }
-    /*==============================================================================
-    if (scenarioId == 6) {
-      srand((unsigned)time(NULL));
-      const int eNbs = 3;
-      std::vector<int> temp(15, 0);
-      std::vector<std::vector<int>> randommap;
-      for (int i = 0; i < eNbs; ++i) {
-        int random = rand() % 15;
-        for (int i = 0; i < random; ++i) {
-          temp.at(i) = 1;
-        }
-        randommap.push_back(temp);
-        for (auto &item : temp) {
-          item = 0;
-        }
-      }
-      for (int i = 0; i < 15; ++i) {
-        for (int j = 0; j < eNbs; ++j) {
-          std::cout << randommap[j][15 - i - 1] << " ";
-        }
-        std::cout << std::endl;
-      }
-      std::vector<std::pair<int, int>> timestamp;
-      for (int col = 0; col < 15; ++col) {
-        int row = 0;
-        while (row < eNbs) {
-          while (row < eNbs && randommap[row][col] == 0) {
-            ++row;
-          }
-          int begin = row;
-          while (row < eNbs && randommap[row][col] == 1) {
-            ++row;
-          }
-          int end = row - 1;
-          if (end >= begin) {
-            timestamp.push_back(std::make_pair(begin, end + 1));
-          }
-        }
+    if (numberOfEnbs > 1) {
+      // the clients learn of the handovers of their UE and predict them
+      // from its measurements
+      for (uint32_t i = 0; i < clientApps.GetN(); i++) {
+        Ptr<TcpStreamClient> client =
+            clientApps.Get(i)->GetObject<TcpStreamClient>();
+        Ptr<LteUeNetDevice> ue = ue_devs.Get(i)->GetObject<LteUeNetDevice>();
+        ue->GetRrc()->TraceConnectWithoutContext(
+            "HandoverStart",
+            MakeCallback(&TcpStreamClient::NotifyHandoverStart, client));
+        ue->GetRrc()->TraceConnectWithoutContext(
+            "HandoverEndOk",
+            MakeCallback(&TcpStreamClient::NotifyHandoverEndOk, client));
+        ue->GetRrc()->TraceConnectWithoutContext(
+            "HandoverEndError",
+            MakeCallback(&TcpStreamClient::NotifyHandoverEndError, client));
+        ue->GetPhy()->TraceConnectWithoutContext(
+            "ReportUeMeasurements",
+            MakeCallback(&TcpStreamClient::NotifyUeMeasurements, client));
       }
-      for (uint i = 1; i <= timestamp.size(); ++i) {
-        clientApps.Get(i)->SetStartTime(
-            Seconds(2 + timestamp.at(i - 1).first * 30));
-        clientApps.Get(i)->SetStopTime(
-            Seconds(2 + timestamp.at(i - 1).second * 30));
-        std::cout << "start at:" << 2 + timestamp.at(i - 1).first * 30 << "\t"
-                  << "end at:" << 2 + timestamp.at(i - 1).second * 30
-                  << std::endl;
-      }
-    } else if (scenarioId == 12) {
-      srand((unsigned)time(NULL));
-      const int eNbs = 6;
-      std::vector<int> temp(15, 0);
-      std::vector<std::vector<int>> randommap;
-      for (int i = 0; i < eNbs; ++i) {
-        int random = rand() % 15;
-        for (int i = 0; i < random; ++i) {
-          temp.at(i) = 1;
-        }
-        randommap.push_back(temp);
-        for (auto &item : temp) {
-          item = 0;
-        }
-      }
-      for (int i = 0; i < 15; ++i) {
-        for (int j = 0; j < eNbs; ++j) {
-          std::cout << randommap[j][15 - i - 1] << " ";
-        }
-        std::cout << std::endl;
-      }
-      std::vector<std::pair<int, int>> timestamp;
-      for (int col = 0; col < 15; ++col) {
-        int row = 0;
-        while (row < eNbs) {
-          while (row < eNbs && randommap[row][col] == 0) {
-            ++row;
-          }
-          int begin = row;
-          while (row < eNbs && randommap[row][col] == 1) {
-            ++row;
-          }
-          int end = row - 1;
-          if (end >= begin) {
-            timestamp.push_back(std::make_pair(begin, end + 1));
-          }
-        }
-      }
-      for (uint i = 1; i <= timestamp.size(); ++i) {
-        clientApps.Get(i)->SetStartTime(
-            Seconds(2 + timestamp.at(i - 1).first * 15));
-        clientApps.Get(i)->SetStopTime(
-            Seconds(2 + timestamp.at(i - 1).second * 15));
-        std::cout << "start at:" << 2 + timestamp.at(i - 1).first * 15 << "\t"
-                  << "end at:" << 2 + timestamp.at(i - 1).second * 15
-                  << std::endl;
-      }
-    } else if (scenarioId == 18) {
-      srand((unsigned)time(NULL));
-      const int eNbs = 9;
-      std::vector<int> temp(15, 0);
-      std::vector<std::vector<int>> randommap;
-      for (int i = 0; i < eNbs; ++i) {
-        int random = rand() % 15;
-        for (int i = 0; i < random; ++i) {
-          temp.at(i) = 1;
-        }
-        randommap.push_back(temp);
-        for (auto &item : temp) {
-          item = 0;
-        }
-      }
-      for (int i = 0; i < 15; ++i) {
-        for (int j = 0; j < eNbs; ++j) {
-          std::cout << randommap[j][15 - i - 1] << " ";
-        }
-        std::cout << std::endl;
-      }
-      std::vector<std::pair<int, int>> timestamp;
-      for (int col = 0; col < 15; ++col) {
-        int row = 0;
-        while (row < eNbs) {
-          while (row < eNbs && randommap[row][col] == 0) {
-            ++row;
-          }
-          int begin = row;
-          while (row < eNbs && randommap[row][col] == 1) {
-            ++row;
-          }
-          int end = row - 1;
-          if (end >= begin) {
-            timestamp.push_back(std::make_pair(begin, end + 1));
-          }
-        }
-      }
-      for (uint i = 1; i <= timestamp.size(); ++i) {
-        clientApps.Get(i)->SetStartTime(
-            Seconds(2 + timestamp.at(i - 1).first * 10));
-        clientApps.Get(i)->SetStopTime(
-            Seconds(2 + timestamp.at(i - 1).second * 10));
-        std::cout << "start at:" << 2 + timestamp.at(i - 1).first * 10 << "\t"
-                  << "end at:" << 2 + timestamp.at(i - 1).second * 10
-                  << std::endl;
-      }
-    } else if (scenarioId == 0) {  // speed == 0
-      srand((unsigned)time(NULL));
-      const int eNbs = 9;
-      std::vector<int> temp(15, 0);
-      std::vector<std::vector<int>> randommap;
-      for (int i = 0; i < eNbs; ++i) {
-        int random = rand() % 15;
-        for (int i = 0; i < random; ++i) {
-          temp.at(i) = 1;
-        }
-        randommap.push_back(temp);
-        for (auto &item : temp) {
-          item = 0;
-        }
-      }
-      for (int i = 0; i < 15; ++i) {
-        for (int j = 0; j < eNbs; ++j) {
-          std::cout << randommap[j][15 - i - 1] << " ";
-        }
-        std::cout << std::endl;
-      }
-      std::vector<std::pair<int, int>> timestamp;
-      for (int col = 0; col < 15; ++col) {
-        int row = 0;
-        while (row < eNbs) {
-          while (row < eNbs && randommap[row][col] == 0) {
-            ++row;
-          }
-          int begin = row;
-          while (row < eNbs && randommap[row][col] == 1) {
-            ++row;
-          }
-          int end = row - 1;
-          if (end >= begin) {
-            timestamp.push_back(std::make_pair(begin, end + 1));
-          }
-        }
-      }
-      for (uint i = 1; i <= timestamp.size(); ++i) {
-        clientApps.Get(i)->SetStartTime(
-            Seconds(2 + timestamp.at(i - 1).first * 10));
-        clientApps.Get(i)->SetStopTime(
-            Seconds(2 + timestamp.at(i - 1).second * 10));
-        std::cout << "start at:" << 2 + timestamp.at(i - 1).first * 10 << "\t"
-                  << "end at:" << 2 + timestamp.at(i - 1).second * 10
-                  << std::endl;
-      }
-    } else {
-      NS_ASSERT_MSG(scenarioId == 6 || scenarioId == 12 || scenarioId == 18 ||
-                        scenarioId == 0,
-                    "Invalid speed!");
     }
-    ===========================================================================*/
+    for (uint32_t i = 0; i < clientApps.GetN(); i++) {
+      const clientGroup &group = scenario.groups[ueGroup[i]];
+      // relative to now, which is the end of the warm up when forked
+      clientApps.Get(i)->SetStartTime(Seconds(group.start - warmup));
+      clientApps.Get(i)->SetStopTime(Seconds(group.stop - warmup));
+    }
     NS_LOG_INFO("Run Simulation.");
     NS_LOG_INFO("Sim:   " << simulationId
                           << "   Clients:   " << numberOfClients);
-    Simulator::Stop(Seconds(121));
+    Simulator::Stop(Seconds(scenario.stopTime - warmup));
+    DecisionProfiler::Enable(profileDecisions);
+    if (algorithms.empty()) {
+      setupEnd = std::chrono::steady_clock::now();
+    }
     Simulator::Run();
+    {
+      // how the run scales: wall time, events and memory
+      double setup = std::chrono::duration<double>(setupEnd - wallStart)
+                         .count();
+      double wall = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - setupEnd)
+                        .count();
+      Ptr<EventCountingSimulatorImpl> counting =
+          DynamicCast<EventCountingSimulatorImpl>(
+              Simulator::GetImplementation());
+      uint64_t events = counting != 0 ? counting->GetEvents() : 0;
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+      std::ofstream runtimeLog;
+      std::string runtimeLogName =
+          ssubdir + "sim" + ToString(simulationId) + "_" + "runtime.txt";
+      runtimeLog.open(runtimeLogName.c_str());
+      runtimeLog << "UEs eNBs SimulatedTime SetupTime WallTime Events "
+                    "EventsPerSecond PeakRSS\n"
+                 << numberOfClients << " " << numberOfEnbs << " "
+                 << Simulator::Now().GetSeconds() << " " << setup << " "
+                 << wall << " " << events << " "
+                 << (wall > 0 ? events / wall : 0) << " "
+                 << usage.ru_maxrss / 1024.0 << "\n";
+      runtimeLog.close();
+      NS_LOG_INFO("Run: " << wall << " s, " << events << " events, "
+                          << usage.ru_maxrss / 1024.0 << " MB");
+    }
+    if (profileDecisions) {
+      std::ofstream latencyLog;
+      std::string latencyLogName =
+          ssubdir + "sim" + ToString(simulationId) + "_" +
+          "decisionLatency.txt";
+      latencyLog.open(latencyLogName.c_str());
+      DecisionProfiler::PrintStats(latencyLog);
+      DecisionProfiler::PrintStats(std::cout);
+      latencyLog.close();
+    }
+    if (cache != 0) {
+      std::ofstream cacheLog;
+      std::string cacheLogName =
+          ssubdir + "sim" + ToString(simulationId) + "_" + "cacheLog.txt";
+      cacheLog.open(cacheLogName.c_str());
+      cache->PrintCacheStats(cacheLog);
+      cache->PrintCacheStats(std::cout);
+      cacheLog.close();
+    }
+    if (numberOfServers > 1) {
+      // how the clients spread over the servers
+      std::vector<Ptr<TcpStreamServer>> servers;
+      if (cache != 0) {
+        servers.push_back(cache);
+      } else {
+        servers.push_back(serverApp.Get(0)->GetObject<TcpStreamServer>());
+      }
+      for (uint32_t i = 0; i < extraServerApps.GetN(); i++) {
+        servers.push_back(extraServerApps.Get(i)->GetObject<TcpStreamServer>());
+      }
+      std::ofstream serverLog;
+      std::string serverLogName =
+          ssubdir + "sim" + ToString(simulationId) + "_" + "serverLog.txt";
+      serverLog.open(serverLogName.c_str());
+      serverLog << "Server Requests Bytes\n";
+      for (uint32_t i = 0; i < servers.size(); i++) {
+        std::vector<connectionStats> stats = servers.at(i)->GetConnectionStats();
+        uint64_t requests = 0;
+        uint64_t bytes = 0;
+        for (uint32_t j = 0; j < stats.size(); j++) {
+          requests += stats.at(j).requestsServed;
+          bytes += stats.at(j).bytesSent;
+        }
+        serverLog << std::setfill(' ') << std::setw(6) << i << " "
+                  << std::setfill(' ') << std::setw(8) << requests << " "
+                  << std::setfill(' ') << std::setw(12) << bytes << "\n";
+      }
+      serverLog.close();
+    }
     Simulator::Destroy();
     NS_LOG_INFO("Done.");
   }
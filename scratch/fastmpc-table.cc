@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Generates the FastMPC decision table of MpcAlgorithm for the bitrate
+//   ladder of a segment size file
+// - Use it with --ns3::MpcAlgorithm::DecisionTable=<output> and the same
+//   segmentDuration in scratch/dash
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FastMpcTable");
+
+int main(int argc, char *argv[]) {
+  LogComponentEnable("FastMpcTable", LOG_LEVEL_INFO);
+
+  std::string segmentSizeFile = "SegmentSize.txt";
+  std::string output = "fastmpc.txt";
+  uint64_t segmentDuration = 1000000;
+  uint32_t horizon = 5;
+  double rebufferPenalty = 1.0;
+  double smoothPenalty = 1.0;
+  int64_t bufferUpperbound = 40000000;
+  uint32_t bufferBins = 41;
+  uint32_t throughputBins = 64;
+  double throughputMin = 0;
+  double throughputMax = 0;
+
+  CommandLine cmd;
+  cmd.AddValue("segmentSizeFile",
+               "Segment sizes, one line per representation, as read by the "
+               "client",
+               segmentSizeFile);
+  cmd.AddValue("output", "The file the table is written to", output);
+  cmd.AddValue("segmentDuration",
+               "The duration of a video segment in microseconds",
+               segmentDuration);
+  cmd.AddValue("horizon", "Number of future segments planned for", horizon);
+  cmd.AddValue("rebufferPenalty", "QoE penalty per second of stall",
+               rebufferPenalty);
+  cmd.AddValue("smoothPenalty", "QoE penalty per bitrate change",
+               smoothPenalty);
+  cmd.AddValue("bufferUpperbound",
+               "Buffer level in microseconds the buffer never exceeds",
+               bufferUpperbound);
+  cmd.AddValue("bufferBins", "Number of buffer levels in the table",
+               bufferBins);
+  cmd.AddValue("throughputBins", "Number of throughputs in the table",
+               throughputBins);
+  cmd.AddValue("throughputMin",
+               "Lowest throughput in bps [default: half the lowest bitrate]",
+               throughputMin);
+  cmd.AddValue("throughputMax",
+               "Highest throughput in bps [default: twice the highest "
+               "bitrate]",
+               throughputMax);
+  cmd.Parse(argc, argv);
+
+  // the average bitrates exactly as TcpStreamClient::ReadInBitrateValues
+  // computes them, so the table matches the ladder of the client
+  std::ifstream sizes(segmentSizeFile.c_str());
+  if (!sizes) {
+    NS_LOG_ERROR("Opening " << segmentSizeFile << " failed.");
+    return 1;
+  }
+  std::vector<double> bitrates;
+  std::string temp;
+  while (std::getline(sizes, temp)) {
+    if (temp.empty()) break;
+    std::istringstream buffer(temp);
+    std::vector<int64_t> line((std::istream_iterator<int64_t>(buffer)),
+                              std::istream_iterator<int64_t>());
+    if (segmentDuration != 1000000) {
+      int64_t alpha = segmentDuration / 1000000;
+      for (auto it = line.begin(); it != line.end(); ++it) {
+        *it = *it * alpha;
+      }
+    }
+    int64_t averageByteSize =
+        (int64_t)std::accumulate(line.begin(), line.end(), 0.0) / line.size();
+    bitrates.push_back((8.0 * averageByteSize) /
+                       (segmentDuration / 1000000.0));
+  }
+  if (bitrates.empty()) {
+    NS_LOG_ERROR("No segment sizes read from " << segmentSizeFile << ".");
+    return 1;
+  }
+  if (throughputMin <= 0) throughputMin = bitrates.front() / 2;
+  if (throughputMax <= throughputMin) throughputMax = 2 * bitrates.back();
+
+  mpcParameters parameters;
+  parameters.horizon = horizon;
+  parameters.rebufferPenalty = rebufferPenalty;
+  parameters.smoothPenalty = smoothPenalty;
+  parameters.bufferUpperbound = bufferUpperbound;
+
+  FastMpcTable table;
+  table.Generate(bitrates, segmentDuration, parameters, bufferBins,
+                 throughputBins, throughputMin, throughputMax);
+
+  std::ofstream out(output.c_str());
+  table.Save(out);
+  if (!out) {
+    NS_LOG_ERROR("Writing " << output << " failed.");
+    return 1;
+  }
+  NS_LOG_INFO("Wrote the " << bitrates.size() << "x" << bufferBins << "x"
+                           << throughputBins << " FastMPC table to "
+                           << output);
+  return 0;
+}
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// - Converts a policy network trained offline into the weight file of
+//   NeuralAdaptationAlgorithm
+// - The input is a text dump, e.g. written from the trained model with numpy:
+//     mlp <history> <representations> <viewpoints>
+//     layer <inputs> <outputs> <relu | tanh | linear>
+//     <outputs lines of inputs weights>
+//     <outputs biases>
+//     layer ...
+// - Use the output with --adaptationAlgo=neural
+//   --ns3::NeuralAdaptationAlgorithm::WeightFile=<output>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NeuralExport");
+
+int main(int argc, char *argv[]) {
+  LogComponentEnable("NeuralExport", LOG_LEVEL_INFO);
+
+  std::string input = "policy.txt";
+  std::string output = "policy.bin";
+
+  CommandLine cmd;
+  cmd.AddValue("input", "The text dump of the trained network", input);
+  cmd.AddValue("output", "The file the weights are written to", output);
+  cmd.Parse(argc, argv);
+
+  std::ifstream in(input.c_str());
+  if (!in) {
+    NS_LOG_ERROR("Opening " << input << " failed.");
+    return 1;
+  }
+  std::string keyword;
+  uint32_t history, representations, viewpoints;
+  if (!(in >> keyword >> history >> representations >> viewpoints) ||
+      keyword != "mlp") {
+    NS_LOG_ERROR(input << " does not start with mlp <history> "
+                          "<representations> <viewpoints>.");
+    return 1;
+  }
+
+  MlpPolicy policy;
+  policy.SetLayout(history, representations, viewpoints);
+  uint32_t inputs, outputs;
+  std::string name;
+  while (in >> keyword >> inputs >> outputs >> name) {
+    MlpPolicy::activation act;
+    if (name == "relu") {
+      act = MlpPolicy::RELU;
+    } else if (name == "tanh") {
+      act = MlpPolicy::TANH;
+    } else if (name == "linear") {
+      act = MlpPolicy::LINEAR;
+    } else {
+      NS_LOG_ERROR("Unknown activation " << name << ".");
+      return 1;
+    }
+    std::vector<float> weights((size_t)inputs * outputs);
+    std::vector<float> biases(outputs);
+    for (size_t i = 0; i < weights.size(); i++) {
+      in >> weights[i];
+    }
+    for (size_t i = 0; i < biases.size(); i++) {
+      in >> biases[i];
+    }
+    if (keyword != "layer" || !in ||
+        !policy.AddLayer(inputs, outputs, act, weights, biases)) {
+      NS_LOG_ERROR("Layer " << inputs << "x" << outputs << " of " << input
+                            << " is malformed or does not fit the layer "
+                               "before (the first takes "
+                            << policy.GetInputSize() << " inputs).");
+      return 1;
+    }
+  }
+  if (!policy.IsComplete()) {
+    NS_LOG_ERROR("The last layer of " << input << " needs "
+                                      << representations << " outputs.");
+    return 1;
+  }
+
+  std::ofstream out(output.c_str(), std::ios::binary);
+  policy.Save(out);
+  if (!out) {
+    NS_LOG_ERROR("Writing " << output << " failed.");
+    return 1;
+  }
+  NS_LOG_INFO("Wrote the policy network for " << representations
+                                              << " representations to "
+                                              << output);
+  return 0;
+}
@@ -19,6 +19,7 @@
  */
 #include "tcp-stream-helper.h"
 #include "ns3/names.h"
+#include "ns3/tcp-stream-cache.h"
 #include "ns3/tcp-stream-client.h"
 #include "ns3/tcp-stream-server.h"
 #include "ns3/uinteger.h"
@@ -61,6 +62,24 @@ Ptr<Application> TcpStreamServerHelper::InstallPriv(Ptr<Node> node) const {
   return app;
 }
 
+TcpStreamCacheHelper::TcpStreamCacheHelper(Address origin, uint16_t port) {
+  m_factory.SetTypeId(TcpStreamCache::GetTypeId());
+  SetAttribute("Port", UintegerValue(port));
+  SetAttribute("OriginAddress", AddressValue(origin));
+  SetAttribute("OriginPort", UintegerValue(port));
+}
+
+void TcpStreamCacheHelper::SetAttribute(std::string name,
+                                        const AttributeValue &value) {
+  m_factory.Set(name, value);
+}
+
+ApplicationContainer TcpStreamCacheHelper::Install(Ptr<Node> node) const {
+  Ptr<Application> app = m_factory.Create<TcpStreamCache>();
+  node->AddApplication(app);
+  return ApplicationContainer(app);
+}
+
 TcpStreamClientHelper::TcpStreamClientHelper(
     Address address, uint16_t port,
     const Ptr<PhyRxStatsCalculator> crossLayerInfo) {
@@ -89,6 +108,10 @@ void TcpStreamClientHelper::SetAttribute(std::string name,
   m_factory.Set(name, value);
 }
 
+void TcpStreamClientHelper::AddServer(Address ip, uint16_t port) {
+  m_servers.push_back(std::make_pair(ip, port));
+}
+
 ApplicationContainer TcpStreamClientHelper::Install(
     std::vector<std::pair<Ptr<Node>, std::string>> clients) const {
   ApplicationContainer apps;
@@ -107,6 +130,10 @@ Ptr<Application> TcpStreamClientHelper::InstallPriv(Ptr<Node> node,
                                                   UintegerValue(clientId));
   app->GetObject<TcpStreamClient>()->Initialise(algo, clientId,
                                                 m_crossLayerInfo);
+  for (uint32_t i = 0; i < m_servers.size(); i++) {
+    app->GetObject<TcpStreamClient>()->AddServer(m_servers.at(i).first,
+                                                 m_servers.at(i).second);
+  }
   node->AddApplication(app);
   return app;
 }
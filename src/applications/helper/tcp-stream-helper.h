@@ -21,6 +21,8 @@
 #define TCP_STREAM_HELPER_H
 
 #include <stdint.h>
+#include <utility>
+#include <vector>
 #include "ns3/application-container.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -99,6 +101,45 @@ class TcpStreamServerHelper {
   ObjectFactory m_factory;  //!< Object factory.
 };
 
+/**
+ * \ingroup TcpStream
+ * \brief Create an edge cache application which serves clients like a
+ * TcpStreamServer and fetches the segments it does not have from an origin
+ * server.
+ */
+class TcpStreamCacheHelper {
+ public:
+  /**
+   * Create TcpStreamCacheHelper which will make life easier for people trying
+   * to set up simulations with an edge cache.
+   *
+   * \param origin The address of the origin tcp stream server
+   * \param port The port the origin server listens on, the cache listens on
+   * the same port for clients
+   */
+  TcpStreamCacheHelper(Address origin, uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute(std::string name, const AttributeValue &value);
+
+  /**
+   * Create a TcpStreamCacheApplication on the specified Node.
+   *
+   * \param node The node on which to create the Application.
+   *
+   * \returns An ApplicationContainer holding the Application created,
+   */
+  ApplicationContainer Install(Ptr<Node> node) const;
+
+ private:
+  ObjectFactory m_factory;  //!< Object factory.
+};
+
 /**
  * \ingroup TcpStream
  * \brief Create an application which sends a UDP packet and waits for an echo
@@ -148,6 +189,16 @@ class TcpStreamClientHelper {
    */
   void SetAttribute(std::string name, const AttributeValue &value);
 
+  /**
+   * Add a server the clients may download segments from, in addition to the
+   * one given to the constructor. Which server is used for a segment is
+   * decided by the ServerSelection attribute of the clients.
+   *
+   * \param ip The IP address of the additional tcp stream server
+   * \param port The port number of the additional tcp stream server
+   */
+  void AddServer(Address ip, uint16_t port);
+
   /**
    * \param clients the nodes with the name of the adaptation algorithm to be
    * used
@@ -177,6 +228,8 @@ class TcpStreamClientHelper {
                                uint16_t clientId) const;
   ObjectFactory m_factory;  //!< Object factory.
   Ptr<PhyRxStatsCalculator> m_crossLayerInfo;
+  std::vector<std::pair<Address, uint16_t>>
+      m_servers;  //!< Servers added with AddServer
 };
 
 }  // namespace ns3
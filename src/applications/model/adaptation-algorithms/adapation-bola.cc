@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adapation-bola.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/integer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("BolaAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(BolaAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, BolaAlgorithm);
+
+TypeId BolaAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BolaAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("Variant",
+                        "basic for BOLA-BASIC, o for BOLA-O, which damps "
+                        "oscillations with the throughput of the last segment",
+                        EnumValue(BolaAlgorithm::BASIC),
+                        MakeEnumAccessor(&BolaAlgorithm::m_variant),
+                        MakeEnumChecker(BolaAlgorithm::BASIC, "basic",
+                                        BolaAlgorithm::O, "o"))
+          .AddAttribute("BufferTarget",
+                        "Buffer level in microseconds BOLA fills up to with "
+                        "the highest representation, at least 2 segments, 0 "
+                        "for 15 segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&BolaAlgorithm::m_bufferTarget),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("Gamma",
+                        "Weight of playback smoothness against utility, "
+                        "gamma times the segment duration of the paper",
+                        DoubleValue(5.0),
+                        MakeDoubleAccessor(&BolaAlgorithm::m_gamma),
+                        MakeDoubleChecker<double>(0.0));
+  return tid;
+}
+
+BolaAlgorithm::BolaAlgorithm(const videoData &videoData,
+                             const playbackData &playbackData,
+                             const bufferData &bufferData,
+                             const throughputData &throughput)
+    : AdaptationAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_variant(BASIC), m_bufferTarget(0), m_gamma(5.0), m_lastRepIndex(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void BolaAlgorithm::DoInitialize(void) {
+  // V is derived from the target in segments
+  const double target =
+      m_bufferTarget == 0
+          ? 15.0
+          : (double)m_bufferTarget / m_videoData.segmentDuration;
+  NS_ASSERT_MSG(target >= 2, "BufferTarget should be at least 2 segments");
+  m_ladders.clear();
+  for (uint32_t viewpoint = 0; viewpoint < m_videoData.ladders.size();
+       viewpoint++) {
+    const std::vector<double> &bitrates =
+        m_videoData.ladders[viewpoint].GetBitrates();
+    // the sizes are proportional to the average bitrates, only their ratios
+    // enter the utilities, and the scores are only compared to each other and
+    // to 0
+    const double lowest = std::max(bitrates.front(), 1.0);
+    const double v =
+        (target - 1) / (std::log(bitrates.back() / lowest) + m_gamma);
+    bolaLadder ladder;
+    for (uint32_t rep = 0; rep < bitrates.size(); rep++) {
+      double size = std::max(bitrates[rep], 1.0) / lowest;
+      double threshold = v * (std::log(size) + m_gamma);
+      ladder.gain.push_back(threshold / size);
+      ladder.cost.push_back(1.0 / size);
+      ladder.threshold.push_back(threshold);
+    }
+    m_ladders.push_back(ladder);
+  }
+  AdaptationAlgorithm::DoInitialize();
+}
+
+int64_t BolaAlgorithm::GetBestRep(const bolaLadder &ladder, double q,
+                                  int64_t highest) {
+  int64_t best = 0;
+  double bestScore = ladder.gain[0] - q * ladder.cost[0];
+  for (int64_t rep = 1; rep <= highest; rep++) {
+    double score = ladder.gain[rep] - q * ladder.cost[rep];
+    if (score >= bestScore) {
+      best = rep;
+      bestScore = score;
+    }
+  }
+  return best;
+}
+
+algorithmReply BolaAlgorithm::GetNextRep(const int64_t segmentCounter,
+                                         const int64_t clientId,
+                                         int64_t bandwidth) {
+  algorithmReply answer;
+  answer.decisionCase = 0;
+  answer.delayDecisionCase = 0;
+  answer.nextDownloadDelay = 0;
+  answer.nextRepIndex = 0;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+  answer.estimateTh = bandwidth;
+
+  if (segmentCounter == 0) {
+    m_lastRepIndex = 0;
+    return answer;
+  }
+
+  const int64_t bufferNow = std::max<int64_t>(
+      0, m_bufferData.bufferLevelNew.back() -
+             (timeNow - m_throughput.transmissionEnd.back()));
+  const double q = (double)bufferNow / m_videoData.segmentDuration;
+  const int64_t viewpoint = m_videoData.userInfo.at(segmentCounter);
+  const bolaLadder &ladder = m_ladders.at(viewpoint);
+
+  int64_t best = GetBestRep(ladder, q, m_highestRepIndex);
+  if (CapRepIndex(best, viewpoint) < best) {
+    best = GetBestRep(ladder, q, GetMaxRepIndex(viewpoint));
+  }
+  const double bestScore = ladder.gain[best] - q * ladder.cost[best];
+  answer.decisionCase = 1;
+
+  if (bestScore < 0) {
+    // the buffer is above the level of every representation: wait until the
+    // highest one is worth downloading
+    best = CapRepIndex(m_highestRepIndex, viewpoint);
+    answer.nextDownloadDelay =
+        (q - ladder.threshold[best]) * m_videoData.segmentDuration;
+    answer.decisionCase = 2;
+    answer.delayDecisionCase = 1;
+  } else if (m_variant == O && best > m_lastRepIndex) {
+    const int64_t last = m_throughput.bytesReceived.size() - 1;
+    const int64_t transmissionTime = m_throughput.transmissionEnd.at(last) -
+                                     m_throughput.transmissionStart.at(last);
+    const double lastThroughput =
+        transmissionTime > 0 ? 8.0 * m_throughput.bytesReceived.at(last) *
+                                   1000000.0 / transmissionTime
+                             : 0.0;
+    const int64_t sustainable =
+        m_videoData.ladders.at(viewpoint).GetHighestRepBelow(lastThroughput);
+    if (sustainable < best) {
+      best = std::max(sustainable, m_lastRepIndex);
+      answer.decisionCase = 3;
+      // wait until BOLA itself would choose the lower representation
+      if (q > ladder.threshold[best]) {
+        answer.nextDownloadDelay =
+            (q - ladder.threshold[best]) * m_videoData.segmentDuration;
+        answer.delayDecisionCase = 2;
+      }
+    }
+  }
+
+  answer.nextRepIndex = best;
+  m_lastRepIndex = best;
+  return answer;
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BOLA_ALGORITHM_H
+#define BOLA_ALGORITHM_H
+
+#include "tcp-stream-adaptation.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief BOLA, Lyapunov buffer-based adaptation.
+ *
+ * With the utility v_m = ln(S_m / S_1) of representation m, the buffer level
+ * Q in segments and V = (BufferTarget - 1) / (v_M + Gamma), BOLA requests the
+ * representation maximising (V (v_m + Gamma) - Q) / S_m, and waits while no
+ * representation has a positive score. The terms V (v_m + Gamma) / S_m and
+ * 1 / S_m are precomputed per viewpoint, so a decision is one pass over the
+ * ladder. No throughput estimate is used.
+ *
+ * BOLA-O additionally limits up-switches to the representation the
+ * throughput of the last segment sustains, but never below the last one,
+ * and waits until the buffer has drained to the level at which BOLA would
+ * choose that representation, which avoids oscillations.
+ */
+class BolaAlgorithm : public AdaptationAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  BolaAlgorithm(const videoData &videoData, const playbackData &playbackData,
+                const bufferData &bufferData,
+                const throughputData &throughput);
+
+  algorithmReply GetNextRep(const int64_t segmentCounter,
+                            const int64_t clientId, int64_t bandwidth);
+
+  /**
+   * \brief The BOLA variants.
+   */
+  enum bolaVariant {
+    BASIC, //!< BOLA-BASIC
+    O      //!< BOLA-O, with oscillation control
+  };
+
+protected:
+  /**
+   * \brief Precompute the score terms of every viewpoint.
+   */
+  virtual void DoInitialize(void);
+
+private:
+  /**
+   * \brief The precomputed terms of the ladder of one viewpoint.
+   */
+  struct bolaLadder {
+    std::vector<double> gain; //!< V (v_m + Gamma) / S_m
+    std::vector<double> cost; //!< 1 / S_m, per segment of buffer
+    std::vector<double>
+        threshold; //!< V (v_m + Gamma), the buffer level in segments up
+                   //!< to which representation m has a positive score
+  };
+
+  /**
+   * \brief Find the representation with the highest score.
+   * \param ladder the terms of the viewpoint
+   * \param q the buffer level in segments
+   * \param highest the highest representation to consider
+   * \return the representation, the highest one among equal scores
+   */
+  static int64_t GetBestRep(const bolaLadder &ladder, double q,
+                            int64_t highest);
+
+  bolaVariant m_variant;
+  int64_t m_bufferTarget; //!< BufferTarget in microseconds, 0 for 15
+                          //!< segments
+  double m_gamma;        //!< Gamma
+  std::vector<bolaLadder> m_ladders; //!< per viewpoint
+  int64_t m_lastRepIndex;
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* BOLA_ALGORITHM_H */
@@ -1,9 +1,25 @@
 #include "adapation-constbitrate.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("constbitrateAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(constbitrateAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, constbitrateAlgorithm);
+
+TypeId constbitrateAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::constbitrateAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "RepIndex",
+              "The representation index requested for every segment",
+              IntegerValue(4),
+              MakeIntegerAccessor(&constbitrateAlgorithm::m_constRepIndex),
+              MakeIntegerChecker<int64_t>(0));
+  return tid;
+}
 
 constbitrateAlgorithm::constbitrateAlgorithm(const videoData &videoData,
                                              const playbackData &playbackData,
@@ -12,7 +28,7 @@ constbitrateAlgorithm::constbitrateAlgorithm(const videoData &videoData,
     : AdaptationAlgorithm(videoData, playbackData, bufferData, throughput),
       m_constRepIndex(4),
       m_bufferUpperbound(m_videoData.segmentDuration * 15),  // 15s
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be => 0");
@@ -22,10 +38,11 @@ algorithmReply constbitrateAlgorithm::GetNextRep(const int64_t segmentCounter,
                                                  int64_t clientId,
                                                  int64_t bandwidth) {
   algorithmReply answer;
-  int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
 
-  answer.nextRepIndex = m_constRepIndex;
+  answer.nextRepIndex =
+      CapRepIndex(m_constRepIndex, m_videoData.userInfo.at(segmentCounter));
   answer.decisionCase = 0;
 
   answer.nextDownloadDelay = 0;
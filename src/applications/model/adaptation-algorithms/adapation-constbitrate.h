@@ -7,6 +7,12 @@ namespace ns3 {
 
 class constbitrateAlgorithm : public AdaptationAlgorithm {
  public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   constbitrateAlgorithm(const videoData &videoData,
                         const playbackData &playbackData,
                         const bufferData &bufferData,
@@ -16,7 +22,7 @@ class constbitrateAlgorithm : public AdaptationAlgorithm {
                             const int64_t clientId, int64_t bandwidth);
 
  private:
-  const int64_t m_constRepIndex;
+  int64_t m_constRepIndex;
   const int64_t m_bufferUpperbound;
   const int64_t m_highestRepIndex;
 };
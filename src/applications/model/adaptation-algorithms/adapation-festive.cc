@@ -17,11 +17,62 @@
  */
 
 #include "adapation-festive.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("FestiveAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(FestiveAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, FestiveAlgorithm);
+
+TypeId FestiveAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::FestiveAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("TargetBuffer",
+                        "Buffer level in microseconds the random download "
+                        "delay aims for, 0 for 10 segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&FestiveAlgorithm::m_targetBuffer),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("Delta",
+                        "Half the width in microseconds of the range around "
+                        "TargetBuffer the delay is drawn from, 0 for 2 "
+                        "segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&FestiveAlgorithm::m_delta),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds, 0 for "
+              "15 segments",
+              IntegerValue(0),
+              MakeIntegerAccessor(&FestiveAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("Alpha",
+                        "Weight of the efficiency score against the "
+                        "stability score",
+                        DoubleValue(12.0),
+                        MakeDoubleAccessor(&FestiveAlgorithm::m_alpha),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("ThroughputThreshold",
+                        "Share of the estimated bandwidth the current "
+                        "representation may use before switching down",
+                        DoubleValue(0.95),
+                        MakeDoubleAccessor(&FestiveAlgorithm::m_thrptThrsh),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "SwitchUpAfter",
+              "Number of segments at the same representation after which "
+              "switching up is possible",
+              UintegerValue(3),
+              MakeUintegerAccessor(&FestiveAlgorithm::m_switchUpAfter),
+              MakeUintegerChecker<uint32_t>());
+  return tid;
+}
 
 FestiveAlgorithm::FestiveAlgorithm(const videoData &videoData,
                                    const playbackData &playbackData,
@@ -31,20 +82,32 @@ FestiveAlgorithm::FestiveAlgorithm(const videoData &videoData,
       m_targetBuffer(m_videoData.segmentDuration * 10),
       m_delta(m_videoData.segmentDuration * 2),
       m_alpha(12.0),
-      m_bufferUpperbound(m_videoData.segmentDuration * 15),  // 15s
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1),
-      m_thrptThrsh(0.95) {
+      m_bufferUpperbound(m_videoData.segmentDuration * 15),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()),
+      m_thrptThrsh(0.95),
+      m_switchUpAfter(3) {
   NS_LOG_INFO(this);
-  m_smooth.push_back(3);  // after how many steps switch up is possible
-  m_smooth.push_back(1);  // switch up by how many representatations at once
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be => 0");
 }
 
+void FestiveAlgorithm::DoInitialize(void) {
+  if (m_targetBuffer == 0) {
+    m_targetBuffer = m_videoData.segmentDuration * 10;
+  }
+  if (m_delta == 0) {
+    m_delta = m_videoData.segmentDuration * 2;
+  }
+  if (m_bufferUpperbound == 0) {
+    m_bufferUpperbound = m_videoData.segmentDuration * 15;
+  }
+  AdaptationAlgorithm::DoInitialize();
+}
+
 algorithmReply FestiveAlgorithm::GetNextRep(const int64_t segmentCounter,
                                             const int64_t clientId,
                                             int64_t bandwidth) {
-  int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  int64_t timeNow = AlgorithmClock::Now();
   bool decisionMade = false;
   algorithmReply answer;
   answer.decisionTime = timeNow;
@@ -88,10 +151,18 @@ algorithmReply FestiveAlgorithm::GetNextRep(const int64_t segmentCounter,
 
   int64_t currentRepIndex = m_playbackData.playbackIndex.back();
   int64_t refIndex = currentRepIndex;
+  const int64_t viewpoint = m_videoData.userInfo.at(segmentCounter);
+  const BitrateLadder &ladder = m_videoData.ladders.at(viewpoint);
+
+  if (currentRepIndex > GetMaxRepIndex(viewpoint)) {
+    // the cap dropped below the current representation
+    answer.nextRepIndex = CapRepIndex(currentRepIndex, viewpoint);
+    answer.decisionCase = 5;
+    return answer;
+  }
 
   if (currentRepIndex > 0 &&
-      m_videoData.averageBitrate.at(m_videoData.userInfo.at(segmentCounter))
-              .at(currentRepIndex) > thrptEstimation * m_thrptThrsh) {
+      ladder.GetBitrate(currentRepIndex) > thrptEstimation * m_thrptThrsh) {
     refIndex = currentRepIndex - 1;
     answer.decisionCase = 1;
     decisionMade = true;
@@ -102,24 +173,23 @@ algorithmReply FestiveAlgorithm::GetNextRep(const int64_t segmentCounter,
     for (unsigned _sd = m_playbackData.playbackIndex.size() - 1; _sd-- > 0;) {
       if (currentRepIndex == m_playbackData.playbackIndex.at(_sd)) {
         count++;
-        if (count >= m_smooth.at(0)) {
+        if (count >= (int)m_switchUpAfter) {
           break;
         }
       } else {
         break;
       }
     }
-    if (count >= m_smooth.at(0) &&
-        (double)m_videoData.averageBitrate
-                .at(m_videoData.userInfo.at(segmentCounter))
-                .at(currentRepIndex + 1) <= thrptEstimation) {
+    if (count >= (int)m_switchUpAfter &&
+        ladder.GetBitrate(currentRepIndex + 1) <= thrptEstimation) {
       refIndex = currentRepIndex + 1;
       answer.decisionCase = 1;
       decisionMade = true;
     }
   }
 
-  if (!decisionMade) {
+  refIndex = CapRepIndex(refIndex, viewpoint);
+  if (!decisionMade || refIndex == currentRepIndex) {
     answer.nextRepIndex = currentRepIndex;
     answer.decisionCase = 3;
     return answer;
@@ -139,25 +209,15 @@ algorithmReply FestiveAlgorithm::GetNextRep(const int64_t segmentCounter,
       foundIndices.push_back(currentRepIndex);
     }
   }
-  double scoreEfficiencyCurrent = std::abs(
-      (double)m_videoData.averageBitrate
-              .at(m_videoData.userInfo.at(segmentCounter))
-              .at(currentRepIndex) /
-          double(std::min(thrptEstimation,
-                          (double)m_videoData.averageBitrate
-                              .at(m_videoData.userInfo.at(segmentCounter))
-                              .at(refIndex))) -
-      1.0);
-
-  double scoreEfficiencyRef = std::abs(
-      (double)m_videoData.averageBitrate
-              .at(m_videoData.userInfo.at(segmentCounter))
-              .at(refIndex) /
-          double(std::min(thrptEstimation,
-                          (double)m_videoData.averageBitrate
-                              .at(m_videoData.userInfo.at(segmentCounter))
-                              .at(refIndex))) -
-      1.0);
+  double scoreEfficiencyCurrent =
+      std::abs(ladder.GetBitrate(currentRepIndex) /
+                   std::min(thrptEstimation, ladder.GetBitrate(refIndex)) -
+               1.0);
+
+  double scoreEfficiencyRef =
+      std::abs(ladder.GetBitrate(refIndex) /
+                   std::min(thrptEstimation, ladder.GetBitrate(refIndex)) -
+               1.0);
 
   double scoreStabilityCurrent = pow(2.0, (double)numberOfSwitches);
   double scoreStabilityRef = pow(2.0, ((double)numberOfSwitches)) + 1.0;
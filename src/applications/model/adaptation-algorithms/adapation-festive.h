@@ -29,6 +29,12 @@ namespace ns3 {
  */
 class FestiveAlgorithm : public AdaptationAlgorithm {
  public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   FestiveAlgorithm(const videoData &videoData, const playbackData &playbackData,
                    const bufferData &bufferData,
                    const throughputData &throughput);
@@ -36,14 +42,22 @@ class FestiveAlgorithm : public AdaptationAlgorithm {
   algorithmReply GetNextRep(const int64_t segmentCounter,
                             const int64_t clientId, int64_t bandwidth);
 
+ protected:
+  /**
+   * \brief Resolve the buffer levels left at 0 to their default number of
+   * segments.
+   */
+  virtual void DoInitialize(void);
+
  private:
   int64_t m_targetBuffer;
-  const int64_t m_delta;
-  const double m_alpha;
-  const int64_t m_bufferUpperbound;
+  int64_t m_delta;
+  double m_alpha;
+  int64_t m_bufferUpperbound;
   const int64_t m_highestRepIndex;
-  const double m_thrptThrsh;
-  std::vector<int> m_smooth;
+  double m_thrptThrsh;
+  uint32_t m_switchUpAfter;  //!< after how many segments at the same
+                             //!< representation switching up is possible
 };
 
 }  // namespace ns3
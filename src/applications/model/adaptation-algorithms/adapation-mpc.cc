@@ -0,0 +1,425 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adapation-mpc.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("MpcAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(MpcAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, MpcAlgorithm);
+
+namespace {
+/**
+ * \brief State of the exhaustive search over the plans of MpcAlgorithm::Solve.
+ */
+struct mpcSearch {
+  const std::vector<std::vector<int64_t>> *sizes;
+  const std::vector<double> *bitrates;
+  const mpcParameters *parameters;
+  double segmentDuration; //!< in microseconds
+  double throughput;      //!< in bps
+  double highestBitrate;  //!< the bitrates are relative to it
+  double bestQoe;         //!< QoE of the best plan so far
+  int64_t bestFirst;      //!< first representation of the best plan so far
+};
+
+void Search(mpcSearch &search, uint32_t step, double buffer,
+            int64_t lastRepIndex, double qoe, int64_t first) {
+  const uint32_t steps = search.sizes->size();
+  if (step == steps) {
+    if (qoe > search.bestQoe) {
+      search.bestQoe = qoe;
+      search.bestFirst = first;
+    }
+    return;
+  }
+  // no plan can do better than the highest bitrate without stalls or
+  // switches for the remaining segments
+  if (qoe + (steps - step) <= search.bestQoe) {
+    return;
+  }
+  const double lastQuality =
+      search.bitrates->at(lastRepIndex) / search.highestBitrate;
+  // try the higher representations first, so good plans bound the search
+  // early
+  for (int64_t rep = (*search.sizes)[step].size() - 1; rep >= 0; rep--) {
+    double download = 8.0 * (*search.sizes)[step][rep] * 1000000.0 /
+                      search.throughput;
+    double stall = std::max(0.0, download - buffer);
+    double next = std::max(0.0, buffer - download) + search.segmentDuration;
+    if (search.parameters->bufferUpperbound > 0) {
+      next = std::min(next, (double)search.parameters->bufferUpperbound);
+    }
+    double quality = search.bitrates->at(rep) / search.highestBitrate;
+    double reward = quality -
+                    search.parameters->rebufferPenalty * stall / 1000000.0 -
+                    search.parameters->smoothPenalty *
+                        std::fabs(quality - lastQuality);
+    Search(search, step + 1, next, rep, qoe + reward,
+           step == 0 ? rep : first);
+  }
+}
+} // namespace
+
+FastMpcTable::FastMpcTable()
+    : m_segmentDuration(0), m_bufferBins(0), m_throughputBins(0),
+      m_throughputMin(0), m_throughputMax(0) {
+  m_parameters.horizon = 0;
+  m_parameters.rebufferPenalty = 0;
+  m_parameters.smoothPenalty = 0;
+  m_parameters.bufferUpperbound = 0;
+}
+
+void FastMpcTable::Generate(const std::vector<double> &bitrates,
+                            int64_t segmentDuration,
+                            const mpcParameters &parameters,
+                            uint32_t bufferBins, uint32_t throughputBins,
+                            double throughputMin, double throughputMax) {
+  NS_ASSERT_MSG(!bitrates.empty() && bitrates.size() <= 256,
+                "FastMPC tables hold 1 to 256 representations");
+  NS_ASSERT_MSG(bufferBins > 1 && throughputBins > 1,
+                "FastMPC tables need at least two bins per dimension");
+  NS_ASSERT_MSG(parameters.bufferUpperbound > 0,
+                "FastMPC tables need a buffer upper bound");
+  NS_ASSERT_MSG(throughputMin > 0 && throughputMax > throughputMin,
+                "Invalid throughput range");
+  m_bitrates = bitrates;
+  m_segmentDuration = segmentDuration;
+  m_parameters = parameters;
+  m_bufferBins = bufferBins;
+  m_throughputBins = throughputBins;
+  m_throughputMin = throughputMin;
+  m_throughputMax = throughputMax;
+
+  // the table does not know the segments it will be used for, so every
+  // segment of the horizon has the average size of its representation
+  std::vector<int64_t> nominal;
+  for (uint32_t rep = 0; rep < bitrates.size(); rep++) {
+    nominal.push_back(bitrates[rep] * segmentDuration / 8000000.0);
+  }
+  std::vector<std::vector<int64_t>> sizes(parameters.horizon, nominal);
+
+  m_decisions.assign(bitrates.size() * bufferBins * throughputBins, 0);
+  uint32_t index = 0;
+  for (uint32_t last = 0; last < bitrates.size(); last++) {
+    for (uint32_t b = 0; b < bufferBins; b++) {
+      int64_t buffer = parameters.bufferUpperbound * b / (bufferBins - 1);
+      for (uint32_t t = 0; t < throughputBins; t++) {
+        double throughput =
+            throughputMin *
+            std::pow(throughputMax / throughputMin,
+                     (double)t / (throughputBins - 1));
+        m_decisions[index++] =
+            MpcAlgorithm::Solve(sizes, bitrates, segmentDuration, buffer,
+                                throughput, last, parameters);
+      }
+    }
+  }
+}
+
+void FastMpcTable::Save(std::ostream &os) const {
+  os << "fastmpc\n";
+  os << "representations " << m_bitrates.size();
+  for (uint32_t rep = 0; rep < m_bitrates.size(); rep++) {
+    os << " " << m_bitrates[rep];
+  }
+  os << "\n";
+  os << "segmentDuration " << m_segmentDuration << "\n";
+  os << "objective " << m_parameters.horizon << " "
+     << m_parameters.rebufferPenalty << " " << m_parameters.smoothPenalty
+     << " " << m_parameters.bufferUpperbound << "\n";
+  os << "buffer " << m_bufferBins << "\n";
+  os << "throughput " << m_throughputBins << " " << m_throughputMin << " "
+     << m_throughputMax << "\n";
+  os << "decisions\n";
+  uint32_t index = 0;
+  for (uint32_t row = 0; row < m_bitrates.size() * m_bufferBins; row++) {
+    for (uint32_t t = 0; t < m_throughputBins; t++) {
+      os << (t == 0 ? "" : " ") << (uint32_t)m_decisions[index++];
+    }
+    os << "\n";
+  }
+}
+
+bool FastMpcTable::Load(std::istream &is) {
+  std::string keyword;
+  uint32_t representations = 0;
+  if (!(is >> keyword) || keyword != "fastmpc") {
+    return false;
+  }
+  if (!(is >> keyword >> representations) || keyword != "representations" ||
+      representations == 0 || representations > 256) {
+    return false;
+  }
+  m_bitrates.assign(representations, 0);
+  for (uint32_t rep = 0; rep < representations; rep++) {
+    is >> m_bitrates[rep];
+  }
+  is >> keyword >> m_segmentDuration;
+  if (keyword != "segmentDuration") {
+    return false;
+  }
+  is >> keyword >> m_parameters.horizon >> m_parameters.rebufferPenalty >>
+      m_parameters.smoothPenalty >> m_parameters.bufferUpperbound;
+  if (keyword != "objective" || m_parameters.bufferUpperbound <= 0) {
+    return false;
+  }
+  is >> keyword >> m_bufferBins;
+  if (keyword != "buffer" || m_bufferBins < 2) {
+    return false;
+  }
+  is >> keyword >> m_throughputBins >> m_throughputMin >> m_throughputMax;
+  if (keyword != "throughput" || m_throughputBins < 2 ||
+      m_throughputMin <= 0 || m_throughputMax <= m_throughputMin) {
+    return false;
+  }
+  is >> keyword;
+  if (!is || keyword != "decisions") {
+    return false;
+  }
+  m_decisions.assign(representations * m_bufferBins * m_throughputBins, 0);
+  for (uint32_t i = 0; i < m_decisions.size(); i++) {
+    uint32_t decision;
+    if (!(is >> decision) || decision >= representations) {
+      return false;
+    }
+    m_decisions[i] = decision;
+  }
+  return true;
+}
+
+int64_t FastMpcTable::Lookup(int64_t buffer, double throughput,
+                             int64_t lastRepIndex) const {
+  int64_t b = 0;
+  if (buffer > 0) {
+    b = std::min<int64_t>(buffer * (m_bufferBins - 1) /
+                              m_parameters.bufferUpperbound,
+                          m_bufferBins - 1);
+  }
+  int64_t t = 0;
+  if (throughput > m_throughputMin) {
+    t = std::min<int64_t>(std::log(throughput / m_throughputMin) /
+                              std::log(m_throughputMax / m_throughputMin) *
+                              (m_throughputBins - 1),
+                          m_throughputBins - 1);
+  }
+  int64_t last = std::max<int64_t>(
+      0, std::min<int64_t>(lastRepIndex, m_bitrates.size() - 1));
+  return m_decisions[(last * m_bufferBins + b) * m_throughputBins + t];
+}
+
+const std::vector<double> &FastMpcTable::GetBitrates(void) const {
+  return m_bitrates;
+}
+
+int64_t FastMpcTable::GetSegmentDuration(void) const {
+  return m_segmentDuration;
+}
+
+TypeId MpcAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::MpcAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("Horizon", "Number of future segments planned for",
+                        UintegerValue(5),
+                        MakeUintegerAccessor(&MpcAlgorithm::m_horizon),
+                        MakeUintegerChecker<uint32_t>(1, 10))
+          .AddAttribute(
+              "RebufferPenalty",
+              "QoE penalty per second of stall, in units of the bitrate of "
+              "the highest representation",
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&MpcAlgorithm::m_rebufferPenalty),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "SmoothPenalty",
+              "QoE penalty per bitrate change, in units of the bitrate of "
+              "the highest representation",
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&MpcAlgorithm::m_smoothPenalty),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds",
+              IntegerValue(40000000),
+              MakeIntegerAccessor(&MpcAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(1))
+          .AddAttribute(
+              "DecisionTable",
+              "FastMPC table generated by scratch/fastmpc-table. If set, "
+              "the decisions are looked up in the table, which fixes the "
+              "objective, instead of being solved online",
+              StringValue(""),
+              MakeStringAccessor(&MpcAlgorithm::m_tableFile),
+              MakeStringChecker());
+  return tid;
+}
+
+MpcAlgorithm::MpcAlgorithm(const videoData &videoData,
+                           const playbackData &playbackData,
+                           const bufferData &bufferData,
+                           const throughputData &throughput)
+    : AdaptationAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_horizon(5), m_rebufferPenalty(1.0), m_smoothPenalty(1.0),
+      m_bufferUpperbound(40000000), m_fast(false), m_lastRepIndex(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void MpcAlgorithm::DoInitialize(void) {
+  m_parameters.horizon = m_horizon;
+  m_parameters.rebufferPenalty = m_rebufferPenalty;
+  m_parameters.smoothPenalty = m_smoothPenalty;
+  m_parameters.bufferUpperbound = m_bufferUpperbound;
+  if (!m_tableFile.empty()) {
+    std::ifstream file(m_tableFile.c_str());
+    if (!file || !m_table.Load(file)) {
+      NS_FATAL_ERROR("Could not read the FastMPC table " << m_tableFile);
+    }
+    if ((int64_t)m_table.GetBitrates().size() != m_highestRepIndex + 1) {
+      NS_FATAL_ERROR("The FastMPC table "
+                     << m_tableFile << " was generated for "
+                     << m_table.GetBitrates().size()
+                     << " representations, the video has "
+                     << m_highestRepIndex + 1);
+    }
+    if (m_table.GetSegmentDuration() != m_videoData.segmentDuration) {
+      NS_FATAL_ERROR("The FastMPC table "
+                     << m_tableFile << " was generated for segments of "
+                     << m_table.GetSegmentDuration() << " microseconds");
+    }
+    m_fast = true;
+  }
+  AdaptationAlgorithm::DoInitialize();
+}
+
+int64_t MpcAlgorithm::Solve(const std::vector<std::vector<int64_t>> &sizes,
+                            const std::vector<double> &bitrates,
+                            int64_t segmentDuration, int64_t buffer,
+                            double throughput, int64_t lastRepIndex,
+                            const mpcParameters &parameters) {
+  if (sizes.empty() || throughput <= 0) {
+    return 0;
+  }
+  mpcSearch search;
+  search.sizes = &sizes;
+  search.bitrates = &bitrates;
+  search.parameters = &parameters;
+  search.segmentDuration = segmentDuration;
+  search.throughput = throughput;
+  search.highestBitrate = bitrates.back();
+  search.bestQoe = -std::numeric_limits<double>::infinity();
+  search.bestFirst = 0;
+  Search(search, 0, buffer, lastRepIndex, 0.0, 0);
+  return search.bestFirst;
+}
+
+algorithmReply MpcAlgorithm::GetNextRep(const int64_t segmentCounter,
+                                        const int64_t clientId,
+                                        int64_t bandwidth) {
+  algorithmReply answer;
+  answer.decisionCase = 0;
+  answer.delayDecisionCase = 0;
+  answer.nextDownloadDelay = 0;
+  answer.nextRepIndex = 0;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+
+  int64_t bufferNow = 0;
+  if (segmentCounter != 0) {
+    bufferNow = std::max<int64_t>(
+        0, m_bufferData.bufferLevelNew.back() -
+               (timeNow - m_throughput.transmissionEnd.back()));
+  }
+
+  if (segmentCounter == 0 || bandwidth <= 0) {
+    // nothing to predict from yet
+    answer.nextRepIndex = 0;
+    answer.decisionCase = 0;
+  } else if (m_fast) {
+    const int64_t viewpoint = m_videoData.userInfo.at(segmentCounter);
+    const BitrateLadder &ladder = m_videoData.ladders.at(viewpoint);
+    answer.nextRepIndex = CapRepIndex(
+        m_table.Lookup(bufferNow, bandwidth, m_lastRepIndex), viewpoint);
+    answer.decisionCase = 2;
+    // the table plans with segments of the average size: step down while the
+    // next Horizon segments, all as large as the largest of them, would
+    // drain the buffer before the last one arrives
+    const int64_t count = std::min<int64_t>(
+        m_parameters.horizon, ladder.GetSegmentCount() - segmentCounter);
+    while (answer.nextRepIndex > 0 &&
+           count * 8000000.0 *
+                   ladder.GetMaxSize(answer.nextRepIndex, segmentCounter,
+                                     count) /
+                   bandwidth >
+               bufferNow + (count - 1) * m_videoData.segmentDuration) {
+      answer.nextRepIndex--;
+      answer.decisionCase = 4;
+    }
+  } else {
+    const int64_t viewpoint = m_videoData.userInfo.at(segmentCounter);
+    const BitrateLadder &ladder = m_videoData.ladders.at(viewpoint);
+    std::vector<std::vector<int64_t>> sizes;
+    for (int64_t k = segmentCounter;
+         k < ladder.GetSegmentCount() &&
+         k < segmentCounter + m_parameters.horizon;
+         k++) {
+      std::vector<int64_t> step;
+      for (int64_t rep = 0; rep <= m_highestRepIndex; rep++) {
+        step.push_back(ladder.GetSize(rep, k));
+      }
+      sizes.push_back(step);
+    }
+    answer.nextRepIndex =
+        Solve(sizes, ladder.GetBitrates(), m_videoData.segmentDuration,
+              bufferNow, bandwidth, m_lastRepIndex, m_parameters);
+    answer.decisionCase = 1;
+    if (CapRepIndex(answer.nextRepIndex, viewpoint) < answer.nextRepIndex) {
+      // plan again without the representations above the cap
+      for (uint32_t k = 0; k < sizes.size(); k++) {
+        sizes[k].resize(GetMaxRepIndex(viewpoint) + 1);
+      }
+      answer.nextRepIndex =
+          Solve(sizes, ladder.GetBitrates(), m_videoData.segmentDuration,
+                bufferNow, bandwidth, m_lastRepIndex, m_parameters);
+      answer.decisionCase = 3;
+    }
+  }
+
+  // wait until the next segment fits below the upper bound
+  if (bufferNow + m_videoData.segmentDuration > m_bufferUpperbound) {
+    answer.nextDownloadDelay =
+        bufferNow + m_videoData.segmentDuration - m_bufferUpperbound;
+    answer.delayDecisionCase = 1;
+  }
+
+  answer.estimateTh = bandwidth;
+  m_lastRepIndex = answer.nextRepIndex;
+  return answer;
+}
+
+} // namespace ns3
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPC_ALGORITHM_H
+#define MPC_ALGORITHM_H
+
+#include "tcp-stream-adaptation.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief The QoE objective MPC maximises over its horizon.
+ *
+ * The QoE of a plan is the sum of the bitrates of its segments, relative to
+ * the highest representation, minus rebufferPenalty times the stall time in
+ * seconds, minus smoothPenalty times the relative bitrate changes.
+ */
+struct mpcParameters {
+  uint32_t horizon;         //!< number of future segments planned for
+  double rebufferPenalty;   //!< penalty per second of stall
+  double smoothPenalty;     //!< penalty per relative bitrate change
+  int64_t bufferUpperbound; //!< buffer level in microseconds the client
+                            //!< never exceeds, it waits instead
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief The FastMPC decision table.
+ *
+ * The MPC problem solved offline for a quantised (buffer level, throughput,
+ * last representation) grid, assuming every segment has the average size of
+ * its representation. Buffer levels are quantised linearly from 0 to the
+ * buffer upper bound, throughputs logarithmically between a minimum and a
+ * maximum. A lookup takes the bins below the actual values, so the decision
+ * is never more aggressive than the one of the exact problem on the grid.
+ *
+ * Tables are generated by scratch/fastmpc-table and saved as text.
+ */
+class FastMpcTable {
+public:
+  FastMpcTable();
+
+  /**
+   * \brief Solve the MPC problem for every point of the grid.
+   * \param bitrates average bitrate of every representation in bps
+   * \param segmentDuration duration of a segment in microseconds
+   */
+  void Generate(const std::vector<double> &bitrates, int64_t segmentDuration,
+                const mpcParameters &parameters, uint32_t bufferBins,
+                uint32_t throughputBins, double throughputMin,
+                double throughputMax);
+
+  /**
+   * \brief Write the table to os.
+   */
+  void Save(std::ostream &os) const;
+
+  /**
+   * \brief Read a table written by Save.
+   * \return false if is does not contain a complete table
+   */
+  bool Load(std::istream &is);
+
+  /**
+   * \return the representation index of the next segment
+   * \param buffer the buffer level in microseconds
+   * \param throughput the estimated throughput in bps
+   * \param lastRepIndex the representation of the previous segment
+   */
+  int64_t Lookup(int64_t buffer, double throughput,
+                 int64_t lastRepIndex) const;
+
+  const std::vector<double> &GetBitrates(void) const;
+  int64_t GetSegmentDuration(void) const;
+
+private:
+  std::vector<double> m_bitrates; //!< the ladder the table was solved for
+  int64_t m_segmentDuration;      //!< segment duration in microseconds
+  mpcParameters m_parameters;     //!< the objective the table was solved for
+  uint32_t m_bufferBins;          //!< number of buffer levels
+  uint32_t m_throughputBins;      //!< number of throughputs
+  double m_throughputMin;         //!< lowest throughput in bps
+  double m_throughputMax;         //!< highest throughput in bps
+  std::vector<uint8_t>
+      m_decisions; //!< [lastRep][bufferBin][throughputBin] -> next rep
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Model predictive control adaptation.
+ *
+ * Plans the representations of the next Horizon segments so that the QoE
+ * objective of mpcParameters is maximal, predicting the buffer level from the
+ * actual segment sizes and the estimated throughput, and requests the first
+ * segment of the best plan. With a DecisionTable the plan is looked up in a
+ * FastMpcTable loaded at start instead (FastMPC). The table only knows the
+ * average bitrates, so its decision is lowered until the next Horizon
+ * segments, each as large as the largest of them, keep the buffer from
+ * running dry.
+ */
+class MpcAlgorithm : public AdaptationAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  MpcAlgorithm(const videoData &videoData, const playbackData &playbackData,
+               const bufferData &bufferData, const throughputData &throughput);
+
+  algorithmReply GetNextRep(const int64_t segmentCounter,
+                            const int64_t clientId, int64_t bandwidth);
+
+  /**
+   * \brief Solve the MPC problem exhaustively.
+   * \param sizes sizes[k][r] is the size in bytes of the k-th future segment
+   * in representation r, the plan covers sizes.size() segments and never
+   * uses the representations sizes[k] leaves out at the top
+   * \param bitrates bitrate of every representation in bps
+   * \param segmentDuration duration of a segment in microseconds
+   * \param buffer the buffer level in microseconds
+   * \param throughput the estimated throughput in bps
+   * \param lastRepIndex the representation of the previous segment
+   * \return the representation of the first segment of the best plan
+   */
+  static int64_t Solve(const std::vector<std::vector<int64_t>> &sizes,
+                       const std::vector<double> &bitrates,
+                       int64_t segmentDuration, int64_t buffer,
+                       double throughput, int64_t lastRepIndex,
+                       const mpcParameters &parameters);
+
+protected:
+  /**
+   * \brief Load the DecisionTable, if any.
+   */
+  virtual void DoInitialize(void);
+
+private:
+  uint32_t m_horizon;         //!< Horizon attribute
+  double m_rebufferPenalty;   //!< RebufferPenalty attribute
+  double m_smoothPenalty;     //!< SmoothPenalty attribute
+  int64_t m_bufferUpperbound; //!< BufferUpperbound attribute
+  mpcParameters m_parameters; //!< the above, as passed to Solve
+  std::string m_tableFile;    //!< FastMPC table, empty to solve online
+  bool m_fast;                //!< true if m_table is used
+  FastMpcTable m_table;       //!< the FastMPC table
+  int64_t m_lastRepIndex;
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* MPC_ALGORITHM_H */
@@ -0,0 +1,355 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adapation-neural.h"
+#include "ns3/integer.h"
+#include "ns3/string.h"
+#include <cstring>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("NeuralAdaptationAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(NeuralAdaptationAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, NeuralAdaptationAlgorithm);
+
+namespace {
+const char g_mlpMagic[8] = {'A', 'B', 'R', 'M', 'L', 'P', '0', '1'};
+
+// dot product of two vectors of n floats, n a multiple of 8
+float Dot(const float *a, const float *b, uint32_t n) {
+#if defined(__AVX__)
+  __m256 sum = _mm256_setzero_ps();
+  for (uint32_t i = 0; i < n; i += 8) {
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum),
+                           _mm256_extractf128_ps(sum, 1));
+#elif defined(__SSE2__)
+  __m128 low = _mm_setzero_ps();
+  __m128 high = _mm_setzero_ps();
+  for (uint32_t i = 0; i < n; i += 8) {
+    low = _mm_add_ps(low,
+                     _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    high = _mm_add_ps(
+        high, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  __m128 half = _mm_add_ps(low, high);
+#endif
+#if defined(__AVX__) || defined(__SSE2__)
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  return _mm_cvtss_f32(half);
+#elif defined(__ARM_NEON)
+  float32x4_t low = vdupq_n_f32(0);
+  float32x4_t high = vdupq_n_f32(0);
+  for (uint32_t i = 0; i < n; i += 8) {
+    low = vmlaq_f32(low, vld1q_f32(a + i), vld1q_f32(b + i));
+    high = vmlaq_f32(high, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  float32x4_t sum = vaddq_f32(low, high);
+  float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+  float sum = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+#endif
+}
+
+uint32_t Pad(uint32_t n) { return (n + 7) / 8 * 8; }
+
+template <typename T> void Write(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> bool Read(std::istream &is, T &value) {
+  return (bool)is.read(reinterpret_cast<char *>(&value), sizeof(value));
+}
+} // namespace
+
+MlpPolicy::MlpPolicy()
+    : m_history(0), m_representations(0), m_viewpoints(0) {}
+
+void MlpPolicy::SetLayout(uint32_t history, uint32_t representations,
+                          uint32_t viewpoints) {
+  m_history = history;
+  m_representations = representations;
+  m_viewpoints = viewpoints;
+  m_layers.clear();
+}
+
+bool MlpPolicy::AddLayer(uint32_t inputs, uint32_t outputs, activation act,
+                         const std::vector<float> &weights,
+                         const std::vector<float> &biases) {
+  uint32_t expected =
+      m_layers.empty() ? GetInputSize() : m_layers.back().outputs;
+  if (inputs != expected || outputs == 0 ||
+      weights.size() != (size_t)inputs * outputs ||
+      biases.size() != outputs || act > TANH) {
+    return false;
+  }
+  mlpLayer layer;
+  layer.inputs = inputs;
+  layer.outputs = outputs;
+  layer.stride = Pad(inputs);
+  layer.act = act;
+  layer.weights.assign((size_t)outputs * layer.stride, 0.0f);
+  for (uint32_t row = 0; row < outputs; row++) {
+    std::copy(weights.begin() + (size_t)row * inputs,
+              weights.begin() + (size_t)(row + 1) * inputs,
+              layer.weights.begin() + (size_t)row * layer.stride);
+  }
+  layer.biases = biases;
+  m_layers.push_back(layer);
+
+  // the padding of the activations stays 0, so it adds nothing to the dot
+  // products
+  uint32_t width = 0;
+  for (uint32_t i = 0; i < m_layers.size(); i++) {
+    width = std::max(width, std::max(m_layers[i].stride,
+                                     Pad(m_layers[i].outputs)));
+  }
+  m_activations[0].assign(width, 0.0f);
+  m_activations[1].assign(width, 0.0f);
+  return true;
+}
+
+void MlpPolicy::Save(std::ostream &os) const {
+  os.write(g_mlpMagic, sizeof(g_mlpMagic));
+  Write<uint32_t>(os, m_history);
+  Write<uint32_t>(os, m_representations);
+  Write<uint32_t>(os, m_viewpoints);
+  Write<uint32_t>(os, m_layers.size());
+  for (uint32_t i = 0; i < m_layers.size(); i++) {
+    const mlpLayer &layer = m_layers[i];
+    Write<uint32_t>(os, layer.inputs);
+    Write<uint32_t>(os, layer.outputs);
+    Write<uint32_t>(os, layer.act);
+    for (uint32_t row = 0; row < layer.outputs; row++) {
+      os.write(reinterpret_cast<const char *>(&layer.weights[(size_t)row *
+                                                             layer.stride]),
+               layer.inputs * sizeof(float));
+    }
+    os.write(reinterpret_cast<const char *>(&layer.biases[0]),
+             layer.outputs * sizeof(float));
+  }
+}
+
+bool MlpPolicy::Load(std::istream &is) {
+  char magic[sizeof(g_mlpMagic)];
+  if (!is.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, g_mlpMagic, sizeof(magic)) != 0) {
+    return false;
+  }
+  uint32_t history, representations, viewpoints, layers;
+  if (!Read(is, history) || !Read(is, representations) ||
+      !Read(is, viewpoints) || !Read(is, layers) || layers == 0) {
+    return false;
+  }
+  SetLayout(history, representations, viewpoints);
+  for (uint32_t i = 0; i < layers; i++) {
+    uint32_t inputs, outputs, act;
+    if (!Read(is, inputs) || !Read(is, outputs) || !Read(is, act) ||
+        inputs > (1 << 16) || outputs > (1 << 16)) {
+      return false;
+    }
+    std::vector<float> weights((size_t)inputs * outputs);
+    std::vector<float> biases(outputs);
+    if (!is.read(reinterpret_cast<char *>(weights.data()),
+                 weights.size() * sizeof(float)) ||
+        !is.read(reinterpret_cast<char *>(biases.data()),
+                 biases.size() * sizeof(float)) ||
+        !AddLayer(inputs, outputs, (activation)act, weights, biases)) {
+      return false;
+    }
+  }
+  return IsComplete();
+}
+
+bool MlpPolicy::IsComplete(void) const {
+  return !m_layers.empty() && m_layers.back().outputs == m_representations;
+}
+
+const float *MlpPolicy::Evaluate(const float *input) {
+  float *x = &m_activations[0][0];
+  float *y = &m_activations[1][0];
+  std::copy(input, input + GetInputSize(), x);
+  for (uint32_t i = 0; i < m_layers.size(); i++) {
+    const mlpLayer &layer = m_layers[i];
+    const float *row = &layer.weights[0];
+    for (uint32_t out = 0; out < layer.outputs; out++) {
+      float value = Dot(row, x, layer.stride) + layer.biases[out];
+      if (layer.act == RELU) {
+        value = std::max(value, 0.0f);
+      } else if (layer.act == TANH) {
+        value = std::tanh(value);
+      }
+      y[out] = value;
+      row += layer.stride;
+    }
+    // clear what the previous layer left beyond the outputs of this one
+    std::fill(y + layer.outputs, y + Pad(layer.outputs), 0.0f);
+    std::swap(x, y);
+  }
+  return x;
+}
+
+uint32_t MlpPolicy::GetInputSize(void) const {
+  return 2 + m_history + m_representations + m_viewpoints;
+}
+
+uint32_t MlpPolicy::GetHistory(void) const { return m_history; }
+
+uint32_t MlpPolicy::GetRepresentations(void) const {
+  return m_representations;
+}
+
+uint32_t MlpPolicy::GetViewpoints(void) const { return m_viewpoints; }
+
+TypeId NeuralAdaptationAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::NeuralAdaptationAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "WeightFile",
+              "Policy network written by scratch/neural-export",
+              StringValue(""),
+              MakeStringAccessor(&NeuralAdaptationAlgorithm::m_weightFile),
+              MakeStringChecker())
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds",
+              IntegerValue(40000000),
+              MakeIntegerAccessor(
+                  &NeuralAdaptationAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
+
+NeuralAdaptationAlgorithm::NeuralAdaptationAlgorithm(
+    const videoData &videoData, const playbackData &playbackData,
+    const bufferData &bufferData, const throughputData &throughput)
+    : AdaptationAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_bufferUpperbound(40000000), m_lastRepIndex(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void NeuralAdaptationAlgorithm::DoInitialize(void) {
+  std::ifstream file(m_weightFile.c_str(), std::ios::binary);
+  if (!file || !m_policy.Load(file)) {
+    NS_FATAL_ERROR("Could not read the policy network " << m_weightFile);
+  }
+  if ((int64_t)m_policy.GetRepresentations() != m_highestRepIndex + 1) {
+    NS_FATAL_ERROR("The policy network "
+                   << m_weightFile << " was trained for "
+                   << m_policy.GetRepresentations()
+                   << " representations, the video has "
+                   << m_highestRepIndex + 1);
+  }
+  if (m_policy.GetViewpoints() != 0 &&
+      m_policy.GetViewpoints() != m_videoData.ladders.size()) {
+    NS_FATAL_ERROR("The policy network "
+                   << m_weightFile << " was trained for "
+                   << m_policy.GetViewpoints()
+                   << " viewpoints, the video has "
+                   << m_videoData.ladders.size());
+  }
+  m_features.assign(m_policy.GetInputSize(), 0.0f);
+  AdaptationAlgorithm::DoInitialize();
+}
+
+algorithmReply NeuralAdaptationAlgorithm::GetNextRep(
+    const int64_t segmentCounter, const int64_t clientId, int64_t bandwidth) {
+  algorithmReply answer;
+  answer.decisionCase = 0;
+  answer.delayDecisionCase = 0;
+  answer.nextDownloadDelay = 0;
+  answer.nextRepIndex = 0;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+  answer.estimateTh = bandwidth;
+
+  int64_t bufferNow = 0;
+  if (segmentCounter != 0) {
+    bufferNow = std::max<int64_t>(
+        0, m_bufferData.bufferLevelNew.back() -
+               (timeNow - m_throughput.transmissionEnd.back()));
+
+    const int64_t viewpoint = m_videoData.userInfo.at(segmentCounter);
+    const BitrateLadder &ladder = m_videoData.ladders.at(viewpoint);
+    float *feature = &m_features[0];
+    *feature++ = bufferNow / 1000000.0f;
+    *feature++ =
+        m_highestRepIndex > 0 ? (float)m_lastRepIndex / m_highestRepIndex : 0;
+    const int64_t downloaded = m_throughput.bytesReceived.size();
+    for (int64_t k = 1; k <= (int64_t)m_policy.GetHistory(); k++) {
+      float throughput = 0;
+      if (k <= downloaded) {
+        int64_t time = m_throughput.transmissionEnd[downloaded - k] -
+                       m_throughput.transmissionStart[downloaded - k];
+        if (time > 0) {
+          throughput = 8.0f * m_throughput.bytesReceived[downloaded - k] /
+                       time; // bit per microsecond = Mbit/s
+        }
+      }
+      *feature++ = throughput;
+    }
+    for (int64_t rep = 0; rep <= m_highestRepIndex; rep++) {
+      *feature++ = 8.0f * ladder.GetSize(rep, segmentCounter) / 1000000.0f;
+    }
+    for (uint32_t v = 0; v < m_policy.GetViewpoints(); v++) {
+      *feature++ = v == viewpoint ? 1.0f : 0.0f;
+    }
+
+    const float *scores = m_policy.Evaluate(&m_features[0]);
+    answer.nextRepIndex =
+        std::max_element(scores, scores + m_highestRepIndex + 1) - scores;
+    answer.decisionCase = 1;
+    if (CapRepIndex(answer.nextRepIndex, viewpoint) < answer.nextRepIndex) {
+      // the best representation within the cap
+      answer.nextRepIndex =
+          std::max_element(scores, scores + GetMaxRepIndex(viewpoint) + 1) -
+          scores;
+      answer.decisionCase = 2;
+    }
+  }
+
+  // wait until the next segment fits below the upper bound
+  if (bufferNow + m_videoData.segmentDuration > m_bufferUpperbound) {
+    answer.nextDownloadDelay =
+        bufferNow + m_videoData.segmentDuration - m_bufferUpperbound;
+    answer.delayDecisionCase = 1;
+  }
+
+  m_lastRepIndex = answer.nextRepIndex;
+  return answer;
+}
+
+} // namespace ns3
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEURAL_ALGORITHM_H
+#define NEURAL_ALGORITHM_H
+
+#include "tcp-stream-adaptation.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief A small feed-forward network, evaluated with SIMD kernels.
+ *
+ * Every layer computes act(W x + b). The rows of W are padded to a multiple
+ * of eight floats, so the dot products run over whole AVX or SSE registers
+ * (NEON on ARM, plain loops elsewhere) without a remainder loop, and the
+ * activations are kept in two preallocated buffers: an evaluation neither
+ * allocates nor branches on the shape. A policy of a few thousand weights
+ * is evaluated in a few microseconds.
+ *
+ * The binary file format, in the byte order of the host:
+ * - the eight characters "ABRMLP01";
+ * - uint32 history, representations, viewpoints and number of layers, the
+ *   feature layout of NeuralAdaptationAlgorithm;
+ * - per layer uint32 inputs, outputs and activation (0 linear, 1 relu,
+ *   2 tanh), then float32 weights, outputs rows of inputs, and float32
+ *   biases.
+ *
+ * Files are written by scratch/neural-export from the text dump of a
+ * training run.
+ */
+class MlpPolicy {
+public:
+  /**
+   * \brief The activation functions of a layer.
+   */
+  enum activation {
+    LINEAR = 0, //!< identity
+    RELU = 1,   //!< max(0, x)
+    TANH = 2    //!< tanh(x)
+  };
+
+  MlpPolicy();
+
+  /**
+   * \brief Set the feature layout the network was trained for.
+   */
+  void SetLayout(uint32_t history, uint32_t representations,
+                 uint32_t viewpoints);
+
+  /**
+   * \brief Append a layer.
+   * \param weights outputs rows of inputs weights
+   * \return false if inputs does not match the outputs of the previous
+   * layer, or the feature count for the first layer
+   */
+  bool AddLayer(uint32_t inputs, uint32_t outputs, activation act,
+                const std::vector<float> &weights,
+                const std::vector<float> &biases);
+
+  /**
+   * \brief Write the network in the binary format to os.
+   */
+  void Save(std::ostream &os) const;
+
+  /**
+   * \brief Read a network written by Save.
+   * \return false if is does not contain a complete, consistent network
+   */
+  bool Load(std::istream &is);
+
+  /**
+   * \return true if the last layer has one output per representation
+   */
+  bool IsComplete(void) const;
+
+  /**
+   * \brief Evaluate the network.
+   * \param input GetInputSize() features
+   * \return the GetRepresentations() outputs, valid until the next call
+   */
+  const float *Evaluate(const float *input);
+
+  uint32_t GetInputSize(void) const;
+  uint32_t GetHistory(void) const;
+  uint32_t GetRepresentations(void) const;
+  uint32_t GetViewpoints(void) const;
+
+private:
+  /**
+   * \brief A layer, its weight rows padded to stride floats.
+   */
+  struct mlpLayer {
+    uint32_t inputs;
+    uint32_t outputs;
+    uint32_t stride; //!< inputs rounded up to a multiple of 8
+    activation act;
+    std::vector<float> weights; //!< outputs rows of stride floats
+    std::vector<float> biases;
+  };
+
+  uint32_t m_history;         //!< number of past throughputs
+  uint32_t m_representations; //!< number of representations
+  uint32_t m_viewpoints;      //!< number of viewpoints, 0 for none
+  std::vector<mlpLayer> m_layers;
+  std::vector<float> m_activations[2]; //!< inputs and outputs of a layer
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Adaptation by a learned policy network.
+ *
+ * Evaluates the MlpPolicy of WeightFile per decision and requests the
+ * representation with the highest output. The features are, in this order:
+ * - the buffer level in seconds;
+ * - the representation of the previous segment over the highest one;
+ * - the throughput of the last history segments in Mbit/s, the latest
+ *   first, 0 for segments not downloaded yet;
+ * - the size of the next segment in Mbit in every representation;
+ * - one-hot the viewpoint of the next segment, if the network was trained
+ *   with viewpoints.
+ * The first segment is requested in the lowest representation. Like the
+ * other buffer-based algorithms, the client waits while the buffer is above
+ * BufferUpperbound.
+ */
+class NeuralAdaptationAlgorithm : public AdaptationAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  NeuralAdaptationAlgorithm(const videoData &videoData,
+                            const playbackData &playbackData,
+                            const bufferData &bufferData,
+                            const throughputData &throughput);
+
+  algorithmReply GetNextRep(const int64_t segmentCounter,
+                            const int64_t clientId, int64_t bandwidth);
+
+protected:
+  /**
+   * \brief Load the WeightFile.
+   */
+  virtual void DoInitialize(void);
+
+private:
+  std::string m_weightFile;
+  int64_t m_bufferUpperbound;
+  MlpPolicy m_policy;
+  std::vector<float> m_features; //!< reused for every decision
+  int64_t m_lastRepIndex;
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* NEURAL_ALGORITHM_H */
@@ -1,9 +1,45 @@
 #include "adapation-sara.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("SaraAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(SaraAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, SaraAlgorithm);
+
+TypeId SaraAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::SaraAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("BufferHigh",
+                        "Buffer level in microseconds above which the next "
+                        "download is delayed, 0 for 10 segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&SaraAlgorithm::m_bufferHigh),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("BufferLow",
+                        "Buffer level in microseconds below which the "
+                        "representation is raised by one step at most, 0 "
+                        "for 8 segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&SaraAlgorithm::m_bufferLow),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("BufferMin",
+                        "Buffer level in microseconds below which the lowest "
+                        "representation is chosen, 0 for 6 segments",
+                        IntegerValue(0),
+                        MakeIntegerAccessor(&SaraAlgorithm::m_bufferMin),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds, 0 for "
+              "15 segments",
+              IntegerValue(0),
+              MakeIntegerAccessor(&SaraAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(0));
+  return tid;
+}
 
 SaraAlgorithm::SaraAlgorithm(const videoData &videoData,
                              const playbackData &playbackData,
@@ -15,12 +51,28 @@ SaraAlgorithm::SaraAlgorithm(const videoData &videoData,
       m_bufferLow(m_videoData.segmentDuration * 8),    // 4s
       m_bufferMin(m_videoData.segmentDuration * 6),    // 2s
       m_bufferUpperbound(m_videoData.segmentDuration * 15),  // 15s
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
 }
 
+void SaraAlgorithm::DoInitialize(void) {
+  if (m_bufferHigh == 0) {
+    m_bufferHigh = m_videoData.segmentDuration * 10;
+  }
+  if (m_bufferLow == 0) {
+    m_bufferLow = m_videoData.segmentDuration * 8;
+  }
+  if (m_bufferMin == 0) {
+    m_bufferMin = m_videoData.segmentDuration * 6;
+  }
+  if (m_bufferUpperbound == 0) {
+    m_bufferUpperbound = m_videoData.segmentDuration * 15;
+  }
+  AdaptationAlgorithm::DoInitialize();
+}
+
 algorithmReply SaraAlgorithm::GetNextRep(const int64_t segmentCounter,
                                          const int64_t clientId,
                                          int64_t bandwidth) {
@@ -28,7 +80,7 @@ algorithmReply SaraAlgorithm::GetNextRep(const int64_t segmentCounter,
   answer.decisionCase = 0;
   answer.delayDecisionCase = 0;
   answer.nextDownloadDelay = 0;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
   int64_t bufferNow = 0;
   if (segmentCounter != 0) {
@@ -38,32 +90,21 @@ algorithmReply SaraAlgorithm::GetNextRep(const int64_t segmentCounter,
       answer.nextRepIndex = 0;
       answer.decisionCase = 1;
     } else {
-      if ((double)(8.0 * m_videoData.segmentSize
-                             .at(m_videoData.userInfo.at(segmentCounter))
-                             .at(m_lastRepIndex)
-                             .at(segmentCounter)) /
-              bandwidth >
-          (bufferNow - m_bufferMin) / 1000000.0) {
-        int nextRepIndex;
-        for (nextRepIndex = 0; nextRepIndex < m_lastRepIndex; nextRepIndex++) {
-          if ((double)(8.0 * m_videoData.segmentSize
-                                 .at(m_videoData.userInfo.at(segmentCounter))
-                                 .at(nextRepIndex)
-                                 .at(segmentCounter)) /
-                  bandwidth >
-              (bufferNow - m_bufferMin) / 1000000.0)
-            break;
-        }
-        answer.nextRepIndex = nextRepIndex > 0 ? nextRepIndex - 1 : 0;
+      const BitrateLadder &ladder =
+          m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter));
+      // bytes that arrive before the buffer drains to BufferMin
+      const double bytesToMin =
+          bandwidth * (bufferNow - m_bufferMin) / 8000000.0;
+      if (ladder.GetSize(m_lastRepIndex, segmentCounter) > bytesToMin) {
+        answer.nextRepIndex = std::max<int64_t>(
+            ladder.GetLastRepFitting(segmentCounter, 1, bytesToMin, 0,
+                                     m_lastRepIndex - 1),
+            0);
         answer.decisionCase = 3;
       } else if (bufferNow <= m_bufferLow) {
         if (m_lastRepIndex < m_highestRepIndex &&
-            (double)(8.0 * m_videoData.segmentSize
-                               .at(m_videoData.userInfo.at(segmentCounter))
-                               .at(m_lastRepIndex + 1)
-                               .at(segmentCounter)) /
-                    bandwidth <=
-                (bufferNow - m_bufferMin) / 1000000.0) {
+            ladder.GetSize(m_lastRepIndex + 1, segmentCounter) <=
+                bytesToMin) {
           answer.nextRepIndex = m_lastRepIndex + 1;
           answer.decisionCase = 4;
         } else {
@@ -71,32 +112,16 @@ algorithmReply SaraAlgorithm::GetNextRep(const int64_t segmentCounter,
           answer.decisionCase = 5;
         }
       } else if (bufferNow <= m_bufferHigh) {
-        int nextRepIndex;
-        for (nextRepIndex = m_highestRepIndex; nextRepIndex >= m_lastRepIndex;
-             nextRepIndex--) {
-          if ((double)(8.0 * m_videoData.segmentSize
-                                 .at(m_videoData.userInfo.at(segmentCounter))
-                                 .at(nextRepIndex)
-                                 .at(segmentCounter)) /
-                  bandwidth <=
-              (bufferNow - m_bufferMin) / 1000000.0)
-            break;
-        }
-        answer.nextRepIndex = nextRepIndex;
+        answer.nextRepIndex = ladder.GetHighestRepFitting(
+            segmentCounter, 1, bytesToMin, m_lastRepIndex, m_highestRepIndex);
         answer.decisionCase = 6;
       } else if (bufferNow > m_bufferHigh) {
-        int nextRepIndex;
-        for (nextRepIndex = m_highestRepIndex; nextRepIndex >= m_lastRepIndex;
-             nextRepIndex--) {
-          if ((double)(8.0 * m_videoData.segmentSize
-                                 .at(m_videoData.userInfo.at(segmentCounter))
-                                 .at(nextRepIndex)
-                                 .at(segmentCounter)) /
-                  bandwidth <=
-              (bufferNow - m_bufferLow) / 1000000.0)
-            break;
-        }
-        answer.nextRepIndex = nextRepIndex;
+        const double bytesToLow =
+            bandwidth * (bufferNow - m_bufferLow) / 8000000.0;
+        answer.nextRepIndex = std::max<int64_t>(
+            ladder.GetHighestRepFitting(segmentCounter, 1, bytesToLow,
+                                        m_lastRepIndex, m_highestRepIndex),
+            0);
         answer.decisionCase = 6;
       } else {
         answer.nextRepIndex = m_lastRepIndex;
@@ -121,6 +146,8 @@ algorithmReply SaraAlgorithm::GetNextRep(const int64_t segmentCounter,
   //
 
   answer.estimateTh = bandwidth;
+  answer.nextRepIndex = CapRepIndex(answer.nextRepIndex,
+                                    m_videoData.userInfo.at(segmentCounter));
   m_lastRepIndex = answer.nextRepIndex;
 
   return answer;
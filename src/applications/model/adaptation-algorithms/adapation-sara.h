@@ -7,18 +7,31 @@ namespace ns3 {
 // do not use this algo
 class SaraAlgorithm : public AdaptationAlgorithm {
  public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   SaraAlgorithm(const videoData &videoData, const playbackData &playbackData,
                 const bufferData &bufferData, const throughputData &throughput);
 
   algorithmReply GetNextRep(const int64_t segmentCounter,
                             const int64_t clientId, int64_t bandwidth);
 
+ protected:
+  /**
+   * \brief Resolve the buffer levels left at 0 to their default number of
+   * segments.
+   */
+  virtual void DoInitialize(void);
+
  private:
   int64_t m_lastRepIndex;
   int64_t m_bufferHigh;
   int64_t m_bufferLow;
   int64_t m_bufferMin;
-  const int64_t m_bufferUpperbound;
+  int64_t m_bufferUpperbound;
   const int64_t m_highestRepIndex;
 };
 
@@ -17,11 +17,81 @@
  */
 
 #include "adapation-tobasco.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("TobascoAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(TobascoAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, TobascoAlgorithm);
+
+TypeId TobascoAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::TobascoAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("A1",
+                        "Share of the estimated bandwidth the current "
+                        "representation may use to keep up the fast start",
+                        DoubleValue(0.85),
+                        MakeDoubleAccessor(&TobascoAlgorithm::m_a1),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("A2",
+                        "Share of the estimated bandwidth for switching up "
+                        "in fast start below BufferMin",
+                        DoubleValue(0.33),
+                        MakeDoubleAccessor(&TobascoAlgorithm::m_a2),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("A3",
+                        "Share of the estimated bandwidth for switching up "
+                        "in fast start below BufferLow",
+                        DoubleValue(0.50),
+                        MakeDoubleAccessor(&TobascoAlgorithm::m_a3),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("A4",
+                        "Share of the estimated bandwidth for switching up "
+                        "in fast start above BufferLow",
+                        DoubleValue(0.75),
+                        MakeDoubleAccessor(&TobascoAlgorithm::m_a4),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("A5",
+                        "Share of the estimated bandwidth the next higher "
+                        "representation may use after the fast start",
+                        DoubleValue(0.90),
+                        MakeDoubleAccessor(&TobascoAlgorithm::m_a5),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("BufferMin",
+                        "Buffer level in microseconds below which the lowest "
+                        "representation is chosen",
+                        IntegerValue(10000000),
+                        MakeIntegerAccessor(&TobascoAlgorithm::m_bMin),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("BufferLow",
+                        "Buffer level in microseconds below which the "
+                        "representation is lowered",
+                        IntegerValue(15000000),
+                        MakeIntegerAccessor(&TobascoAlgorithm::m_bLow),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("BufferHigh",
+                        "Buffer level in microseconds above which the next "
+                        "download is delayed",
+                        IntegerValue(25000000),
+                        MakeIntegerAccessor(&TobascoAlgorithm::m_bHigh),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute("BufferOptimal",
+                        "Buffer level in microseconds the delays aim for",
+                        IntegerValue(20000000),
+                        MakeIntegerAccessor(&TobascoAlgorithm::m_bOpt),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds",
+              IntegerValue(40000000),
+              MakeIntegerAccessor(&TobascoAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(0));
+  return tid;
+}
 
 TobascoAlgorithm::TobascoAlgorithm(const videoData &videoData,
                                    const playbackData &playbackData,
@@ -45,7 +115,7 @@ TobascoAlgorithm::TobascoAlgorithm(const videoData &videoData,
       m_lastRepIndex(0),
       m_lastBuffer(0),
       m_runningFastStart(true),
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
@@ -58,28 +128,25 @@ algorithmReply TobascoAlgorithm::GetNextRep(const int64_t segmentCounter,
   int64_t delayDecision = 0;
   int64_t nextRepIndex = 0;
   int64_t expectBuffer = 0;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   int64_t bufferNow = 0;
   if (segmentCounter != 0) {
     nextRepIndex = m_lastRepIndex;
     bufferNow = m_bufferData.bufferLevelNew.back() -
                 (timeNow - m_throughput.transmissionEnd.back());
 
+    const BitrateLadder &ladder =
+        m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter));
     int64_t nextHighestRepBitrate;
     if (m_lastRepIndex != m_highestRepIndex)
-      nextHighestRepBitrate =
-          m_videoData.averageBitrate.at(m_videoData.userInfo.at(segmentCounter))
-              .at(m_lastRepIndex + 1);
+      nextHighestRepBitrate = ladder.GetBitrate(m_lastRepIndex + 1);
     else
-      nextHighestRepBitrate =
-          m_videoData.averageBitrate.at(m_videoData.userInfo.at(segmentCounter))
-              .at(m_lastRepIndex);
+      nextHighestRepBitrate = ladder.GetBitrate(m_lastRepIndex);
 
-    bool isValid = segmentCounter >= 3
-                       ? (m_videoData.averageBitrate
-                              .at(m_videoData.userInfo.at(segmentCounter))
-                              .at(m_lastRepIndex) <= m_a1 * bandwidth)
-                       : true;
+    bool isValid =
+        segmentCounter >= 3
+            ? (ladder.GetBitrate(m_lastRepIndex) <= m_a1 * bandwidth)
+            : true;
     if (m_runningFastStart && m_lastRepIndex != m_highestRepIndex &&
         bufferNow >= m_lastBuffer && isValid) {
       if (bufferNow < m_bMin) {
@@ -111,17 +178,13 @@ algorithmReply TobascoAlgorithm::GetNextRep(const int64_t segmentCounter,
       } else if (bufferNow < m_bLow) {
         int64_t lastSegmentThroughput =
             8 *
-            (m_videoData.segmentSize
-                 .at(m_videoData.userInfo.at(segmentCounter - 1))
-                 .at(m_lastRepIndex)
-                 .at(segmentCounter - 1)) *
+            m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter - 1))
+                .GetSize(m_lastRepIndex, segmentCounter - 1) *
             1000000 /
             (m_throughput.transmissionEnd.at(segmentCounter - 1) -
              m_throughput.transmissionStart.at(segmentCounter - 1));
         if ((m_lastRepIndex != 0) &&
-            (m_videoData.averageBitrate
-                 .at(m_videoData.userInfo.at(segmentCounter))
-                 .at(m_lastRepIndex) >= lastSegmentThroughput)) {
+            (ladder.GetBitrate(m_lastRepIndex) >= lastSegmentThroughput)) {
           decisionCase = 6;
           nextRepIndex = m_lastRepIndex - 1;
         }
@@ -148,6 +211,9 @@ algorithmReply TobascoAlgorithm::GetNextRep(const int64_t segmentCounter,
     }
   }
 
+  nextRepIndex =
+      CapRepIndex(nextRepIndex, m_videoData.userInfo.at(segmentCounter));
+
   algorithmReply answer;
   answer.nextRepIndex = nextRepIndex;
   answer.decisionTime = timeNow;
@@ -28,6 +28,12 @@ namespace ns3 {
  */
 class TobascoAlgorithm : public AdaptationAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   TobascoAlgorithm(const videoData &videoData, const playbackData &playbackData,
                    const bufferData &bufferData,
                    const throughputData &throughput);
@@ -36,16 +42,16 @@ public:
                             const int64_t clientId, int64_t bandwidth);
 
 private:
-  const double m_a1;
-  const double m_a2;
-  const double m_a3;
-  const double m_a4;
-  const double m_a5;
-  const int64_t m_bMin;
-  const int64_t m_bLow;
-  const int64_t m_bHigh;
-  const int64_t m_bOpt;
-  const int64_t m_bufferUpperbound;
+  double m_a1;
+  double m_a2;
+  double m_a3;
+  double m_a4;
+  double m_a5;
+  int64_t m_bMin;
+  int64_t m_bLow;
+  int64_t m_bHigh;
+  int64_t m_bOpt;
+  int64_t m_bufferUpperbound;
   int64_t m_lastRepIndex;
   int64_t m_lastBuffer;
   bool m_runningFastStart;
@@ -1,9 +1,37 @@
 #include "adapation-tomato.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("TomatoAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(TomatoAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm, TomatoAlgorithm);
+
+TypeId TomatoAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::TomatoAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute("TargetBuffer",
+                        "Buffer level in microseconds below which the "
+                        "estimated bandwidth is discounted",
+                        IntegerValue(15000000),
+                        MakeIntegerAccessor(&TomatoAlgorithm::m_targetBuffer),
+                        MakeIntegerChecker<int64_t>(1))
+          .AddAttribute("BufferMin",
+                        "Buffer level in microseconds below which the lowest "
+                        "representation is chosen",
+                        IntegerValue(10000000),
+                        MakeIntegerAccessor(&TomatoAlgorithm::m_bufferMin),
+                        MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds",
+              IntegerValue(40000000),
+              MakeIntegerAccessor(&TomatoAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(0));
+  return tid;
+}
 
 TomatoAlgorithm::TomatoAlgorithm(const videoData &videoData,
                                  const playbackData &playbackData,
@@ -25,7 +53,7 @@ TomatoAlgorithm::TomatoAlgorithm(const videoData &videoData,
                               m_bufferUpperbound(m_videoData.segmentDuration * 15),  // 15s
                               */
       m_bufferUpperbound(40000000),
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
@@ -38,7 +66,7 @@ algorithmReply TomatoAlgorithm::GetNextRep(const int64_t segmentCounter,
   answer.decisionCase = 0;
   answer.delayDecisionCase = 0;
   answer.nextDownloadDelay = 0;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
 
   int64_t bufferNow = 0;
@@ -52,14 +80,9 @@ algorithmReply TomatoAlgorithm::GetNextRep(const int64_t segmentCounter,
       answer.decisionCase = 0;
     } else {
       if (bandwidth > 0) {
-        int64_t nextHighestIndex = m_highestRepIndex;
-
-        while (nextHighestIndex > 0 &&
-               m_videoData.averageBitrate
-                       .at(m_videoData.userInfo.at(segmentCounter))
-                       .at(nextHighestIndex) > bandwidth * alpha) {
-          nextHighestIndex--;
-        }
+        int64_t nextHighestIndex =
+            m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter))
+                .GetHighestRepBelow(bandwidth * alpha);
         if (nextHighestIndex > m_lastRepIndex) {
           if (bufferNow > m_expBuffer) {
             if (bufferNow < m_expBuffer + m_videoData.segmentDuration / 2) {
@@ -107,7 +130,8 @@ algorithmReply TomatoAlgorithm::GetNextRep(const int64_t segmentCounter,
           // nextHighestIndex == m_lastRepIndex
           answer.decisionCase = 10;
         }
-        answer.nextRepIndex = nextHighestIndex;
+        answer.nextRepIndex = CapRepIndex(
+            nextHighestIndex, m_videoData.userInfo.at(segmentCounter));
       } else {
         answer.nextRepIndex = 0;
         answer.decisionCase = -1;
@@ -130,25 +154,23 @@ algorithmReply TomatoAlgorithm::GetNextRep(const int64_t segmentCounter,
       answer.delayDecisionCase = 1;
 
       // check whether the delaytime can be used for a hgher repindex
-      if (answer.nextRepIndex < m_highestRepIndex && bandwidth > 0 &&
+      if (answer.nextRepIndex <
+              GetMaxRepIndex(m_videoData.userInfo.at(segmentCounter)) &&
+          bandwidth > 0 &&
           ((answer.nextRepIndex + 1) == m_lastRepIndex)) {
         int64_t lastSegmentThroughput =
             8 *
-            (m_videoData.segmentSize
-                 .at(m_videoData.userInfo.at(segmentCounter - 1))
-                 .at(m_lastRepIndex)
-                 .at(segmentCounter - 1)) *
+            m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter - 1))
+                .GetSize(m_lastRepIndex, segmentCounter - 1) *
             1000000 /
             (m_throughput.transmissionEnd.at(segmentCounter - 1) -
              m_throughput.transmissionStart.at(segmentCounter - 1));
 
+        const BitrateLadder &ladder =
+            m_videoData.ladders.at(m_videoData.userInfo.at(segmentCounter));
         double extraDonwloadTime =
-            (m_videoData.averageBitrate
-                 .at(m_videoData.userInfo.at(segmentCounter))
-                 .at(answer.nextRepIndex + 1) -
-             m_videoData.averageBitrate
-                 .at(m_videoData.userInfo.at(segmentCounter))
-                 .at(answer.nextRepIndex)) /
+            (ladder.GetBitrate(answer.nextRepIndex + 1) -
+             ladder.GetBitrate(answer.nextRepIndex)) /
             //(lastSegmentThroughput * alpha / 1000);
             (lastSegmentThroughput / 1000);
 
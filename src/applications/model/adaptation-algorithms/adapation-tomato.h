@@ -7,6 +7,12 @@ namespace ns3 {
 // designed by tian
 class TomatoAlgorithm : public AdaptationAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   TomatoAlgorithm(const videoData &videoData, const playbackData &playbackData,
                   const bufferData &bufferData,
                   const throughputData &throughput);
@@ -21,7 +27,7 @@ private:
   int64_t m_expBuffer;
   int64_t m_multipleTinyDrop;
   double m_beta;
-  const int64_t m_bufferUpperbound;
+  int64_t m_bufferUpperbound;
   const int64_t m_highestRepIndex;
 };
 
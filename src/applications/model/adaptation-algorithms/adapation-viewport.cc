@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adapation-viewport.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ViewportAdaptationAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(ViewportAdaptationAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(AdaptationAlgorithm,
+                              ViewportAdaptationAlgorithm);
+
+TypeId ViewportAdaptationAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::ViewportAdaptationAlgorithm")
+          .SetParent<AdaptationAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "Solver",
+              "dp solves the allocation exactly on the quantised budget, "
+              "greedy upgrades faces by utility gain per byte",
+              EnumValue(ViewportAdaptationAlgorithm::DP),
+              MakeEnumAccessor(&ViewportAdaptationAlgorithm::m_solver),
+              MakeEnumChecker(ViewportAdaptationAlgorithm::DP, "dp",
+                              ViewportAdaptationAlgorithm::GREEDY, "greedy"))
+          .AddAttribute(
+              "Resolution",
+              "Number of steps the budget is quantised to for the dp solver",
+              UintegerValue(200),
+              MakeUintegerAccessor(&ViewportAdaptationAlgorithm::m_resolution),
+              MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute(
+              "AdjacentWeight",
+              "Viewport weight of the faces next to the predicted one",
+              DoubleValue(0.25),
+              MakeDoubleAccessor(
+                  &ViewportAdaptationAlgorithm::m_adjacentWeight),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "OppositeWeight",
+              "Viewport weight of the face opposite the predicted one",
+              DoubleValue(0.05),
+              MakeDoubleAccessor(
+                  &ViewportAdaptationAlgorithm::m_oppositeWeight),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "SafetyFactor",
+              "Share of the estimated bandwidth the faces of a segment may "
+              "use",
+              DoubleValue(0.9),
+              MakeDoubleAccessor(&ViewportAdaptationAlgorithm::m_safetyFactor),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "BufferMin",
+              "Buffer level in microseconds below which every face gets the "
+              "lowest representation",
+              IntegerValue(2000000),
+              MakeIntegerAccessor(&ViewportAdaptationAlgorithm::m_bufferMin),
+              MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "BufferUpperbound",
+              "Buffer level in microseconds the buffer never exceeds",
+              IntegerValue(40000000),
+              MakeIntegerAccessor(
+                  &ViewportAdaptationAlgorithm::m_bufferUpperbound),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
+
+ViewportAdaptationAlgorithm::ViewportAdaptationAlgorithm(
+    const videoData &videoData, const playbackData &playbackData,
+    const bufferData &bufferData, const throughputData &throughput)
+    : AdaptationAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_solver(DP), m_resolution(200), m_adjacentWeight(0.25),
+      m_oppositeWeight(0.05), m_safetyFactor(0.9), m_bufferMin(2000000),
+      m_bufferUpperbound(40000000),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+std::vector<int64_t> ViewportAdaptationAlgorithm::Allocate(
+    const std::vector<std::vector<int64_t>> &sizes,
+    const std::vector<double> &weights, double budget, knapsackSolver solver,
+    uint32_t resolution) {
+  const uint32_t faces = sizes.size();
+  std::vector<int64_t> allocation(faces, 0);
+  double base = 0;
+  for (uint32_t f = 0; f < faces; f++) {
+    base += sizes[f][0];
+  }
+  if (base >= budget) {
+    return allocation;
+  }
+
+  // utility of every face and representation, relative to the lowest one
+  std::vector<std::vector<double>> utility(faces);
+  for (uint32_t f = 0; f < faces; f++) {
+    double lowest = std::max<int64_t>(sizes[f][0], 1);
+    for (uint32_t r = 0; r < sizes[f].size(); r++) {
+      utility[f].push_back(
+          weights[f] * std::log(std::max<int64_t>(sizes[f][r], 1) / lowest));
+    }
+  }
+
+  if (solver == GREEDY) {
+    double spent = base;
+    while (true) {
+      int64_t bestFace = -1;
+      int64_t bestRep = 0;
+      double bestRatio = 0;
+      for (uint32_t f = 0; f < faces; f++) {
+        const int64_t current = allocation[f];
+        for (uint32_t r = current + 1; r < sizes[f].size(); r++) {
+          double extra = sizes[f][r] - sizes[f][current];
+          double gain = utility[f][r] - utility[f][current];
+          if (gain <= 0 || spent + extra > budget) {
+            continue;
+          }
+          double ratio = extra > 0 ? gain / extra
+                                   : std::numeric_limits<double>::max();
+          if (ratio > bestRatio) {
+            bestFace = f;
+            bestRep = r;
+            bestRatio = ratio;
+          }
+        }
+      }
+      if (bestFace < 0) {
+        break;
+      }
+      spent +=
+          sizes[bestFace][bestRep] - sizes[bestFace][allocation[bestFace]];
+      allocation[bestFace] = bestRep;
+    }
+    return allocation;
+  }
+
+  // value[b] is the best utility of the faces so far with at most b steps of
+  // the budget above the lowest representations; the extra sizes are rounded
+  // up, so every solution fits the exact budget
+  const double step = (budget - base) / resolution;
+  std::vector<double> value(resolution + 1, 0.0);
+  std::vector<std::vector<uint8_t>> choice(
+      faces, std::vector<uint8_t>(resolution + 1, 0));
+  for (uint32_t f = 0; f < faces; f++) {
+    std::vector<double> next(value);
+    for (uint32_t r = 1; r < sizes[f].size(); r++) {
+      double extra = std::max<int64_t>(sizes[f][r] - sizes[f][0], 0);
+      double cost = std::ceil(extra / step);
+      if (cost > resolution) {
+        continue;
+      }
+      for (uint32_t b = cost; b <= resolution; b++) {
+        double candidate = value[b - (uint32_t)cost] + utility[f][r];
+        if (candidate > next[b]) {
+          next[b] = candidate;
+          choice[f][b] = r;
+        }
+      }
+    }
+    value.swap(next);
+  }
+  uint32_t b = resolution;
+  for (int64_t f = faces - 1; f >= 0; f--) {
+    int64_t r = choice[f][b];
+    allocation[f] = r;
+    if (r > 0) {
+      double extra = std::max<int64_t>(sizes[f][r] - sizes[f][0], 0);
+      b -= (uint32_t)std::ceil(extra / step);
+    }
+  }
+  return allocation;
+}
+
+bool ViewportAdaptationAlgorithm::RequestsAllViewpoints(void) const {
+  return true;
+}
+
+algorithmReply ViewportAdaptationAlgorithm::GetNextRep(
+    const int64_t segmentCounter, const int64_t clientId, int64_t bandwidth) {
+  algorithmReply answer;
+  answer.decisionCase = 0;
+  answer.delayDecisionCase = 0;
+  answer.nextDownloadDelay = 0;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+  answer.estimateTh = bandwidth;
+
+  const uint32_t faces = m_videoData.ladders.size();
+  const int64_t viewport = m_videoData.userInfo.at(segmentCounter);
+  answer.faceRepIndex.assign(faces, 0);
+
+  int64_t bufferNow = 0;
+  if (segmentCounter != 0) {
+    bufferNow = std::max<int64_t>(
+        0, m_bufferData.bufferLevelNew.back() -
+               (timeNow - m_throughput.transmissionEnd.back()));
+  }
+
+  if (segmentCounter != 0 && bandwidth > 0 && bufferNow >= m_bufferMin) {
+    std::vector<double> weights(faces, m_adjacentWeight);
+    weights.at(viewport) = 1.0;
+    if (faces == 6) {
+      weights.at(viewport ^ 1) = m_oppositeWeight;
+    }
+    std::vector<std::vector<int64_t>> sizes(faces);
+    for (uint32_t f = 0; f < faces; f++) {
+      for (int64_t r = 0; r <= m_highestRepIndex; r++) {
+        sizes[f].push_back(m_videoData.ladders[f].GetSize(r, segmentCounter));
+      }
+    }
+    // the cap bounds the faces together
+    double budget = CapBitrate(m_safetyFactor * bandwidth) *
+                    m_videoData.segmentDuration / 8000000.0;
+    answer.faceRepIndex =
+        Allocate(sizes, weights, budget, m_solver, m_resolution);
+    answer.decisionCase = m_solver == DP ? 1 : 2;
+    if (IsBitrateCapped()) {
+      answer.decisionCase += 4;
+    }
+    bool capped = false;
+    for (uint32_t f = 0; f < faces; f++) {
+      if (CapRepIndex(answer.faceRepIndex[f], f) < answer.faceRepIndex[f]) {
+        capped = true;
+      }
+    }
+    if (capped) {
+      // allocate again without the representations above the cap
+      for (uint32_t f = 0; f < faces; f++) {
+        sizes[f].resize(GetMaxRepIndex(f) + 1);
+      }
+      answer.faceRepIndex =
+          Allocate(sizes, weights, budget, m_solver, m_resolution);
+      answer.decisionCase += 2;
+    }
+  }
+  answer.nextRepIndex = answer.faceRepIndex.at(viewport);
+
+  if (bufferNow + m_videoData.segmentDuration > m_bufferUpperbound) {
+    answer.nextDownloadDelay =
+        bufferNow + m_videoData.segmentDuration - m_bufferUpperbound;
+    answer.delayDecisionCase = 1;
+  }
+  return answer;
+}
+
+} // namespace ns3
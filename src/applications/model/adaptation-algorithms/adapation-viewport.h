@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef VIEWPORT_ALGORITHM_H
+#define VIEWPORT_ALGORITHM_H
+
+#include "tcp-stream-adaptation.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Viewport-aware bitrate allocation over the faces of a cube map.
+ *
+ * The viewpoints of the video are the six faces of a cube map (e.g. the
+ * CMP0-CMP5 segment size files), and every face of a segment is requested as
+ * a separate object. The face the user is predicted to look at
+ * (videoData::userInfo) gets the weight 1, its four neighbours AdjacentWeight
+ * and the face behind the user OppositeWeight; faces 2k and 2k+1 are
+ * opposite each other, as in the right/left, up/down, front/back order of
+ * common cube map layouts.
+ *
+ * The representations of the faces are chosen by solving the multiple-choice
+ * knapsack which maximises the weighted utility ln(S_r / S_0) of the faces
+ * under the budget SafetyFactor * bandwidth * segment duration, with the
+ * sizes S of the segment to download. Solver dp solves it exactly on a
+ * budget quantised to Resolution steps, greedy upgrades the face with the
+ * highest utility gain per byte until the budget is used up. Both are a few
+ * thousand operations for 6 faces and 7 representations. A cap set with
+ * SetMaxBitrate lowers the budget, so it bounds the sum of the bitrates of
+ * the faces.
+ */
+class ViewportAdaptationAlgorithm : public AdaptationAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  ViewportAdaptationAlgorithm(const videoData &videoData,
+                              const playbackData &playbackData,
+                              const bufferData &bufferData,
+                              const throughputData &throughput);
+
+  algorithmReply GetNextRep(const int64_t segmentCounter,
+                            const int64_t clientId, int64_t bandwidth);
+
+  /**
+   * \return true, every face of a segment is requested
+   */
+  virtual bool RequestsAllViewpoints(void) const;
+
+  /**
+   * \brief The knapsack solvers.
+   */
+  enum knapsackSolver {
+    DP,    //!< dynamic programming on the quantised budget
+    GREEDY //!< greedy upgrades by utility gain per byte
+  };
+
+  /**
+   * \brief Solve the multiple-choice knapsack.
+   * \param sizes sizes[f][r] is the size in bytes of face f in
+   * representation r
+   * \param weights the viewport weight of every face
+   * \param budget the bytes available for all faces
+   * \return the representation of every face; the lowest ones if even they
+   * exceed the budget
+   */
+  static std::vector<int64_t>
+  Allocate(const std::vector<std::vector<int64_t>> &sizes,
+           const std::vector<double> &weights, double budget,
+           knapsackSolver solver, uint32_t resolution);
+
+private:
+  knapsackSolver m_solver;
+  uint32_t m_resolution;   //!< budget steps of the dp solver
+  double m_adjacentWeight; //!< weight of the faces next to the viewport
+  double m_oppositeWeight; //!< weight of the face behind the user
+  double m_safetyFactor;   //!< share of the bandwidth that is allocated
+  int64_t m_bufferMin;     //!< below, all faces get the lowest representation
+  int64_t m_bufferUpperbound;
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* VIEWPORT_ALGORITHM_H */
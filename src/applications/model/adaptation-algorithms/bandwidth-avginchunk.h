@@ -1,11 +1,18 @@
 #ifndef BANDWIDTHAVGINCHUNK_ALGORITHM_H
 #define BANDWIDTHAVGINCHUNK_ALGORITHM_H
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-window.h"
 
 namespace ns3 {
 
 class BandwidthAvgInChunkAlgorithm : public BandwidthAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthAvgInChunkAlgorithm(const videoData &videoData,
                                const playbackData &playbackData,
                                const bufferData &bufferData,
@@ -14,9 +21,16 @@ public:
   bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
                                    const int64_t clientId);
 
+protected:
+  /**
+   * \brief Size the window.
+   */
+  virtual void DoInitialize(void);
+
 private:
-  const int64_t m_windowSize;
-  std::vector<double> m_lastBandwidthEstimate;
+  int64_t m_windowSize;
+  SlidingWindow<ArithmeticMean> m_window; //!< throughput of the last segments
+  int64_t m_segments;           //!< segments pushed into the window
   const int64_t m_highestRepIndex;
 };
 
@@ -1,9 +1,34 @@
 #include "bandwidth-avgintime.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("BandwidthAvgInTimeAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(BandwidthAvgInTimeAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthAvgInTimeAlgorithm);
+
+TypeId BandwidthAvgInTimeAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthAvgInTimeAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "ShortWindow",
+              "Length in microseconds of the recent window, the estimate is "
+              "the mean of its average and the average over the window "
+              "before it",
+              IntegerValue(10000000),
+              MakeIntegerAccessor(&BandwidthAvgInTimeAlgorithm::m_deltaTime_1),
+              MakeIntegerChecker<int64_t>(1))
+          .AddAttribute(
+              "LongWindow",
+              "Length in microseconds of the recent and the older window "
+              "together",
+              IntegerValue(30000000),
+              MakeIntegerAccessor(&BandwidthAvgInTimeAlgorithm::m_deltaTime_2),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
 
 BandwidthAvgInTimeAlgorithm::BandwidthAvgInTimeAlgorithm(
     const videoData &videoData, const playbackData &playbackData,
@@ -13,7 +38,7 @@ BandwidthAvgInTimeAlgorithm::BandwidthAvgInTimeAlgorithm(
       m_deltaTime_1(10000000),
       m_deltaTime_2(30000000),
       m_lastBandwidthEstimate(0),
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
@@ -23,9 +48,15 @@ bandwidthAlgoReply BandwidthAvgInTimeAlgorithm::BandwidthAlgo(
     const int64_t segmentCounter, const int64_t clientId) {
   bandwidthAlgoReply answer;
   answer.bandwidthAlgoIndex = 1;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
-  if (timeNow <= 10000000) {
+  for (uint32_t i = m_history.GetSize();
+       i < m_throughput.transmissionEnd.size(); i++) {
+    m_history.Add(m_throughput.transmissionStart.at(i),
+                  m_throughput.transmissionEnd.at(i),
+                  m_throughput.bytesReceived.at(i));
+  }
+  if (timeNow <= m_deltaTime_1) {
     answer.bandwidthEstimate = (int64_t)AverageBandwidth(
         timeNow - m_deltaTime_1, timeNow, answer.decisionCase);
   } else {
@@ -39,52 +70,16 @@ bandwidthAlgoReply BandwidthAvgInTimeAlgorithm::BandwidthAlgo(
 
   return answer;
 }
+
 double BandwidthAvgInTimeAlgorithm::AverageBandwidth(int64_t t_1, int64_t t_2,
                                                      int64_t &decisioncase) {
-  if (t_1 < 0) {
-    t_1 = 0;
-  }
-  if (m_throughput.transmissionEnd.size() < 1) {
+  if (m_history.GetSize() == 0) {
     decisioncase = 0;
     return m_lastBandwidthEstimate;
   }
-
-  int32_t indexStart = 0;
-  int32_t indexEnd = m_throughput.transmissionEnd.size() - 1;
-  for (int32_t i = 0; i <= int32_t(m_throughput.transmissionStart.size() - 1);
-       i++) {
-    if (m_throughput.transmissionEnd.at(i) < t_1)
-      continue;
-    else {
-      indexStart = i;
-      break;
-    }
-  }
-  for (int32_t j = int32_t(m_throughput.transmissionEnd.size() - 1); j >= 0;
-       j--) {
-    if (m_throughput.transmissionStart.at(j) > t_2)
-      continue;
-    else {
-      indexEnd = j;
-      break;
-    }
-  }
-  NS_ASSERT_MSG(indexEnd >= indexStart, "indexEnd should be >= indexStart");
-  double sumThroughput = 0.0;
-  double transmissionTime = 0.0;
-  while (indexStart <= indexEnd) {
-    sumThroughput +=
-        8 * m_videoData.segmentSize.at(m_videoData.userInfo.at(indexStart))
-                .at(m_videoData.repIndex.at(indexStart))
-                .at(indexStart);
-    transmissionTime +=
-        (double)(m_throughput.transmissionEnd.at(indexStart) -
-                 m_throughput.transmissionStart.at(indexStart)) /
-        1000000.0;
-    indexStart++;
-  }
   decisioncase = 1;
-  m_lastBandwidthEstimate = (sumThroughput / (double)transmissionTime);
+  m_lastBandwidthEstimate =
+      m_history.GetAverage(std::max<int64_t>(t_1, 0), t_2);
   return m_lastBandwidthEstimate;
 }
 
@@ -1,11 +1,18 @@
 #ifndef BANDWIDTHAVGINTIME_ALGORITHM_H
 #define BANDWIDTHAVGINTIME_ALGORITHM_H
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-history.h"
 
 namespace ns3 {
 
 class BandwidthAvgInTimeAlgorithm : public BandwidthAlgorithm {
  public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthAvgInTimeAlgorithm(const videoData &videoData,
                               const playbackData &playbackData,
                               const bufferData &bufferData,
@@ -15,11 +22,16 @@ class BandwidthAvgInTimeAlgorithm : public BandwidthAlgorithm {
                                    const int64_t clientId);
 
  private:
+  /**
+   * \return the average throughput of the segments downloaded at least
+   * partly in [t1, t2], of all segments if there are none
+   */
   double AverageBandwidth(int64_t t1, int64_t t2, int64_t &decisioncase);
 
   int64_t m_deltaTime_1;
   int64_t m_deltaTime_2;
   double m_lastBandwidthEstimate;  // Last bandwidthEstimate Value
+  ThroughputHistory m_history;     //!< the downloaded segments
   const int64_t m_highestRepIndex;
 };
 
@@ -0,0 +1,225 @@
+#include "bandwidth-ensemble.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include <cmath>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("BandwidthEnsembleAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(BandwidthEnsembleAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthEnsembleAlgorithm);
+
+TypeId BandwidthEnsembleAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthEnsembleAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "Members",
+              "Comma separated BandwidthAlgorithm TypeIds, and crosslayer for "
+              "the rate of the PHY reception statistics",
+              StringValue("ns3::BandwidthAvgInTimeAlgorithm,"
+                          "ns3::BandwidthLongAvgAlgorithm,"
+                          "ns3::BandwidthAvgInChunkAlgorithm,"
+                          "ns3::BandwidthHarmonicAlgorithm,"
+                          "ns3::BandwidthWHarmonicAlgorithm,"
+                          "ns3::BandwidthKalmanAlgorithm,crosslayer"),
+              MakeStringAccessor(&BandwidthEnsembleAlgorithm::m_members),
+              MakeStringChecker())
+          .AddAttribute(
+              "Mode",
+              "best follows the member with the lowest error, blend weights "
+              "the members by the inverse of their error",
+              EnumValue(BandwidthEnsembleAlgorithm::BEST),
+              MakeEnumAccessor(&BandwidthEnsembleAlgorithm::m_mode),
+              MakeEnumChecker(BandwidthEnsembleAlgorithm::BEST, "best",
+                              BandwidthEnsembleAlgorithm::BLEND, "blend"))
+          .AddAttribute(
+              "Smoothing",
+              "Weight of the latest segment in the moving average of the "
+              "errors",
+              DoubleValue(0.2),
+              MakeDoubleAccessor(&BandwidthEnsembleAlgorithm::m_smoothing),
+              MakeDoubleChecker<double>(0.0, 1.0))
+          .AddAttribute(
+              "LogPrefix",
+              "Path prefix of the per-member error log, none if empty",
+              StringValue(""),
+              MakeStringAccessor(&BandwidthEnsembleAlgorithm::m_logPrefix),
+              MakeStringChecker());
+  return tid;
+}
+
+BandwidthEnsembleAlgorithm::BandwidthEnsembleAlgorithm(
+    const videoData &videoData, const playbackData &playbackData,
+    const bufferData &bufferData, const throughputData &throughput)
+    : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_mode(BEST), m_smoothing(0.2), m_crossLayer(0), m_predicted(-1),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void BandwidthEnsembleAlgorithm::DoInitialize(void) {
+  m_ensemble.clear();
+  std::istringstream members(m_members);
+  std::string name;
+  while (std::getline(members, name, ',')) {
+    if (name.empty()) {
+      continue;
+    }
+    member m;
+    m.name = name;
+    m.prediction = 0;
+    m.variance = 0;
+    m.error = -1;
+    if (name != "crosslayer") {
+      TypeId tid = TypeId::LookupByName(name);
+      if (tid == GetTypeId()) {
+        NS_FATAL_ERROR("An ensemble cannot be a member of itself");
+      }
+      m.algorithm = AlgorithmRegistry<BandwidthAlgorithm>::Create(
+          tid, m_videoData, m_playbackData, m_bufferData, m_throughput);
+      if (m.algorithm == 0) {
+        NS_FATAL_ERROR(name << " is not a registered bandwidth algorithm");
+      }
+      m.algorithm->Initialize();
+    }
+    m_ensemble.push_back(m);
+  }
+  if (m_ensemble.empty()) {
+    NS_FATAL_ERROR("The ensemble has no members");
+  }
+  m_predicted = -1;
+  BandwidthAlgorithm::DoInitialize();
+}
+
+void BandwidthEnsembleAlgorithm::DoDispose(void) {
+  for (uint32_t i = 0; i < m_ensemble.size(); i++) {
+    if (m_ensemble[i].algorithm != 0) {
+      m_ensemble[i].algorithm->Dispose();
+    }
+  }
+  m_ensemble.clear();
+  if (m_log.is_open()) {
+    m_log.close();
+  }
+  BandwidthAlgorithm::DoDispose();
+}
+
+void BandwidthEnsembleAlgorithm::PacketReceived(int64_t time,
+                                                uint32_t bytes) {
+  for (uint32_t i = 0; i < m_ensemble.size(); i++) {
+    if (m_ensemble[i].algorithm != 0) {
+      m_ensemble[i].algorithm->PacketReceived(time, bytes);
+    }
+  }
+}
+
+void BandwidthEnsembleAlgorithm::CrossLayerEstimate(double bandwidth) {
+  m_crossLayer = bandwidth;
+  for (uint32_t i = 0; i < m_ensemble.size(); i++) {
+    if (m_ensemble[i].algorithm != 0) {
+      m_ensemble[i].algorithm->CrossLayerEstimate(bandwidth);
+    }
+  }
+}
+
+void BandwidthEnsembleAlgorithm::Score(const int64_t clientId) {
+  if (m_predicted < 0 ||
+      m_predicted >= (int64_t)m_throughput.transmissionEnd.size()) {
+    return;
+  }
+  const double throughput = GetSegmentThroughput(m_predicted);
+  if (!(throughput > 0) || std::isinf(throughput)) {
+    return;
+  }
+  if (!m_logPrefix.empty() && !m_log.is_open()) {
+    std::ostringstream file;
+    file << m_logPrefix << "cl" << clientId << "_ensembleLog.txt";
+    m_log.open(file.str().c_str());
+    m_log << "Segment_Index Member Prediction Throughput Error "
+             "Smoothed_Error\n";
+  }
+  for (uint32_t i = 0; i < m_ensemble.size(); i++) {
+    member &m = m_ensemble[i];
+    if (m.prediction <= 0) {
+      continue;
+    }
+    const double error = std::fabs(std::log(m.prediction / throughput));
+    m.error = m.error < 0 ? error
+                          : (1 - m_smoothing) * m.error + m_smoothing * error;
+    if (m_log.is_open()) {
+      m_log << m_predicted << " " << m.name << " " << m.prediction << " "
+            << throughput << " " << error << " " << m.error << "\n";
+    }
+  }
+  if (m_log.is_open()) {
+    m_log.flush();
+  }
+}
+
+bandwidthAlgoReply
+BandwidthEnsembleAlgorithm::BandwidthAlgo(const int64_t segmentCounter,
+                                          const int64_t clientId) {
+  bandwidthAlgoReply answer;
+  answer.bandwidthAlgoIndex = 3;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+
+  // the predictions for the previous segment meet its throughput
+  if (m_predicted != segmentCounter) {
+    Score(clientId);
+  }
+
+  int64_t best = -1;
+  double weights = 0;
+  double blend = 0;
+  for (uint32_t i = 0; i < m_ensemble.size(); i++) {
+    member &m = m_ensemble[i];
+    if (m.algorithm != 0) {
+      bandwidthAlgoReply reply =
+          m.algorithm->BandwidthAlgo(segmentCounter, clientId);
+      m.prediction = reply.bandwidthEstimate;
+      m.variance = reply.bandwidthVariance;
+    } else {
+      m.prediction = m_crossLayer;
+      m.variance = 0;
+    }
+    if (!(m.prediction > 0) || std::isinf(m.prediction)) {
+      continue;
+    }
+    // unscored members only count until one of them has been scored
+    if (best < 0 || (m.error >= 0 && (m_ensemble[best].error < 0 ||
+                                      m.error < m_ensemble[best].error))) {
+      best = i;
+    }
+    if (m.error >= 0) {
+      const double weight = 1.0 / std::max(m.error, 0.01);
+      weights += weight;
+      blend += weight * m.prediction;
+    }
+  }
+  m_predicted = segmentCounter;
+
+  if (best < 0) {
+    answer.bandwidthEstimate = 0;
+    answer.decisionCase = 0;
+    return answer;
+  }
+  if (m_mode == BLEND && weights > 0) {
+    answer.bandwidthEstimate = blend / weights;
+    answer.bandwidthVariance = 0;
+    answer.decisionCase = m_ensemble.size() + 1;
+  } else {
+    answer.bandwidthEstimate = m_ensemble[best].prediction;
+    answer.bandwidthVariance = m_ensemble[best].variance;
+    answer.decisionCase = best + 1;
+  }
+  return answer;
+}
+
+} // namespace ns3
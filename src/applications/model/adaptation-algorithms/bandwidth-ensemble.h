@@ -0,0 +1,91 @@
+#ifndef BANDWIDTHENSEMBLE_ALGORITHM_H
+#define BANDWIDTHENSEMBLE_ALGORITHM_H
+#include "tcp-stream-bandwidth.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Runs several estimators side by side and follows the most accurate.
+ *
+ * Every decision, each of the Members, a comma separated list of
+ * BandwidthAlgorithm TypeIds and "crosslayer" for the rate of the PHY
+ * reception statistics, predicts the throughput of the segment about to be
+ * downloaded. When the download has ended, the prediction of every member is
+ * scored with its relative error |ln(prediction / throughput)|, smoothed over
+ * the segments by an exponential moving average with the weight Smoothing.
+ * The estimate is that of the member with the lowest error (Mode best), or
+ * the mean of the members weighted by the inverse of their error (Mode
+ * blend); both are O(members) per decision.
+ *
+ * With a LogPrefix, the prediction, throughput and error of every member and
+ * segment are written to <LogPrefix>cl<clientId>_ensembleLog.txt.
+ */
+class BandwidthEnsembleAlgorithm : public BandwidthAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  BandwidthEnsembleAlgorithm(const videoData &videoData,
+                             const playbackData &playbackData,
+                             const bufferData &bufferData,
+                             const throughputData &throughput);
+
+  bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
+                                   const int64_t clientId);
+
+  void PacketReceived(int64_t time, uint32_t bytes);
+
+  void CrossLayerEstimate(double bandwidth);
+
+  /**
+   * \brief How the estimates of the members are combined.
+   */
+  enum ensembleMode {
+    BEST, //!< the member with the lowest error
+    BLEND //!< the mean weighted by the inverse errors
+  };
+
+protected:
+  /**
+   * \brief Create the members.
+   */
+  virtual void DoInitialize(void);
+
+  virtual void DoDispose(void);
+
+private:
+  /**
+   * \brief Score the predictions for the segment which was downloaded last.
+   */
+  void Score(const int64_t clientId);
+
+  /**
+   * \brief A member of the ensemble.
+   */
+  struct member {
+    std::string name;
+    Ptr<BandwidthAlgorithm> algorithm; //!< 0 for the cross-layer estimate
+    double prediction; //!< bps, for the segment being downloaded
+    double variance;   //!< of the prediction in bps^2
+    double error;      //!< smoothed relative error, < 0 before the first
+  };
+
+  std::string m_members;
+  ensembleMode m_mode;
+  double m_smoothing;       //!< weight of the latest error
+  std::string m_logPrefix;  //!< no log if empty
+  std::vector<member> m_ensemble;
+  double m_crossLayer;      //!< latest cross-layer estimate in bps
+  int64_t m_predicted;      //!< segment of the predictions, -1 if none
+  std::ofstream m_log;
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* BANDWIDTHENSEMBLE_ALGORITHM_H */
@@ -1,59 +1,61 @@
 #include "bandwidth-harmonic.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("BandwidthHarmonicAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(BandwidthHarmonicAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthHarmonicAlgorithm);
+
+TypeId BandwidthHarmonicAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthHarmonicAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "WindowSize",
+              "Number of past segments the harmonic mean is taken over",
+              IntegerValue(5),
+              MakeIntegerAccessor(&BandwidthHarmonicAlgorithm::m_windowSize),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
 
 BandwidthHarmonicAlgorithm::BandwidthHarmonicAlgorithm(
     const videoData &videoData, const playbackData &playbackData,
     const bufferData &bufferData, const throughputData &throughput)
     : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
       m_windowSize(5), // 5 segment for smoothing
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_segments(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
 }
 
+void BandwidthHarmonicAlgorithm::DoInitialize(void) {
+  m_window.SetCapacity(m_windowSize);
+  m_segments = 0;
+  BandwidthAlgorithm::DoInitialize();
+}
+
 bandwidthAlgoReply
 BandwidthHarmonicAlgorithm::BandwidthAlgo(const int64_t segmentCounter,
                                           const int64_t clientId) {
   bandwidthAlgoReply answer;
   answer.bandwidthAlgoIndex = 3;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
   double bandwidthEstimate = 0.0;
 
   if (segmentCounter != 0) {
-    double lastSegmentDownloadTime =
-        (double)(m_throughput.transmissionEnd.at(segmentCounter - 1) -
-                 m_throughput.transmissionStart.at(segmentCounter - 1)) /
-        1000000.0;
-    double lastSegmentThroughput =
-        8.0 *
-        m_videoData.segmentSize.at(m_videoData.userInfo.at(segmentCounter - 1))
-            .at(m_videoData.repIndex.at(segmentCounter - 1))
-            .at(segmentCounter - 1) /
-        lastSegmentDownloadTime;
-    m_lastBandwidthEstimate.push_back(lastSegmentThroughput);
-    int64_t windowSize = m_lastBandwidthEstimate.size();
-    double sumDownloadRate = 0.0;
-    if (windowSize < m_windowSize) {
-      for (int64_t i = 0; i != windowSize; i++) {
-        sumDownloadRate += 1 / m_lastBandwidthEstimate.at(i);
-      }
-      bandwidthEstimate = (double)windowSize / (sumDownloadRate);
-      answer.decisionCase = 1;
-    } else {
-      for (int64_t i = windowSize - m_windowSize; i != windowSize; i++) {
-        sumDownloadRate += 1 / m_lastBandwidthEstimate.at(i);
-      }
-      bandwidthEstimate = (double)m_windowSize / sumDownloadRate;
-      answer.decisionCase = 2;
+    // the window drops the oldest segment once it holds m_windowSize
+    for (; m_segments < segmentCounter; m_segments++) {
+      m_window.Push(GetSegmentThroughput(m_segments));
     }
+    bandwidthEstimate = m_window.Get();
+    answer.decisionCase = m_window.GetSize() < m_windowSize ? 1 : 2;
   } else {
-    answer.bandwidthEstimate = bandwidthEstimate;
     answer.decisionCase = 0;
   }
   answer.bandwidthEstimate = bandwidthEstimate;
@@ -1,11 +1,18 @@
 #ifndef BANDWIDTHHARMONIC_ALGORITHM_H
 #define BANDWIDTHHARMONIC_ALGORITHM_H
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-window.h"
 
 namespace ns3 {
 
 class BandwidthHarmonicAlgorithm : public BandwidthAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthHarmonicAlgorithm(const videoData &videoData,
                              const playbackData &playbackData,
                              const bufferData &bufferData,
@@ -14,9 +21,16 @@ public:
   bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
                                    const int64_t clientId);
 
+protected:
+  /**
+   * \brief Size the window.
+   */
+  virtual void DoInitialize(void);
+
 private:
-  const int64_t m_windowSize;
-  std::vector<double> m_lastBandwidthEstimate;
+  int64_t m_windowSize;
+  SlidingWindow<HarmonicMean> m_window; //!< throughput of the last segments
+  int64_t m_segments;           //!< segments pushed into the window
   const int64_t m_highestRepIndex;
 };
 
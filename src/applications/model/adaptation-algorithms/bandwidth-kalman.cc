@@ -0,0 +1,162 @@
+#include "bandwidth-kalman.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("BandwidthKalmanAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(BandwidthKalmanAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthKalmanAlgorithm);
+
+TypeId BandwidthKalmanAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthKalmanAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "Interval",
+              "Length in microseconds of the intervals the packets are "
+              "grouped into",
+              IntegerValue(200000),
+              MakeIntegerAccessor(&BandwidthKalmanAlgorithm::m_interval),
+              MakeIntegerChecker<int64_t>(1))
+          .AddAttribute(
+              "IdleGap",
+              "Time in microseconds between two packets which closes an "
+              "interval",
+              IntegerValue(100000),
+              MakeIntegerAccessor(&BandwidthKalmanAlgorithm::m_idleGap),
+              MakeIntegerChecker<int64_t>(1))
+          .AddAttribute(
+              "ProcessNoise",
+              "Growth per second of the variance of the log throughput",
+              DoubleValue(0.05),
+              MakeDoubleAccessor(&BandwidthKalmanAlgorithm::m_processNoise),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "MeasurementNoise",
+              "Variance of the log throughput of one interval, the initial "
+              "one if NoiseAdaptation is not 0",
+              DoubleValue(0.1),
+              MakeDoubleAccessor(
+                  &BandwidthKalmanAlgorithm::m_measurementNoise),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "NoiseAdaptation",
+              "Weight of the last squared innovation in the measurement "
+              "noise, 0 to keep MeasurementNoise",
+              DoubleValue(0.1),
+              MakeDoubleAccessor(&BandwidthKalmanAlgorithm::m_noiseAdaptation),
+              MakeDoubleChecker<double>(0.0, 1.0))
+          .AddAttribute(
+              "Confidence",
+              "Standard deviations of the log throughput the estimate is "
+              "below the median, 0 for the median",
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&BandwidthKalmanAlgorithm::m_confidence),
+              MakeDoubleChecker<double>());
+  return tid;
+}
+
+BandwidthKalmanAlgorithm::BandwidthKalmanAlgorithm(
+    const videoData &videoData, const playbackData &playbackData,
+    const bufferData &bufferData, const throughputData &throughput)
+    : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_interval(200000), m_idleGap(100000), m_processNoise(0.05),
+      m_measurementNoise(0.1), m_noiseAdaptation(0.1), m_noise(0.1),
+      m_confidence(1.0), m_mean(0), m_variance(0),
+      m_lastUpdate(0), m_intervalStart(-1), m_lastArrival(0),
+      m_intervalBytes(0), m_packets(false), m_segments(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void BandwidthKalmanAlgorithm::PacketReceived(int64_t time, uint32_t bytes) {
+  m_packets = true;
+  if (m_intervalStart >= 0 && time - m_lastArrival > m_idleGap) {
+    // the link was idle, the interval ends with its last packet
+    if (m_intervalBytes > 0 && m_lastArrival > m_intervalStart) {
+      Measure(m_lastArrival, 8000000.0 * m_intervalBytes /
+                                 (m_lastArrival - m_intervalStart));
+    }
+    m_intervalStart = -1;
+  }
+  m_lastArrival = time;
+  if (m_intervalStart < 0) {
+    // the first packet arrived at the start, its bytes were sent before
+    m_intervalStart = time;
+    m_intervalBytes = 0;
+    return;
+  }
+  m_intervalBytes += bytes;
+  if (time - m_intervalStart >= m_interval) {
+    Measure(time, 8000000.0 * m_intervalBytes / (time - m_intervalStart));
+    m_intervalStart = time;
+    m_intervalBytes = 0;
+  }
+}
+
+double BandwidthKalmanAlgorithm::GetVariance(int64_t time) const {
+  return m_variance +
+         m_processNoise * std::max<int64_t>(time - m_lastUpdate, 0) / 1000000.0;
+}
+
+void BandwidthKalmanAlgorithm::Measure(int64_t time, double throughput) {
+  if (throughput <= 0) {
+    return;
+  }
+  const double measurement = std::log(throughput);
+  if (m_variance <= 0) {
+    m_mean = measurement;
+    m_noise = m_measurementNoise;
+    m_variance = m_noise > 0 ? m_noise : 1e-9;
+  } else {
+    const double predicted = GetVariance(time);
+    const double innovation = measurement - m_mean;
+    // the squared innovation is predicted + noise on average
+    m_noise = std::max((1 - m_noiseAdaptation) * m_noise +
+                           m_noiseAdaptation *
+                               (innovation * innovation - predicted),
+                       1e-6);
+    const double gain = predicted / (predicted + m_noise);
+    m_mean += gain * innovation;
+    m_variance = (1 - gain) * predicted;
+  }
+  m_lastUpdate = time;
+}
+
+bandwidthAlgoReply
+BandwidthKalmanAlgorithm::BandwidthAlgo(const int64_t segmentCounter,
+                                        const int64_t clientId) {
+  bandwidthAlgoReply answer;
+  answer.bandwidthAlgoIndex = 3;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+
+  if (!m_packets) {
+    for (; m_segments < (int64_t)m_throughput.transmissionEnd.size();
+         m_segments++) {
+      Measure(m_throughput.transmissionEnd.at(m_segments),
+              GetSegmentThroughput(m_segments));
+    }
+  }
+
+  if (m_variance <= 0) {
+    answer.bandwidthEstimate = 0;
+    answer.decisionCase = 0;
+    return answer;
+  }
+  // the uncertainty grew since the last measurement
+  const double variance = GetVariance(timeNow);
+  answer.bandwidthEstimate =
+      std::exp(m_mean - m_confidence * std::sqrt(variance));
+  answer.bandwidthVariance =
+      (std::exp(variance) - 1) * std::exp(2 * m_mean + variance);
+  answer.decisionCase = m_packets ? 1 : 2;
+  return answer;
+}
+
+} // namespace ns3
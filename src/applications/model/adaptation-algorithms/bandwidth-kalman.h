@@ -0,0 +1,81 @@
+#ifndef BANDWIDTHKALMAN_ALGORITHM_H
+#define BANDWIDTHKALMAN_ALGORITHM_H
+#include "tcp-stream-bandwidth.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Kalman filter on the throughput of short intervals of packets.
+ *
+ * The packets the client receives are grouped into intervals of Interval
+ * microseconds; a gap of more than IdleGap between two packets, e.g. while
+ * the client waits with a full buffer, closes the interval early, so idle
+ * time is never mistaken for a slow link. The throughput of every interval
+ * is a measurement of the filter, many per segment where the per-segment
+ * estimators get one.
+ *
+ * The filter tracks the logarithm of the throughput as a random walk, whose
+ * variance grows by ProcessNoise per second, measured with the variance
+ * MeasurementNoise; in the log domain both are relative, so the same
+ * parameters fit any bitrate. With NoiseAdaptation the measurement noise
+ * follows the squared innovations instead, so the filter is less sure of a
+ * throughput that fluctuates. The estimate passed on is the quantile
+ * exp(mean - Confidence * sigma) of the throughput: one standard deviation
+ * below the median by default, lower and lower as the filter becomes
+ * unsure, which makes a rate-based algorithm conservative on its own. The
+ * variance of the throughput is in bandwidthAlgoReply::bandwidthVariance.
+ *
+ * Without packets, e.g. in scratch/abr-eval, the throughput of every
+ * segment is the measurement.
+ */
+class BandwidthKalmanAlgorithm : public BandwidthAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  BandwidthKalmanAlgorithm(const videoData &videoData,
+                           const playbackData &playbackData,
+                           const bufferData &bufferData,
+                           const throughputData &throughput);
+
+  bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
+                                   const int64_t clientId);
+
+  void PacketReceived(int64_t time, uint32_t bytes);
+
+private:
+  /**
+   * \brief Feed a throughput in bps measured up to time.
+   */
+  void Measure(int64_t time, double throughput);
+
+  /**
+   * \return the variance of the log throughput predicted for time
+   */
+  double GetVariance(int64_t time) const;
+
+  int64_t m_interval;        //!< microseconds
+  int64_t m_idleGap;         //!< microseconds
+  double m_processNoise;     //!< per second, of the log throughput
+  double m_measurementNoise; //!< of the log throughput, attribute
+  double m_noiseAdaptation;  //!< weight of an innovation in m_noise
+  double m_noise;            //!< measurement noise in use
+  double m_confidence;       //!< standard deviations below the median
+  double m_mean;             //!< of the log throughput
+  double m_variance;         //!< of the log throughput, 0 before the first
+                             //!< measurement
+  int64_t m_lastUpdate;      //!< microseconds
+  int64_t m_intervalStart;   //!< -1 if no interval is open
+  int64_t m_lastArrival;     //!< microseconds
+  int64_t m_intervalBytes;   //!< received after the start of the interval
+  bool m_packets;            //!< true once a packet was received
+  int64_t m_segments;        //!< segments measured without packets
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* BANDWIDTHKALMAN_ALGORITHM_H */
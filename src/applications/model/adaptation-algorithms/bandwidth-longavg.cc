@@ -4,13 +4,21 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("BandwidthLongAvgAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(BandwidthLongAvgAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthLongAvgAlgorithm);
+
+TypeId BandwidthLongAvgAlgorithm::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::BandwidthLongAvgAlgorithm")
+                          .SetParent<BandwidthAlgorithm>()
+                          .SetGroupName("Applications");
+  return tid;
+}
 
 BandwidthLongAvgAlgorithm::BandwidthLongAvgAlgorithm(
     const videoData &videoData, const playbackData &playbackData,
     const bufferData &bufferData, const throughputData &throughput)
     : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
-      m_lastBandwidthEstimate(0.0), // default bandwidthEstimate value = 0
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_segments(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
@@ -22,34 +30,19 @@ BandwidthLongAvgAlgorithm::BandwidthAlgo(const int64_t segmentCounter,
 {
   bandwidthAlgoReply answer;
   answer.bandwidthAlgoIndex = 3;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
 
-  if (segmentCounter != 0) {
-    double lastSegmentDownloadTime =
-        (double)(m_throughput.transmissionEnd.at(segmentCounter - 1) -
-                 m_throughput.transmissionStart.at(segmentCounter - 1)) /
-        1000000.0;
-    double lastSegmentThroughput =
-        8.0 *
-        m_videoData.segmentSize.at(m_videoData.userInfo.at(segmentCounter - 1))
-            .at(m_videoData.repIndex.at(segmentCounter - 1))
-            .at(segmentCounter - 1) /
-        lastSegmentDownloadTime;
-    if (segmentCounter != 1) {
-      m_lastBandwidthEstimate =
-          m_lastBandwidthEstimate +
-          (lastSegmentThroughput - m_lastBandwidthEstimate) / segmentCounter;
-      answer.decisionCase = 2;
-    } else {
-      m_lastBandwidthEstimate = lastSegmentThroughput;
-      answer.decisionCase = 1;
-    }
-  } else {
-    m_lastBandwidthEstimate = m_lastBandwidthEstimate;
+  // the mean over the whole session needs no window, just its sum
+  for (; m_segments < segmentCounter; m_segments++) {
+    m_mean.Add(GetSegmentThroughput(m_segments));
+  }
+  if (segmentCounter == 0) {
     answer.decisionCase = 0;
+  } else {
+    answer.decisionCase = segmentCounter != 1 ? 2 : 1;
   }
-  answer.bandwidthEstimate = m_lastBandwidthEstimate;
+  answer.bandwidthEstimate = m_mean.Get();
   return answer;
 }
 
@@ -1,11 +1,18 @@
 #ifndef BANDWIDTHLONGAVG_ALGORITHM_H
 #define BANDWIDTHLONGAVG_ALGORITHM_H
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-window.h"
 
 namespace ns3 {
 
 class BandwidthLongAvgAlgorithm : public BandwidthAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthLongAvgAlgorithm(const videoData &videoData,
                             const playbackData &playbackData,
                             const bufferData &bufferData,
@@ -15,7 +22,8 @@ public:
                                    const int64_t clientId);
 
 private:
-  double m_lastBandwidthEstimate; // Last bandwidthEstimate Value
+  ArithmeticMean m_mean; //!< throughput of all segments so far
+  int64_t m_segments;    //!< segments added to the mean
   const int64_t m_highestRepIndex;
 };
 
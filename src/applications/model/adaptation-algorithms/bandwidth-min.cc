@@ -0,0 +1,65 @@
+#include "bandwidth-min.h"
+#include "ns3/integer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("BandwidthMinAlgorithm");
+NS_OBJECT_ENSURE_REGISTERED(BandwidthMinAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthMinAlgorithm);
+
+TypeId BandwidthMinAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthMinAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "WindowSize",
+              "Number of past segments the minimum is taken over",
+              IntegerValue(5),
+              MakeIntegerAccessor(&BandwidthMinAlgorithm::m_windowSize),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
+
+BandwidthMinAlgorithm::BandwidthMinAlgorithm(
+    const videoData &videoData, const playbackData &playbackData,
+    const bufferData &bufferData, const throughputData &throughput)
+    : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_windowSize(5),
+      m_segments(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
+  NS_LOG_INFO(this);
+  NS_ASSERT_MSG(m_highestRepIndex >= 0,
+                "The highest quality representation index should be >= 0");
+}
+
+void BandwidthMinAlgorithm::DoInitialize(void) {
+  m_window.SetCapacity(m_windowSize);
+  m_segments = 0;
+  BandwidthAlgorithm::DoInitialize();
+}
+
+bandwidthAlgoReply
+BandwidthMinAlgorithm::BandwidthAlgo(const int64_t segmentCounter,
+                                     const int64_t clientId) {
+  bandwidthAlgoReply answer;
+  answer.bandwidthAlgoIndex = 3;
+  const int64_t timeNow = AlgorithmClock::Now();
+  answer.decisionTime = timeNow;
+  double bandwidthEstimate = 0.0;
+
+  if (segmentCounter != 0) {
+    // the monotone queue of the window keeps the minimum in O(1) per segment
+    for (; m_segments < segmentCounter; m_segments++) {
+      m_window.Push(GetSegmentThroughput(m_segments));
+    }
+    bandwidthEstimate = m_window.Get();
+    answer.decisionCase = m_window.GetSize() < m_windowSize ? 1 : 2;
+  } else {
+    answer.decisionCase = 0;
+  }
+  answer.bandwidthEstimate = bandwidthEstimate;
+  return answer;
+}
+
+} // namespace ns3
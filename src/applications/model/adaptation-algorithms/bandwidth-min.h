@@ -0,0 +1,44 @@
+#ifndef BANDWIDTHMIN_ALGORITHM_H
+#define BANDWIDTHMIN_ALGORITHM_H
+#include "tcp-stream-bandwidth.h"
+#include "tcp-stream-window.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief The lowest throughput of the last WindowSize segments, a
+ * conservative estimate which follows drops at once and rises only when the
+ * slow segment leaves the window.
+ */
+class BandwidthMinAlgorithm : public BandwidthAlgorithm {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  BandwidthMinAlgorithm(const videoData &videoData,
+                        const playbackData &playbackData,
+                        const bufferData &bufferData,
+                        const throughputData &throughput);
+
+  bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
+                                   const int64_t clientId);
+
+protected:
+  /**
+   * \brief Size the window.
+   */
+  virtual void DoInitialize(void);
+
+private:
+  int64_t m_windowSize;
+  SlidingWindow<Minimum> m_window; //!< throughput of the last segments
+  int64_t m_segments;              //!< segments pushed into the window
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* BANDWIDTHMIN_ALGORITHM_H */
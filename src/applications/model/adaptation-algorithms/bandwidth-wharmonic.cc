@@ -1,58 +1,65 @@
 #include "bandwidth-wharmonic.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("BandwidthWHarmonicAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(BandwidthWHarmonicAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(BandwidthAlgorithm, BandwidthWHarmonicAlgorithm);
+
+TypeId BandwidthWHarmonicAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::BandwidthWHarmonicAlgorithm")
+          .SetParent<BandwidthAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "WindowSize",
+              "Number of past segments the weighted mean is taken over",
+              IntegerValue(5),
+              MakeIntegerAccessor(&BandwidthWHarmonicAlgorithm::m_windowSize),
+              MakeIntegerChecker<int64_t>(1));
+  return tid;
+}
 
 BandwidthWHarmonicAlgorithm::BandwidthWHarmonicAlgorithm(
     const videoData &videoData, const playbackData &playbackData,
     const bufferData &bufferData, const throughputData &throughput)
     : BandwidthAlgorithm(videoData, playbackData, bufferData, throughput),
       m_windowSize(5),  // 5 segment for smoothing
-      m_highestRepIndex(videoData.averageBitrate[0].size() - 1) {
+      m_segments(0),
+      m_highestRepIndex(videoData.ladders[0].GetHighestRepIndex()) {
   NS_LOG_INFO(this);
   NS_ASSERT_MSG(m_highestRepIndex >= 0,
                 "The highest quality representation index should be >= 0");
 }
 
+void BandwidthWHarmonicAlgorithm::DoInitialize(void) {
+  m_window.SetCapacity(m_windowSize);
+  m_segments = 0;
+  BandwidthAlgorithm::DoInitialize();
+}
+
 bandwidthAlgoReply BandwidthWHarmonicAlgorithm::BandwidthAlgo(
     const int64_t segmentCounter, const int64_t clientId) {
   bandwidthAlgoReply answer;
   answer.bandwidthAlgoIndex = 3;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
   double bandwidthEstimate = 0.0;
 
   if (segmentCounter != 0) {
-    int64_t sumThroughput = 0;  // bit
-    double transmissionTime = 0.0;
-    if (segmentCounter < m_windowSize)  // 5
-    {
-      for (int64_t i = 0; i != segmentCounter; i++) {
-        sumThroughput +=
-            8 * m_videoData.segmentSize.at(m_videoData.userInfo.at(i))
-                    .at(m_videoData.repIndex.at(i))
-                    .at(i);
-        transmissionTime += (m_throughput.transmissionEnd.at(i) -
-                             m_throughput.transmissionStart.at(i));
-      }
-      bandwidthEstimate =
-          (double)sumThroughput * 1000000.0 / (transmissionTime);
-      answer.decisionCase = 1;
-    } else {
-      for (int64_t i = segmentCounter - m_windowSize; i != segmentCounter;
-           i++) {
-        sumThroughput +=
-            8 * m_videoData.segmentSize.at(m_videoData.userInfo.at(i))
-                    .at(m_videoData.repIndex.at(i))
-                    .at(i);
-        transmissionTime += (m_throughput.transmissionEnd.at(i) -
-                             m_throughput.transmissionStart.at(i));
-      }
-      bandwidthEstimate = (double)sumThroughput * 1000000.0 / transmissionTime;
-      answer.decisionCase = 2;
+    // weighting the throughput by the download time makes the mean the bits
+    // of the window over its download time
+    for (; m_segments < segmentCounter; m_segments++) {
+      weightedSample sample;
+      sample.weight = m_throughput.transmissionEnd.at(m_segments) -
+                      m_throughput.transmissionStart.at(m_segments);
+      sample.value =
+          sample.weight > 0 ? GetSegmentThroughput(m_segments) : 0.0;
+      m_window.Push(sample);
     }
+    bandwidthEstimate = m_window.Get();
+    answer.decisionCase = m_window.GetSize() < m_windowSize ? 1 : 2;
     answer.bandwidthEstimate = bandwidthEstimate;
   } else {
     answer.bandwidthEstimate = bandwidthEstimate;
@@ -1,11 +1,18 @@
 #ifndef BANDWIDTHWHARMONIC_ALGORITHM_H
 #define BANDWIDTHWHARMONIC_ALGORITHM_H
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-window.h"
 
 namespace ns3 {
 
 class BandwidthWHarmonicAlgorithm : public BandwidthAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthWHarmonicAlgorithm(const videoData &videoData,
                               const playbackData &playbackData,
                               const bufferData &bufferData,
@@ -14,8 +21,17 @@ public:
   bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
                                    const int64_t clientId);
 
+protected:
+  /**
+   * \brief Size the window.
+   */
+  virtual void DoInitialize(void);
+
 private:
-  const int64_t m_windowSize;
+  int64_t m_windowSize;
+  SlidingWindow<WeightedMean> m_window; //!< throughput of the last segments
+                                        //!< weighted by their download time
+  int64_t m_segments;                   //!< segments pushed into the window
   const int64_t m_highestRepIndex;
 };
 
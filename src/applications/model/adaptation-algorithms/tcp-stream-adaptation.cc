@@ -23,11 +23,74 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("AdaptationAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(AdaptationAlgorithm);
 
+TypeId AdaptationAlgorithm::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::AdaptationAlgorithm")
+                          .SetParent<Object>()
+                          .SetGroupName("Applications");
+  return tid;
+}
+
 AdaptationAlgorithm::AdaptationAlgorithm(const videoData &videoData,
                                          const playbackData &playbackData,
                                          const bufferData &bufferData,
                                          const throughputData &throughput)
     : m_videoData(videoData), m_bufferData(bufferData),
-      m_throughput(throughput), m_playbackData(playbackData) {}
+      m_throughput(throughput), m_playbackData(playbackData),
+      m_maxBitrate(0), m_bitrateCapped(false) {}
+
+void AdaptationAlgorithm::SetMaxRepIndex(
+    const std::vector<int64_t> &maxRepIndex) {
+  NS_ASSERT_MSG(maxRepIndex.empty() ||
+                    maxRepIndex.size() == m_videoData.ladders.size(),
+                "The cap needs a representation index for every viewpoint");
+  m_maxRepIndex = maxRepIndex;
+  m_capped.assign(maxRepIndex.size(), false);
+}
+
+bool AdaptationAlgorithm::IsCapped(int64_t viewpoint) const {
+  return !m_capped.empty() && m_capped.at(viewpoint);
+}
+
+void AdaptationAlgorithm::SetMaxBitrate(double maxBitrate) {
+  m_maxBitrate = maxBitrate;
+  m_bitrateCapped = false;
+}
+
+bool AdaptationAlgorithm::IsBitrateCapped(void) const {
+  return m_bitrateCapped;
+}
+
+bool AdaptationAlgorithm::RequestsAllViewpoints(void) const {
+  return false;
+}
+
+int64_t AdaptationAlgorithm::GetMaxRepIndex(int64_t viewpoint) const {
+  const int64_t highest =
+      m_videoData.ladders.at(viewpoint).GetHighestRepIndex();
+  if (m_maxRepIndex.empty()) {
+    return highest;
+  }
+  return std::max<int64_t>(std::min(m_maxRepIndex.at(viewpoint), highest), 0);
+}
+
+int64_t AdaptationAlgorithm::CapRepIndex(int64_t repIndex,
+                                         int64_t viewpoint) {
+  const int64_t maxRepIndex = GetMaxRepIndex(viewpoint);
+  if (repIndex <= maxRepIndex) {
+    return repIndex;
+  }
+  if (!m_capped.empty()) {
+    m_capped.at(viewpoint) = true;
+  }
+  return maxRepIndex;
+}
+
+double AdaptationAlgorithm::CapBitrate(double bitrate) {
+  if (m_maxBitrate <= 0 || bitrate <= m_maxBitrate) {
+    return bitrate;
+  }
+  m_bitrateCapped = true;
+  return m_maxBitrate;
+}
 
 } // namespace ns3
\ No newline at end of file
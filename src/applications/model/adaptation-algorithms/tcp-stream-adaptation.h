@@ -22,6 +22,8 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "tcp-stream-algorithm-registry.h"
+#include "tcp-stream-clock.h"
 #include "tcp-stream-interface.h"
 #include <algorithm>
 #include <assert.h>
@@ -34,8 +36,20 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup tcpStream
+ * \brief Base class of the adaptation algorithms, which choose the representation of the next segment.
+ *
+ * Subclasses are created through AlgorithmRegistry<AdaptationAlgorithm>.
+ */
 class AdaptationAlgorithm : public Object {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   AdaptationAlgorithm(const videoData &videoData,
                       const playbackData &playbackData,
                       const bufferData &bufferData,
@@ -45,11 +59,68 @@ public:
                                     const int64_t clientId,
                                     int64_t bandwidth) = 0;
 
+  /**
+   * \brief Cap the representations the next decision may choose.
+   * \param maxRepIndex the highest representation index of every viewpoint,
+   * empty for no cap
+   */
+  void SetMaxRepIndex(const std::vector<int64_t> &maxRepIndex);
+
+  /**
+   * \return whether the cap lowered the last decision for the viewpoint
+   */
+  bool IsCapped(int64_t viewpoint) const;
+
+  /**
+   * \brief Cap the sum of the bitrates of the representations the next
+   * decision requests for one segment, for algorithms which request every
+   * viewpoint.
+   * \param maxBitrate the cap in bps, 0 for no cap
+   */
+  void SetMaxBitrate(double maxBitrate);
+
+  /**
+   * \return whether the cap on the sum of the bitrates lowered the last
+   * decision
+   */
+  bool IsBitrateCapped(void) const;
+
+  /**
+   * \return true if the decisions request every viewpoint of a segment, in
+   * algorithmReply::faceRepIndex, false if only the one the user looks at
+   */
+  virtual bool RequestsAllViewpoints(void) const;
+
 protected:
+  /**
+   * \return the highest representation index the decision may choose for
+   * the viewpoint
+   */
+  int64_t GetMaxRepIndex(int64_t viewpoint) const;
+
+  /**
+   * \brief Lower a representation the algorithm would choose to the cap.
+   * \return the representation, at most GetMaxRepIndex(viewpoint)
+   */
+  int64_t CapRepIndex(int64_t repIndex, int64_t viewpoint);
+
+  /**
+   * \brief Lower the bitrate the representations of a segment may sum to,
+   * to the cap.
+   * \return the bitrate in bps, at most the cap of SetMaxBitrate
+   */
+  double CapBitrate(double bitrate);
+
   const videoData &m_videoData;
   const bufferData &m_bufferData;
   const throughputData &m_throughput;
   const playbackData &m_playbackData;
+
+private:
+  std::vector<int64_t> m_maxRepIndex; //!< the cap of every viewpoint
+  std::vector<bool> m_capped; //!< whether the cap lowered the last decision
+  double m_maxBitrate;  //!< cap of the sum of the bitrates, 0 for none
+  bool m_bitrateCapped; //!< whether it lowered the last decision
 };
 
 } // namespace ns3
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_ALGORITHM_REGISTRY_H
+#define TCP_STREAM_ALGORITHM_REGISTRY_H
+
+#include "ns3/object.h"
+#include "tcp-stream-interface.h"
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Registry of the algorithms of one kind, keyed by TypeId.
+ *
+ * The adaptation algorithms, bandwidth estimators and viewport predictors are
+ * bound to the data of their client by reference when they are constructed,
+ * so they cannot be created by an ObjectFactory. Instead every algorithm
+ * registers a creator with TCP_STREAM_REGISTER_ALGORITHM next to its
+ * NS_OBJECT_ENSURE_REGISTERED, and the client creates the algorithm from the
+ * TypeId it was configured with. The attributes of the algorithm are set from
+ * their defaults, so they can be changed with Config::SetDefault or on the
+ * command line like those of any other object.
+ *
+ * \tparam Base the kind of algorithm: AdaptationAlgorithm, BandwidthAlgorithm
+ * or UserinfoAlgorithm
+ */
+template <typename Base> class AlgorithmRegistry {
+public:
+  typedef Ptr<Base> (*Creator)(const videoData &videoData,
+                               const playbackData &playbackData,
+                               const bufferData &bufferData,
+                               const throughputData &throughput);
+
+  /**
+   * \brief Make an algorithm available under its TypeId.
+   */
+  static void Register(TypeId tid, Creator creator) {
+    GetCreators()[tid.GetUid()] = std::make_pair(tid, creator);
+  }
+
+  /**
+   * \brief Create the algorithm registered under tid, bound to the data of a
+   * client.
+   * \return the algorithm, or 0 if no algorithm of this kind is registered
+   * under tid
+   */
+  static Ptr<Base> Create(TypeId tid, const videoData &videoData,
+                          const playbackData &playbackData,
+                          const bufferData &bufferData,
+                          const throughputData &throughput) {
+    typename std::map<uint16_t, std::pair<TypeId, Creator>>::const_iterator
+        it = GetCreators().find(tid.GetUid());
+    if (it == GetCreators().end()) {
+      return 0;
+    }
+    return it->second.second(videoData, playbackData, bufferData, throughput);
+  }
+
+  /**
+   * \return the TypeIds of all registered algorithms of this kind
+   */
+  static std::vector<TypeId> GetRegistered(void) {
+    std::vector<TypeId> registered;
+    for (typename std::map<uint16_t, std::pair<TypeId, Creator>>::
+             const_iterator it = GetCreators().begin();
+         it != GetCreators().end(); ++it) {
+      registered.push_back(it->second.first);
+    }
+    return registered;
+  }
+
+private:
+  /**
+   * The map lives in a function, so registering from static initializers of
+   * other translation units does not depend on their order.
+   */
+  static std::map<uint16_t, std::pair<TypeId, Creator>> &GetCreators(void) {
+    static std::map<uint16_t, std::pair<TypeId, Creator>> creators;
+    return creators;
+  }
+};
+
+/**
+ * \brief Construct a T bound to the data of a client and set its attributes
+ * from their defaults.
+ */
+template <typename Base, typename T>
+Ptr<Base> CreateAlgorithm(const videoData &videoData,
+                          const playbackData &playbackData,
+                          const bufferData &bufferData,
+                          const throughputData &throughput) {
+  Ptr<T> algorithm = CompleteConstruct(
+      new T(videoData, playbackData, bufferData, throughput));
+  return algorithm;
+}
+
+} // namespace ns3
+
+/**
+ * \brief Register the algorithm type, derived from base, in the
+ * AlgorithmRegistry of base.
+ */
+#define TCP_STREAM_REGISTER_ALGORITHM(base, type)                             \
+  static struct type##RegistryEntry {                                         \
+    type##RegistryEntry() {                                                   \
+      AlgorithmRegistry<base>::Register(type::GetTypeId(),                    \
+                                        &CreateAlgorithm<base, type>);        \
+    }                                                                         \
+  } g_##type##RegistryEntry
+
+#endif /* TCP_STREAM_ALGORITHM_REGISTRY_H */
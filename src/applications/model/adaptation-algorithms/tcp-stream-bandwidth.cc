@@ -5,6 +5,13 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("BandwidthAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(BandwidthAlgorithm);
 
+TypeId BandwidthAlgorithm::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::BandwidthAlgorithm")
+                          .SetParent<Object>()
+                          .SetGroupName("Applications");
+  return tid;
+}
+
 BandwidthAlgorithm::BandwidthAlgorithm(const videoData &videoData,
                                        const playbackData &playbackData,
                                        const bufferData &bufferData,
@@ -12,4 +19,21 @@ BandwidthAlgorithm::BandwidthAlgorithm(const videoData &videoData,
     : m_videoData(videoData), m_bufferData(bufferData),
       m_throughput(throughput), m_playbackData(playbackData) {}
 
+void BandwidthAlgorithm::PacketReceived(int64_t time, uint32_t bytes) {}
+
+void BandwidthAlgorithm::CrossLayerEstimate(double bandwidth) {}
+
+double BandwidthAlgorithm::GetSegmentThroughput(int64_t segment) const {
+  int64_t downloadTime = m_throughput.transmissionEnd.at(segment) -
+                         m_throughput.transmissionStart.at(segment);
+  // nothing is received during a handover, which says nothing about the rate
+  // of either cell
+  if (segment < (int64_t)m_throughput.handoverTime.size() &&
+      m_throughput.handoverTime.at(segment) < downloadTime) {
+    downloadTime -= m_throughput.handoverTime.at(segment);
+  }
+  return 8.0 * m_throughput.bytesReceived.at(segment) /
+         (downloadTime / 1000000.0);
+}
+
 } // namespace ns3
\ No newline at end of file
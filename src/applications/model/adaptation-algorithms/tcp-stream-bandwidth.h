@@ -4,6 +4,8 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "tcp-stream-algorithm-registry.h"
+#include "tcp-stream-clock.h"
 #include "tcp-stream-interface.h"
 #include <algorithm>
 #include <assert.h>
@@ -15,9 +17,20 @@
 #include <stdint.h>
 
 namespace ns3 {
-// todo
+/**
+ * \ingroup tcpStream
+ * \brief Base class of the bandwidth estimators.
+ *
+ * Subclasses are created through AlgorithmRegistry<BandwidthAlgorithm>.
+ */
 class BandwidthAlgorithm : public Object {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   BandwidthAlgorithm(const videoData &videoData,
                      const playbackData &playbackData,
                      const bufferData &bufferData,
@@ -26,7 +39,30 @@ public:
   virtual bandwidthAlgoReply BandwidthAlgo(const int64_t segmentCounter,
                                            const int64_t clientId) = 0;
 
+  /**
+   * \brief Called by the client for every packet it receives, for
+   * estimators which sample faster than once per segment. Does nothing by
+   * default.
+   * \param time the arrival time in microseconds
+   * \param bytes the size of the packet
+   */
+  virtual void PacketReceived(int64_t time, uint32_t bytes);
+
+  /**
+   * \brief Called by the client before every decision with the rate the
+   * cross-layer estimator derived from the PHY reception statistics, for
+   * estimators which combine it with their own. Does nothing by default.
+   * \param bandwidth the cross-layer estimate in bps
+   */
+  virtual void CrossLayerEstimate(double bandwidth);
+
 protected:
+  /**
+   * \return the throughput in bps of the download of a segment, over the
+   * time the UE was not in a handover
+   */
+  double GetSegmentThroughput(int64_t segment) const;
+
   const videoData &m_videoData;
   const bufferData &m_bufferData;
   const throughputData &m_throughput;
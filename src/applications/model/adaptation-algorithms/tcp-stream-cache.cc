@@ -0,0 +1,376 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-cache.h"
+#include "ns3/address.h"
+#include "ns3/enum.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("TcpStreamCacheApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(TcpStreamCache);
+
+TypeId TcpStreamCache::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::TcpStreamCache")
+          .SetParent<TcpStreamServer>()
+          .SetGroupName("Applications")
+          .AddConstructor<TcpStreamCache>()
+          .AddAttribute("OriginAddress",
+                        "The Address of the origin server the segments are "
+                        "fetched from",
+                        AddressValue(),
+                        MakeAddressAccessor(&TcpStreamCache::m_originAddress),
+                        MakeAddressChecker())
+          .AddAttribute("OriginPort", "The port of the origin server",
+                        UintegerValue(80),
+                        MakeUintegerAccessor(&TcpStreamCache::m_originPort),
+                        MakeUintegerChecker<uint16_t>())
+          .AddAttribute("CacheSize",
+                        "The number of bytes of segments the cache can hold",
+                        UintegerValue(100000000),
+                        MakeUintegerAccessor(&TcpStreamCache::m_cacheSize),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute(
+              "ReplacementPolicy",
+              "Which segment to evict when the cache is full: lru, lfu or "
+              "popularity (greedy dual size frequency over the requests per "
+              "viewpoint and segment)",
+              EnumValue(TcpStreamCache::LRU),
+              MakeEnumAccessor(&TcpStreamCache::m_policy),
+              MakeEnumChecker(TcpStreamCache::LRU, "lru", TcpStreamCache::LFU,
+                              "lfu", TcpStreamCache::POPULARITY,
+                              "popularity"));
+  return tid;
+}
+
+TcpStreamCacheFetch::TcpStreamCacheFetch(TcpStreamCache *cache,
+                                         Ptr<Socket> socket)
+    : m_cache(cache), m_socket(socket), m_connected(false), m_busy(false),
+      m_bytes(0), m_deadline(-1), m_received(0), m_waiting(-1) {
+  m_key.viewpoint = -1;
+  m_key.rep = -1;
+  m_key.segment = -1;
+}
+
+void TcpStreamCacheFetch::ConnectionSucceeded(Ptr<Socket> socket) {
+  m_connected = true;
+  if (m_busy) {
+    m_cache->SendFetchRequest(this);
+  }
+}
+
+void TcpStreamCacheFetch::ConnectionFailed(Ptr<Socket> socket) {
+  NS_LOG_ERROR("Connection to the origin server failed");
+}
+
+void TcpStreamCacheFetch::HandleRead(Ptr<Socket> socket) {
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv())) {
+    m_received += packet->GetSize();
+    m_cache->m_stats.bytesFromOrigin += packet->GetSize();
+    if (m_busy && m_received == m_bytes) {
+      m_cache->FetchFinished(this);
+    }
+  }
+}
+
+TcpStreamCache::TcpStreamCache()
+    : m_originPort(80), m_cacheSize(0), m_policy(LRU), m_usedBytes(0),
+      m_accessCounter(0), m_orderSequence(0), m_inflation(0) {
+  NS_LOG_FUNCTION(this);
+  m_stats.hits = 0;
+  m_stats.misses = 0;
+  m_stats.coalesced = 0;
+  m_stats.bytesFromCache = 0;
+  m_stats.bytesFromOrigin = 0;
+  m_stats.evictions = 0;
+}
+
+TcpStreamCache::~TcpStreamCache() { NS_LOG_FUNCTION(this); }
+
+void TcpStreamCache::DoDispose(void) {
+  NS_LOG_FUNCTION(this);
+  for (uint32_t i = 0; i < m_fetches.size(); i++) {
+    m_fetches.at(i)->m_socket->SetConnectCallback(
+        MakeNullCallback<void, Ptr<Socket>>(),
+        MakeNullCallback<void, Ptr<Socket>>());
+    m_fetches.at(i)->m_socket->SetRecvCallback(
+        MakeNullCallback<void, Ptr<Socket>>());
+    m_fetches.at(i)->m_socket = 0;
+  }
+  m_fetches.clear();
+  TcpStreamServer::DoDispose();
+}
+
+void TcpStreamCache::StopApplication(void) {
+  NS_LOG_FUNCTION(this);
+  std::ostringstream stats;
+  PrintCacheStats(stats);
+  NS_LOG_INFO(stats.str());
+  for (uint32_t i = 0; i < m_fetches.size(); i++) {
+    m_fetches.at(i)->m_socket->Close();
+  }
+  TcpStreamServer::StopApplication();
+}
+
+cacheStats TcpStreamCache::GetCacheStats(void) const { return m_stats; }
+
+void TcpStreamCache::PrintCacheStats(std::ostream &os) const {
+  uint32_t requests = m_stats.hits + m_stats.misses + m_stats.coalesced;
+  os << "Cache hits " << m_stats.hits << ", misses " << m_stats.misses
+     << ", coalesced " << m_stats.coalesced << ", hit ratio " << std::fixed
+     << std::setprecision(3)
+     << (requests > 0 ? (m_stats.hits + m_stats.coalesced) / (double)requests
+                      : 0.0)
+     << ", origin bytes saved " << m_stats.bytesFromCache
+     << ", origin bytes fetched " << m_stats.bytesFromOrigin << ", evictions "
+     << m_stats.evictions << ", cached bytes " << m_usedBytes << "\n";
+}
+
+void TcpStreamCache::PrepareSegment(TcpStreamServerConnection *connection) {
+  NS_LOG_FUNCTION(this);
+  callbackData &data = connection->m_data;
+  const segmentKey &key = data.key;
+  m_accessCounter++;
+  if (key.segment < 0) {
+    // requests of clients that do not name the segment are only forwarded
+    m_stats.misses++;
+    data.ready = false;
+    Fetch(key, data.packetSizeToReturn, data.deadline, connection->m_index);
+    return;
+  }
+  m_popularity[std::make_pair(key.viewpoint, key.segment)]++;
+  if (m_policy == POPULARITY) {
+    UpdatePopularity(key);
+  }
+
+  std::map<segmentKey, cacheEntry>::iterator entry = m_entries.find(key);
+  if (entry != m_entries.end() &&
+      entry->second.bytes == data.packetSizeToReturn) {
+    m_stats.hits++;
+    m_stats.bytesFromCache += data.packetSizeToReturn;
+    if (m_policy == POPULARITY) {
+      // UpdatePopularity moved it already
+      entry->second.frequency++;
+    } else {
+      Touch(key, entry->second);
+    }
+    return;
+  }
+
+  data.ready = false;
+  std::map<segmentKey, std::vector<uint32_t>>::iterator pending =
+      m_pending.find(key);
+  if (pending != m_pending.end()) {
+    m_stats.coalesced++;
+    m_stats.bytesFromCache += data.packetSizeToReturn;
+    pending->second.push_back(connection->m_index);
+    return;
+  }
+  m_stats.misses++;
+  m_pending[key].push_back(connection->m_index);
+  Fetch(key, data.packetSizeToReturn, data.deadline, -1);
+}
+
+void TcpStreamCache::Fetch(const segmentKey &key, int64_t bytes,
+                           int64_t deadline, int64_t waiting) {
+  NS_LOG_FUNCTION(this);
+  TcpStreamCacheFetch *fetch = 0;
+  for (uint32_t i = 0; i < m_fetches.size(); i++) {
+    if (!m_fetches.at(i)->m_busy) {
+      fetch = PeekPointer(m_fetches.at(i));
+      break;
+    }
+  }
+  if (fetch == 0) {
+    TypeId tid = TypeId::LookupByName("ns3::TcpSocketFactory");
+    Ptr<Socket> socket = Socket::CreateSocket(GetNode(), tid);
+    Ptr<TcpStreamCacheFetch> newFetch =
+        Create<TcpStreamCacheFetch>(this, socket);
+    m_fetches.push_back(newFetch);
+    fetch = PeekPointer(newFetch);
+    // the fetches are owned by m_fetches, so the callbacks can be bound to
+    // the plain pointer
+    socket->SetConnectCallback(
+        MakeCallback(&TcpStreamCacheFetch::ConnectionSucceeded, fetch),
+        MakeCallback(&TcpStreamCacheFetch::ConnectionFailed, fetch));
+    socket->SetRecvCallback(MakeCallback(&TcpStreamCacheFetch::HandleRead, fetch));
+    if (Ipv4Address::IsMatchingType(m_originAddress) == true) {
+      socket->Connect(InetSocketAddress(
+          Ipv4Address::ConvertFrom(m_originAddress), m_originPort));
+    } else if (Ipv6Address::IsMatchingType(m_originAddress) == true) {
+      socket->Connect(Inet6SocketAddress(
+          Ipv6Address::ConvertFrom(m_originAddress), m_originPort));
+    }
+  }
+  fetch->m_busy = true;
+  fetch->m_key = key;
+  fetch->m_bytes = bytes;
+  fetch->m_deadline = deadline;
+  fetch->m_received = 0;
+  fetch->m_waiting = waiting;
+  if (fetch->m_connected) {
+    SendFetchRequest(fetch);
+  }
+}
+
+void TcpStreamCache::SendFetchRequest(TcpStreamCacheFetch *fetch) {
+  std::ostringstream request;
+  request << fetch->m_bytes << " " << fetch->m_deadline << " 1 "
+          << fetch->m_key.viewpoint << " " << fetch->m_key.rep << " "
+          << fetch->m_key.segment;
+  std::string message = request.str();
+  fetch->m_socket->Send(
+      Create<Packet>((const uint8_t *)message.c_str(), message.size() + 1));
+}
+
+void TcpStreamCache::FetchFinished(TcpStreamCacheFetch *fetch) {
+  NS_LOG_FUNCTION(this);
+  segmentKey key = fetch->m_key;
+  int64_t bytes = fetch->m_bytes;
+  fetch->m_busy = false;
+  fetch->m_received = 0;
+
+  std::vector<uint32_t> waiting;
+  if (fetch->m_waiting >= 0) {
+    waiting.push_back(fetch->m_waiting);
+    fetch->m_waiting = -1;
+  } else {
+    Insert(key, bytes);
+    std::map<segmentKey, std::vector<uint32_t>>::iterator pending =
+        m_pending.find(key);
+    if (pending == m_pending.end()) {
+      return;
+    }
+    waiting.swap(pending->second);
+    m_pending.erase(pending);
+  }
+  for (uint32_t i = 0; i < waiting.size(); i++) {
+    TcpStreamServerConnection *connection =
+        PeekPointer(m_connections.at(waiting.at(i)));
+    callbackData &data = connection->m_data;
+    // the client may have given up on the segment in the meantime
+    if (data.send && !data.ready && !(data.key < key) && !(key < data.key)) {
+      data.ready = true;
+      Transmit(connection);
+    }
+  }
+}
+
+void TcpStreamCache::Insert(const segmentKey &key, int64_t bytes) {
+  std::map<segmentKey, cacheEntry>::iterator cached = m_entries.find(key);
+  if (cached != m_entries.end()) {
+    if (cached->second.bytes == bytes) {
+      return;
+    }
+    // the origin has another size for the segment now
+    Erase(cached);
+  }
+  if (bytes <= 0 || (uint64_t)bytes > m_cacheSize) {
+    return;
+  }
+  while (m_usedBytes + bytes > m_cacheSize && !m_evictionOrder.empty()) {
+    std::map<std::pair<double, uint64_t>, segmentKey>::iterator victim =
+        m_evictionOrder.begin();
+    if (m_policy == POPULARITY) {
+      m_inflation = victim->first.first;
+    }
+    Erase(m_entries.find(victim->second));
+    m_stats.evictions++;
+  }
+  cacheEntry entry;
+  entry.bytes = bytes;
+  entry.frequency = 1;
+  entry.order = GetOrder(key, entry);
+  m_entries[key] = entry;
+  m_evictionOrder[entry.order] = key;
+  m_cachedReps[std::make_pair(key.viewpoint, key.segment)].push_back(key.rep);
+  m_usedBytes += bytes;
+}
+
+void TcpStreamCache::Erase(std::map<segmentKey, cacheEntry>::iterator entry) {
+  const segmentKey &key = entry->first;
+  std::map<std::pair<int64_t, int64_t>, std::vector<int64_t>>::iterator reps =
+      m_cachedReps.find(std::make_pair(key.viewpoint, key.segment));
+  reps->second.erase(
+      std::find(reps->second.begin(), reps->second.end(), key.rep));
+  if (reps->second.empty()) {
+    m_cachedReps.erase(reps);
+  }
+  m_usedBytes -= entry->second.bytes;
+  m_evictionOrder.erase(entry->second.order);
+  m_entries.erase(entry);
+}
+
+void TcpStreamCache::Touch(const segmentKey &key, cacheEntry &entry) {
+  m_evictionOrder.erase(entry.order);
+  entry.frequency++;
+  entry.order = GetOrder(key, entry);
+  m_evictionOrder[entry.order] = key;
+}
+
+void TcpStreamCache::UpdatePopularity(const segmentKey &key) {
+  std::map<std::pair<int64_t, int64_t>, std::vector<int64_t>>::const_iterator
+      reps = m_cachedReps.find(std::make_pair(key.viewpoint, key.segment));
+  if (reps == m_cachedReps.end()) {
+    return;
+  }
+  for (uint32_t i = 0; i < reps->second.size(); i++) {
+    segmentKey cachedKey = key;
+    cachedKey.rep = reps->second.at(i);
+    cacheEntry &entry = m_entries.find(cachedKey)->second;
+    m_evictionOrder.erase(entry.order);
+    entry.order = GetOrder(cachedKey, entry);
+    m_evictionOrder[entry.order] = cachedKey;
+  }
+}
+
+std::pair<double, uint64_t> TcpStreamCache::GetOrder(const segmentKey &key,
+                                                     const cacheEntry &entry) {
+  // the sequence number keeps the keys unique and breaks ties by recency
+  m_orderSequence++;
+  if (m_policy == LFU) {
+    return std::make_pair((double)entry.frequency, m_orderSequence);
+  } else if (m_policy == POPULARITY) {
+    std::map<std::pair<int64_t, int64_t>, uint32_t>::const_iterator popularity =
+        m_popularity.find(std::make_pair(key.viewpoint, key.segment));
+    double frequency =
+        popularity != m_popularity.end() ? popularity->second : 1;
+    // frequency per megabyte, so one large segment does not displace many
+    // small ones of the same popularity
+    return std::make_pair(m_inflation + frequency * 1000000.0 / entry.bytes,
+                          m_orderSequence);
+  }
+  return std::make_pair((double)m_orderSequence, m_orderSequence);
+}
+
+} // namespace ns3
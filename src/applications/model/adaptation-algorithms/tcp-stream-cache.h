@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_CACHE_H
+#define TCP_STREAM_CACHE_H
+
+#include "tcp-stream-server.h"
+#include <map>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief statistics of a TcpStreamCache.
+ */
+struct cacheStats {
+  uint32_t hits;      //!< requests served from the cache
+  uint32_t misses;    //!< requests which had to be fetched from the origin
+  uint32_t coalesced; //!< requests for a segment which was already being
+                      //!< fetched from the origin for another request
+  uint64_t bytesFromCache;  //!< bytes of the hits and coalesced requests, i.e.
+                            //!< origin bytes saved
+  uint64_t bytesFromOrigin; //!< bytes fetched from the origin
+  uint32_t evictions;       //!< segments evicted to stay within the budget
+};
+
+class TcpStreamCache;
+
+/**
+ * \ingroup tcpStream
+ * \brief Context of one connection from the cache to the origin server.
+ *
+ * Every connection fetches one segment at a time, the cache opens another one
+ * when all of them are busy.
+ */
+class TcpStreamCacheFetch : public SimpleRefCount<TcpStreamCacheFetch> {
+public:
+  TcpStreamCacheFetch(TcpStreamCache *cache, Ptr<Socket> socket);
+
+  void ConnectionSucceeded(Ptr<Socket> socket);
+  void ConnectionFailed(Ptr<Socket> socket);
+  void HandleRead(Ptr<Socket> socket);
+
+  TcpStreamCache *m_cache; //!< the cache this connection belongs to
+  Ptr<Socket> m_socket;    //!< socket connected to the origin
+  bool m_connected;        //!< true once the connection is established
+  bool m_busy;             //!< true while a segment is being fetched
+  segmentKey m_key;        //!< the segment being fetched
+  int64_t m_bytes;         //!< size of the segment being fetched
+  int64_t m_deadline;      //!< playback deadline of the segment
+  int64_t m_received;      //!< bytes of the segment received so far
+  int64_t m_waiting; //!< index of the connection waiting for a segment which
+                     //!< is not cached, -1 for cached segments
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief A Tcp Stream edge cache
+ *
+ * Serves clients like a TcpStreamServer, but only has the segments it has
+ * fetched from the origin server before. Segments are identified by
+ * (viewpoint, representation, segment) and kept as long as they fit into the
+ * byte budget CacheSize; when a new segment does not fit, segments are evicted
+ * according to the ReplacementPolicy:
+ * - lru evicts the least recently requested segment,
+ * - lfu evicts the least frequently requested segment,
+ * - popularity is greedy dual size frequency, where the frequency is the number
+ *   of requests for the viewpoint and segment index in any representation, so
+ *   viewpoints many clients look at stay in the cache while large, rarely
+ *   requested segments go first. A request for a viewpoint and segment index
+ *   sets the priority of every representation of it in the cache from the
+ *   current aging term; segments not requested since fall behind as the aging
+ *   term rises with every eviction.
+ *
+ * On a miss the request waits until the segment is completely fetched from
+ * the origin, then it is served from the cache. Requests for a segment that is
+ * already being fetched wait for the same fetch.
+ */
+class TcpStreamCache : public TcpStreamServer {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+  TcpStreamCache();
+  virtual ~TcpStreamCache();
+
+  /**
+   * \brief Which segment to evict when the byte budget is exhausted.
+   */
+  enum replacementPolicy {
+    LRU,       //!< least recently used
+    LFU,       //!< least frequently used
+    POPULARITY //!< greedy dual size frequency over viewpoint popularity
+  };
+
+  /**
+   * \brief Get the statistics of the cache.
+   */
+  cacheStats GetCacheStats(void) const;
+
+  /**
+   * \brief Write hit ratio, origin bytes saved and the other statistics of
+   * the cache to os.
+   */
+  void PrintCacheStats(std::ostream &os) const;
+
+protected:
+  virtual void DoDispose(void);
+  virtual void StopApplication(void);
+
+  /**
+   * \brief Serve the segment from the cache, or fetch it from the origin
+   * and hold the transmission back until it arrived.
+   */
+  virtual void PrepareSegment(TcpStreamServerConnection *connection);
+
+private:
+  friend class TcpStreamCacheFetch;
+
+  /**
+   * \brief a segment in the cache.
+   */
+  struct cacheEntry {
+    int64_t bytes;      //!< size of the segment
+    uint32_t frequency; //!< number of requests for the segment
+    std::pair<double, uint64_t> order; //!< position in m_evictionOrder
+  };
+
+  /**
+   * \brief Fetch a segment from the origin on an idle connection, or on a new
+   * one if all are busy.
+   *
+   * \param waiting index of the connection to transmit the segment to when it
+   * is not cached, -1 to cache it and transmit it to the connections in
+   * m_pending
+   */
+  void Fetch(const segmentKey &key, int64_t bytes, int64_t deadline,
+             int64_t waiting);
+
+  /**
+   * \brief Send the request of fetch to the origin.
+   */
+  void SendFetchRequest(TcpStreamCacheFetch *fetch);
+
+  /**
+   * \brief Called when fetch has received the whole segment. The segment is
+   * added to the cache and the requests waiting for it are transmitted.
+   */
+  void FetchFinished(TcpStreamCacheFetch *fetch);
+
+  /**
+   * \brief Add a segment, evicting others until it fits into the budget.
+   * A cached segment of another size is replaced. Segments larger than the
+   * budget are not cached.
+   */
+  void Insert(const segmentKey &key, int64_t bytes);
+
+  /**
+   * \brief Remove the entry from the cache.
+   */
+  void Erase(std::map<segmentKey, cacheEntry>::iterator entry);
+
+  /**
+   * \brief Count a request for the entry and move it in the eviction order.
+   */
+  void Touch(const segmentKey &key, cacheEntry &entry);
+
+  /**
+   * \brief Move every cached representation of the viewpoint and segment
+   * index of key in the eviction order, after a request for one of them
+   * changed their popularity.
+   */
+  void UpdatePopularity(const segmentKey &key);
+
+  /**
+   * \brief The key of a segment in the eviction order, the smallest key is
+   * evicted first.
+   */
+  std::pair<double, uint64_t> GetOrder(const segmentKey &key,
+                                       const cacheEntry &entry);
+
+  Address m_originAddress;   //!< Address of the origin server
+  uint16_t m_originPort;     //!< Port of the origin server
+  uint64_t m_cacheSize;      //!< Byte budget of the cache
+  replacementPolicy m_policy; //!< Which segment to evict
+
+  std::map<segmentKey, cacheEntry> m_entries; //!< Segments in the cache
+  std::map<std::pair<double, uint64_t>, segmentKey>
+      m_evictionOrder; //!< Segments in the cache in the order of eviction
+  std::map<std::pair<int64_t, int64_t>, uint32_t>
+      m_popularity; //!< Number of requests per (viewpoint, segment index)
+  std::map<std::pair<int64_t, int64_t>, std::vector<int64_t>>
+      m_cachedReps; //!< Representations in the cache per (viewpoint, segment
+                    //!< index)
+  std::map<segmentKey, std::vector<uint32_t>>
+      m_pending; //!< Indices of the connections waiting for a segment being
+                 //!< fetched
+  std::vector<Ptr<TcpStreamCacheFetch>>
+      m_fetches;        //!< Connections to the origin
+  uint64_t m_usedBytes; //!< Bytes of the segments in the cache
+  uint64_t m_accessCounter; //!< Number of requests the cache has seen
+  uint64_t m_orderSequence; //!< Increases with every change of the eviction
+                            //!< order, orders the entries by recency
+  double m_inflation; //!< Priority of the last evicted segment, the aging
+                      //!< term of the popularity policy
+  cacheStats m_stats; //!< Statistics of the cache
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_CACHE_H */
@@ -31,34 +31,38 @@
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/global-value.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
+#include "ns3/integer.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
+#include "ns3/pointer.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "tcp-stream-profiler.h"
 #include "tcp-stream-server.h"
+#include "tcp-stream-tag.h"
 
 #ifndef CROSSLAYER
 #define CROSSLAYER 0
 #endif  // !1
 
 namespace ns3 {
-std::vector<std::pair<int64_t, int64_t>>
-    pause;  //<Pause BeginTime,Pause End Time>
 bool firstOfBwEstimate = true;
 bool secondOfBwEstimate = true;
 double bandwidthEstimate = 0.0;
 double alpha = 0.2;
-int64_t traceBegin = 0.0;
-static double lastEndTime = 0.0;
 template <typename T>
 std::string ToString(T val) {
   std::stringstream stream;
@@ -75,9 +79,7 @@ void TcpStreamClient::Controller(controllerEvent event) {
   if (state == initial) {
     RequestRepIndex();
     state = downloading;
-    Send(m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-             .at(m_currentRepIndex)
-             .at(m_segmentCounter));
+    RequestSegment();
     return;
   }
   if (state == downloading) {
@@ -87,9 +89,7 @@ void TcpStreamClient::Controller(controllerEvent event) {
 
       RequestRepIndex();
       state = downloadingPlaying;
-      Send(m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-               .at(m_currentRepIndex)
-               .at(m_segmentCounter));
+      RequestSegment();
     } else {
       state = playing;
     }
@@ -104,6 +104,7 @@ void TcpStreamClient::Controller(controllerEvent event) {
         RequestRepIndex();
       }
       if (m_bDelay > 0 && m_segmentCounter <= m_lastSegmentIndex) {
+        CancelPush();
         state = playing;
         controllerEvent ev = irdFinished;
         Simulator::Schedule(MicroSeconds(m_bDelay),
@@ -111,10 +112,7 @@ void TcpStreamClient::Controller(controllerEvent event) {
       } else if (m_segmentCounter == m_lastSegmentIndex) {
         state = playing;
       } else {
-        Send(m_videoData.segmentSize
-                 .at(m_videoData.userInfo.at(m_segmentCounter))
-                 .at(m_currentRepIndex)
-                 .at(m_segmentCounter));
+        RequestSegment();
       }
     } else if (event == playbackFinished) {
       if (!PlaybackHandle()) {
@@ -129,9 +127,7 @@ void TcpStreamClient::Controller(controllerEvent event) {
   } else if (state == playing) {
     if (event == irdFinished) {
       state = downloadingPlaying;
-      Send(m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-               .at(m_currentRepIndex)
-               .at(m_segmentCounter));
+      RequestSegment();
     } else if (event == playbackFinished &&
                m_currentPlaybackIndex < m_lastSegmentIndex) {
       PlaybackHandle();
@@ -148,6 +144,50 @@ void TcpStreamClient::Controller(controllerEvent event) {
   }
 }
 
+namespace {
+/**
+ * \brief The algorithm names the client has always accepted, each fixing an
+ * adaptation algorithm, bandwidth estimator and viewport predictor.
+ */
+struct algorithmPreset {
+  const char *name;
+  const char *adaptation;
+  const char *bandwidth;
+  const char *userinfo;
+};
+
+const algorithmPreset g_algorithmPresets[] = {
+    {"tobasco", "ns3::TobascoAlgorithm", "ns3::BandwidthAvgInTimeAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"tobascoL", "ns3::TobascoAlgorithm", "ns3::BandwidthLongAvgAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"tomato", "ns3::TomatoAlgorithm", "ns3::BandwidthWHarmonicAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"festive", "ns3::FestiveAlgorithm", "ns3::BandwidthHarmonicAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"sara", "ns3::SaraAlgorithm", "ns3::BandwidthWHarmonicAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"mpc", "ns3::MpcAlgorithm", "ns3::BandwidthHarmonicAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"bola", "ns3::BolaAlgorithm", "ns3::BandwidthAvgInTimeAlgorithm",
+     "ns3::UserPredictionAlgorithm"},
+    {"viewport", "ns3::ViewportAdaptationAlgorithm",
+     "ns3::BandwidthHarmonicAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"neural", "ns3::NeuralAdaptationAlgorithm",
+     "ns3::BandwidthHarmonicAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"constbitrateT", "ns3::constbitrateAlgorithm",
+     "ns3::BandwidthAvgInTimeAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"constbitrateL", "ns3::constbitrateAlgorithm",
+     "ns3::BandwidthLongAvgAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"constbitrateW", "ns3::constbitrateAlgorithm",
+     "ns3::BandwidthAvgInChunkAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"constbitrateH", "ns3::constbitrateAlgorithm",
+     "ns3::BandwidthHarmonicAlgorithm", "ns3::UserPredictionAlgorithm"},
+    {"constbitrateWH", "ns3::constbitrateAlgorithm",
+     "ns3::BandwidthWHarmonicAlgorithm", "ns3::UserPredictionAlgorithm"},
+};
+}  // namespace
+
 TypeId TcpStreamClient::GetTypeId(void) {
   static TypeId tid =
       TypeId("ns3::TcpStreamClient")
@@ -187,7 +227,115 @@ TypeId TcpStreamClient::GetTypeId(void) {
               "The ID of the this client object, for logging purposes",
               UintegerValue(0),
               MakeUintegerAccessor(&TcpStreamClient::m_clientId),
-              MakeUintegerChecker<uint32_t>());
+              MakeUintegerChecker<uint32_t>())
+          .AddAttribute(
+              "Imsi",
+              "IMSI of the UE the client runs on, whose transport blocks the "
+              "cross-layer bandwidth estimate is computed from",
+              UintegerValue(0),
+              MakeUintegerAccessor(&TcpStreamClient::m_imsi),
+              MakeUintegerChecker<uint64_t>())
+          .AddAttribute(
+              "SchedulingWeight",
+              "The weight this client asks for in the server's weighted-fair "
+              "send scheduler",
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&TcpStreamClient::m_schedulingWeight),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "ServerPush",
+              "Announce the next segment at the current representation with "
+              "every request, so the server can push it while the client "
+              "decides on it",
+              BooleanValue(false),
+              MakeBooleanAccessor(&TcpStreamClient::m_serverPush),
+              MakeBooleanChecker())
+          .AddAttribute(
+              "ServerSelection",
+              "How the server for every segment is chosen when there are "
+              "several: rtt takes the lowest response time, load the lowest "
+              "backlog the servers report, hash hashes viewpoint and segment "
+              "index onto a consistent hash ring.",
+              EnumValue(TcpStreamClient::RTT),
+              MakeEnumAccessor(&TcpStreamClient::m_serverSelection),
+              MakeEnumChecker(TcpStreamClient::RTT, "rtt",
+                              TcpStreamClient::LOAD, "load",
+                              TcpStreamClient::HASH, "hash"))
+          .AddAttribute(
+              "AdaptationAlgorithm",
+              "The adaptation algorithm, used when the algorithm passed to "
+              "Initialise is not a preset",
+              TypeIdValue(TobascoAlgorithm::GetTypeId()),
+              MakeTypeIdAccessor(&TcpStreamClient::m_adaptationTid),
+              MakeTypeIdChecker())
+          .AddAttribute(
+              "BandwidthAlgorithm",
+              "The bandwidth estimator, used when the algorithm passed to "
+              "Initialise is not a preset",
+              TypeIdValue(BandwidthAvgInTimeAlgorithm::GetTypeId()),
+              MakeTypeIdAccessor(&TcpStreamClient::m_bandwidthTid),
+              MakeTypeIdChecker())
+          .AddAttribute(
+              "UserinfoAlgorithm",
+              "The viewport predictor, used when the algorithm passed to "
+              "Initialise is not a preset",
+              TypeIdValue(UserPredictionAlgorithm::GetTypeId()),
+              MakeTypeIdAccessor(&TcpStreamClient::m_userinfoTid),
+              MakeTypeIdChecker())
+          .AddAttribute(
+              "SegmentSizeFiles",
+              "Comma separated segment size files, one per viewpoint, e.g. "
+              "the six faces of a cube map",
+              StringValue("SegmentSize.txt"),
+              MakeStringAccessor(&TcpStreamClient::m_segmentSizeFiles),
+              MakeStringChecker())
+          .AddAttribute(
+              "UserInfoFile", "File with the viewpoint of every segment",
+              StringValue("UserInfo.txt"),
+              MakeStringAccessor(&TcpStreamClient::m_userInfoFile),
+              MakeStringChecker())
+          .AddAttribute(
+              "Coordinator",
+              "The coordinator of the cell, which caps the bitrate of the "
+              "client so that the clients share the cell fairly; none if 0",
+              PointerValue(),
+              MakePointerAccessor(&TcpStreamClient::m_coordinator),
+              MakePointerChecker<CellCoordinator>())
+          .AddAttribute(
+              "HandoverHorizon",
+              "Build up the buffer when a handover of the UE is predicted "
+              "within this time in microseconds; never if 0",
+              IntegerValue(0),
+              MakeIntegerAccessor(&TcpStreamClient::m_handoverHorizon),
+              MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "HandoverHysteresis",
+              "Hysteresis in dB of the A3 handover of the eNBs, for the "
+              "handover prediction",
+              DoubleValue(3.0),
+              MakeDoubleAccessor(&TcpStreamClient::m_handoverHysteresis),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "HandoverTimeToTrigger",
+              "Time to trigger in microseconds of the A3 handover of the "
+              "eNBs, for the handover prediction",
+              IntegerValue(256000),
+              MakeIntegerAccessor(&TcpStreamClient::m_handoverTimeToTrigger),
+              MakeIntegerChecker<int64_t>(0))
+          .AddAttribute(
+              "HandoverPrebufferFactor",
+              "Share of the bandwidth estimate the bitrate is capped at while "
+              "a handover is predicted, so the buffer grows before it",
+              DoubleValue(0.5),
+              MakeDoubleAccessor(&TcpStreamClient::m_handoverPrebufferFactor),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "HandoverRebufferWindow",
+              "Buffer underruns from the start of a handover until this time "
+              "in microseconds after its end are logged as caused by it",
+              IntegerValue(2000000),
+              MakeIntegerAccessor(&TcpStreamClient::m_handoverRebufferWindow),
+              MakeIntegerChecker<int64_t>(0));
   return tid;
 }
 
@@ -205,6 +353,31 @@ TcpStreamClient::TcpStreamClient() {
   m_segmentsInBuffer = 0;
   m_bufferUnderrun = false;
   m_currentPlaybackIndex = 0;
+  m_schedulingWeight = 1.0;
+  m_serverPush = false;
+  m_pushSegment = -1;
+  m_pushRepIndex = 0;
+  m_pushBytesPending = 0;
+  m_pushFirstByte = 0;
+  m_pushAccepted = false;
+  m_pushedBytesUsed = 0;
+  m_pushedBytesDiscarded = 0;
+  m_server = 0;
+  m_connectedServers = 0;
+  m_serverSelection = RTT;
+  m_currentFace = 0;
+  m_faceBytesEnd = 0;
+  m_coordinated = false;
+  m_coordinatedViewpoint = -1;
+  m_handoverHorizon = 0;
+  m_handoverHysteresis = 3.0;
+  m_handoverTimeToTrigger = 256000;
+  m_handoverPrebufferFactor = 0.5;
+  m_handoverRebufferWindow = 2000000;
+  m_prebuffered = 0;
+  m_imsi = 0;
+  m_traceBegin = 0;
+  m_lastEndTime = 0;
 }
 
 // void TcpStreamClient::Initialise(std::string algorithm, uint16_t clientId)
@@ -224,109 +397,62 @@ void TcpStreamClient::Initialise(
   m_lastSegmentIndex = (int64_t)m_videoData.segmentSize[0][0].size() - 1;
   m_highestRepIndex = m_videoData.averageBitrate[0].size() - 1;
 
-  // tobasco, default, use BandwidthAvgInTime
-  if (algorithm == "tobasco") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthAvgInTimeAlgorithm(m_videoData, m_playbackData,
-                                                    m_bufferData, m_throughput);
-    algo = new TobascoAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                m_throughput);
-  } else if (algorithm == "tobascoL") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-
-    bandwidthAlgo = new BandwidthLongAvgAlgorithm(m_videoData, m_playbackData,
-                                                  m_bufferData, m_throughput);
-
-    algo = new TobascoAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                m_throughput);
-  } else if (algorithm == "tomato") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    // harmonic
-    bandwidthAlgo = new BandwidthWHarmonicAlgorithm(m_videoData, m_playbackData,
-                                                    m_bufferData, m_throughput);
-    // designed by tian
-    algo = new TomatoAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                               m_throughput);
-  } else if (algorithm == "festive") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    // harmonic
-    bandwidthAlgo = new BandwidthHarmonicAlgorithm(m_videoData, m_playbackData,
-                                                   m_bufferData, m_throughput);
-    // festive from paper
-    algo = new FestiveAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                m_throughput);
-  } else if (algorithm == "sara") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    // weighted harmonic
-    bandwidthAlgo = new BandwidthWHarmonicAlgorithm(m_videoData, m_playbackData,
-                                                    m_bufferData, m_throughput);
-    // sara from paper
-    algo = new SaraAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                             m_throughput);
-  } else if (algorithm == "constbitrateT") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthAvgInTimeAlgorithm(m_videoData, m_playbackData,
-                                                    m_bufferData, m_throughput);
-    algo = new constbitrateAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                     m_throughput);
-  } else if (algorithm == "constbitrateL") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthLongAvgAlgorithm(m_videoData, m_playbackData,
-                                                  m_bufferData, m_throughput);
-    algo = new constbitrateAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                     m_throughput);
-  } else if (algorithm == "constbitrateW") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthAvgInChunkAlgorithm(
-        m_videoData, m_playbackData, m_bufferData, m_throughput);
-    algo = new constbitrateAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                     m_throughput);
-  } else if (algorithm == "constbitrateH") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthHarmonicAlgorithm(m_videoData, m_playbackData,
-                                                   m_bufferData, m_throughput);
-    algo = new constbitrateAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                     m_throughput);
-  } else if (algorithm == "constbitrateWH") {
-    userinfoAlgo = new UserPredictionAlgorithm(m_videoData, m_playbackData,
-                                               m_bufferData, m_throughput);
-    bandwidthAlgo = new BandwidthWHarmonicAlgorithm(m_videoData, m_playbackData,
-                                                    m_bufferData, m_throughput);
-    algo = new constbitrateAlgorithm(m_videoData, m_playbackData, m_bufferData,
-                                     m_throughput);
-  } else {
+  TypeId adaptationTid = m_adaptationTid;
+  TypeId bandwidthTid = m_bandwidthTid;
+  TypeId userinfoTid = m_userinfoTid;
+  if (LookupAlgorithms(algorithm, adaptationTid, bandwidthTid,
+                       userinfoTid)) {
+    userinfoAlgo = AlgorithmRegistry<UserinfoAlgorithm>::Create(
+        userinfoTid, m_videoData, m_playbackData, m_bufferData, m_throughput);
+    bandwidthAlgo = AlgorithmRegistry<BandwidthAlgorithm>::Create(
+        bandwidthTid, m_videoData, m_playbackData, m_bufferData,
+        m_throughput);
+    algo = AlgorithmRegistry<AdaptationAlgorithm>::Create(
+        adaptationTid, m_videoData, m_playbackData, m_bufferData,
+        m_throughput);
+  }
+  if (algo == 0 || bandwidthAlgo == 0 || userinfoAlgo == 0) {
     NS_LOG_ERROR("Invalid algorithm name entered. Terminating.");
     StopApplication();
     Simulator::Stop();
     Simulator::Destroy();
+    return;
   }
+  userinfoAlgo->Initialize();
+  bandwidthAlgo->Initialize();
+  algo->Initialize();
 
   m_algoName = algorithm;
+  m_handoverPredictor =
+      HandoverPredictor(m_handoverHysteresis, m_handoverTimeToTrigger, 0.3);
 
   InitializeLogFiles(ToString(m_simulationId), ToString(m_clientId),
                      ToString(m_numberOfClients));
 }
 
+bool TcpStreamClient::LookupAlgorithms(std::string algorithm,
+                                       TypeId &adaptation, TypeId &bandwidth,
+                                       TypeId &userinfo) {
+  for (uint32_t i = 0; i < sizeof(g_algorithmPresets) /
+                              sizeof(g_algorithmPresets[0]);
+       i++) {
+    if (algorithm == g_algorithmPresets[i].name) {
+      adaptation = TypeId::LookupByName(g_algorithmPresets[i].adaptation);
+      bandwidth = TypeId::LookupByName(g_algorithmPresets[i].bandwidth);
+      userinfo = TypeId::LookupByName(g_algorithmPresets[i].userinfo);
+      return true;
+    }
+  }
+  return TypeId::LookupByNameFailSafe(algorithm, &adaptation);
+}
+
 TcpStreamClient::~TcpStreamClient() {
   NS_LOG_FUNCTION(this);
   m_socket = 0;
 
-  delete algo;
-  delete userinfoAlgo;
-  delete bandwidthAlgo;
-
-  algo = NULL;
-  userinfoAlgo = NULL;
-  bandwidthAlgo = NULL;
+  algo = 0;
+  userinfoAlgo = 0;
+  bandwidthAlgo = 0;
 
   delete[] m_data;
   m_data = 0;
@@ -334,13 +460,16 @@ TcpStreamClient::~TcpStreamClient() {
 }
 
 int64_t updateScale(int64_t scale,
-                    std::vector<std::pair<int64_t, int64_t>> pause,
-                    std::vector<std::pair<int64_t, int64_t>> new_stats) {
+                    const std::vector<std::pair<int64_t, int64_t>> &pause,
+                    const std::vector<std::pair<int64_t, int64_t>> &new_stats) {
   int64_t updateTimescale = scale;
   if (pause.empty() || new_stats.empty()) return updateTimescale;
-  for (uint64_t i = 0; i < pause.size(); i++) {
+  // the pauses are logged as they end, so by increasing end time: only the
+  // last ones, ending after the first sample, can overlap the samples
+  for (uint64_t i = pause.size(); i-- > 0;) {
     int64_t StartTime = pause.at(i).first;  // early
     int64_t EndTime = pause.at(i).second;   // late
+    if (EndTime <= new_stats.at(new_stats.size() - 1).first) break;
     if (0 < new_stats.at(new_stats.size() - 1).first &&
         new_stats.at(new_stats.size() - 1).first < StartTime &&
         new_stats.at(0).first > EndTime) {
@@ -362,10 +491,11 @@ int64_t updateScale(int64_t scale,
   return updateTimescale;
 }
 
-double BWEstimate(std::deque<PhyRxStatsCalculator::Time_Tbs> phy_stats,
-                  std::vector<std::pair<int64_t, int64_t>> pause) {
+double BWEstimate(const std::deque<PhyRxStatsCalculator::Time_Tbs> &phy_stats,
+                  const std::vector<std::pair<int64_t, int64_t>> &pause,
+                  int64_t traceBegin) {
   double bandwidthEstimate_inter = 0.0;
-  std::deque<PhyRxStatsCalculator::Time_Tbs>::iterator point;
+  std::deque<PhyRxStatsCalculator::Time_Tbs>::const_iterator point;
   if (phy_stats.empty()) return bandwidthEstimate_inter;
   std::vector<std::pair<int64_t, int64_t>> new_stats;
   uint32_t cum_tbs = 0;
@@ -512,63 +642,147 @@ double BWEstimate(std::deque<PhyRxStatsCalculator::Time_Tbs> phy_stats,
   return bandwidthEstimate_inter;
 }
 static double GetPhyRate(Ptr<PhyRxStatsCalculator> phy_rx_stats,
-                         int64_t StartTime, int64_t EndTime, int64_t traceBegin,
-                         uint16_t m_clientId) {
+                         uint64_t imsi, int64_t StartTime, int64_t EndTime,
+                         int64_t traceBegin,
+                         std::vector<std::pair<int64_t, int64_t>> &pause) {
   //<\logging all the pause
   std::pair<int64_t, int64_t> pausetemp;
   pausetemp.first = StartTime;
   pausetemp.second = EndTime;
   if (pausetemp.first > 0 && pausetemp.second > 0) pause.push_back(pausetemp);
   //<\end
-  std::deque<PhyRxStatsCalculator::Time_Tbs> phy_stats =
-      phy_rx_stats->GetCorrectTbs();
   double bandwidthEstimate_update =
-      0.9 *
-      BWEstimate(phy_stats, pause);  // update Global val BandWidth by add all
+      0.9 * BWEstimate(phy_rx_stats->GetCorrectTbs(imsi), pause,
+                       traceBegin);  // update Global val BandWidth by add all
   return bandwidthEstimate_update;
 }
 
 void TcpStreamClient::RequestRepIndex() {
   NS_LOG_FUNCTION(this);
 
-  int64_t PauseStartTime = lastEndTime;  // lastDownloadEnd==CurrentPauseStart
+  int64_t PauseStartTime = m_lastEndTime;  // lastDownloadEnd==CurrentPauseStart
   int64_t PauseEndTime = Simulator::Now().GetMicroSeconds() / 1000;
-  bandwidthEstimate = GetPhyRate(cm_crossLayerInfo, PauseStartTime,
-                                 PauseEndTime, traceBegin, m_clientId);
+  {
+    DecisionTimer timer(DecisionProfiler::PHY_RATE);
+    bandwidthEstimate =
+        GetPhyRate(cm_crossLayerInfo, m_imsi, PauseStartTime, PauseEndTime,
+                   m_traceBegin, m_pauses);
+  }
+  bandwidthAlgo->CrossLayerEstimate(bandwidthEstimate);
 
   userinfoAlgoReply userinfoanswer;
   bandwidthAlgoReply bandwidthanswer;
   algorithmReply answer;
 
-  userinfoanswer = userinfoAlgo->UserinfoAlgo(m_segmentCounter, m_clientId);
-  bandwidthanswer = bandwidthAlgo->BandwidthAlgo(m_segmentCounter, m_clientId);
+  {
+    DecisionTimer timer(DecisionProfiler::USERINFO);
+    userinfoanswer = userinfoAlgo->UserinfoAlgo(m_segmentCounter, m_clientId);
+  }
+  if (userinfoanswer.viewpoint >= 0 &&
+      userinfoanswer.viewpoint < (int64_t)m_videoData.segmentSize.size()) {
+    // the adaptation decides for the predicted viewpoint
+    m_videoData.userInfo.at(m_segmentCounter) = userinfoanswer.viewpoint;
+  }
+  {
+    DecisionTimer timer(DecisionProfiler::BANDWIDTH);
+    bandwidthanswer =
+        bandwidthAlgo->BandwidthAlgo(m_segmentCounter, m_clientId);
+  }
 
-  if (!CROSSLAYER)
-    answer = algo->GetNextRep(m_segmentCounter, m_clientId,
-                              bandwidthanswer.bandwidthEstimate);
-  else
-    answer = algo->GetNextRep(m_segmentCounter, m_clientId,
-                              bandwidthEstimate);  //<crosslayer_BW
+  // the coordinator sizes the client on the ladder it streams now
+  if (m_coordinated && !algo->RequestsAllViewpoints() &&
+      m_videoData.userInfo.at(m_segmentCounter) != m_coordinatedViewpoint) {
+    AttachToCoordinator();
+  }
+
+  // the coordinator of the cell caps the estimate and the decision
+  double cap = m_coordinator != 0 ? m_coordinator->GetCap(m_clientId) : 0;
+  if (cap > 0) {
+    bandwidthanswer.bandwidthEstimate =
+        std::min(bandwidthanswer.bandwidthEstimate, cap);
+    bandwidthEstimate = std::min(bandwidthEstimate, cap);
+  }
+
+  // build up the buffer before a predicted handover
+  bool prebuffer = false;
+  if (m_handoverHorizon > 0) {
+    const int64_t timeToHandover = m_handoverPredictor.TimeToHandover(
+        Simulator::Now().GetMicroSeconds());
+    prebuffer = timeToHandover >= 0 && timeToHandover <= m_handoverHorizon;
+  }
+  const double prebufferCap =
+      m_handoverPrebufferFactor *
+      (CROSSLAYER ? bandwidthEstimate : bandwidthanswer.bandwidthEstimate);
+
+  // the algorithm honours both caps in its decision: on the sum of the
+  // bitrates of the faces if it requests all of them, per viewpoint if not
+  std::vector<int64_t> maxRepIndex;
+  std::vector<int64_t> prebufferViewpoints;  // where the pre-buffering binds
+  const bool prebufferBitrate =
+      prebuffer && (cap <= 0 || prebufferCap < cap);
+  if (algo->RequestsAllViewpoints()) {
+    algo->SetMaxBitrate(prebufferBitrate ? prebufferCap : cap);
+  } else if (cap > 0 || prebuffer) {
+    for (uint32_t i = 0; i < m_videoData.ladders.size(); i++) {
+      const BitrateLadder &ladder = m_videoData.ladders[i];
+      int64_t capRepIndex = ladder.GetHighestRepIndex();
+      if (cap > 0) {
+        capRepIndex = ladder.GetHighestRepBelow(cap);
+      }
+      if (prebuffer && ladder.GetHighestRepBelow(prebufferCap) < capRepIndex) {
+        capRepIndex = ladder.GetHighestRepBelow(prebufferCap);
+        prebufferViewpoints.push_back(i);
+      }
+      maxRepIndex.push_back(capRepIndex);
+    }
+  }
+  algo->SetMaxRepIndex(maxRepIndex);
+
+  {
+    DecisionTimer timer(DecisionProfiler::NEXT_REP);
+    if (!CROSSLAYER)
+      answer = algo->GetNextRep(m_segmentCounter, m_clientId,
+                                bandwidthanswer.bandwidthEstimate);
+    else
+      answer = algo->GetNextRep(m_segmentCounter, m_clientId,
+                                bandwidthEstimate);  //<crosslayer_BW
+  }
+
+  // count the decisions the pre-buffering lowered
+  if (algo->RequestsAllViewpoints()) {
+    if (prebufferBitrate && algo->IsBitrateCapped()) {
+      m_prebuffered++;
+    }
+  }
+  for (uint32_t i = 0; i < prebufferViewpoints.size(); i++) {
+    if (algo->IsCapped(prebufferViewpoints[i])) {
+      m_prebuffered++;
+      break;
+    }
+  }
 
   if (m_segmentCounter == 0)
-    traceBegin = (int64_t)answer.decisionTime / 1000;  // ms
+    m_traceBegin = (int64_t)answer.decisionTime / 1000;  // ms
 
   m_videoData.repIndex.push_back(answer.nextRepIndex);
   m_currentRepIndex = answer.nextRepIndex;
+  m_faceRepIndex = answer.faceRepIndex;
 
   NS_ASSERT_MSG(answer.nextRepIndex <= m_highestRepIndex,
                 "The algorithm returned a representation index that's higher "
                 "than the maximum");
-
-  // time stamp, repnumber, repindex, bw, delay
-
-  std::cout << "** At: " << std::fixed << std::setprecision(3)
-            << answer.decisionTime / 1000000.0 << ", ClientId " << m_clientId
-            << ", Rep " << m_segmentCounter << ", Index " << m_currentRepIndex
-            << ", Bw " << std::fixed << std::setprecision(3)
-            << answer.estimateTh / 1000000.0 << ", Delay " << std::fixed
-            << std::setprecision(3) << answer.nextDownloadDelay / 1000000.0
-            << ", Case " << answer.decisionCase << " **" << std::endl;
+  NS_ASSERT_MSG(m_faceRepIndex.empty() ||
+                    m_faceRepIndex.size() == m_videoData.segmentSize.size(),
+                "The algorithm returned a representation for some faces only");
+
+  // time stamp, repnumber, repindex, bw, delay; written for every decision
+  // of every client, so only with logging, LogAdaptation keeps the same
+  NS_LOG_INFO("** At: " << std::fixed << std::setprecision(3)
+              << answer.decisionTime / 1000000.0 << ", ClientId "
+              << m_clientId << ", Rep " << m_segmentCounter << ", Index "
+              << m_currentRepIndex << ", Bw " << answer.estimateTh / 1000000.0
+              << ", Delay " << answer.nextDownloadDelay / 1000000.0
+              << ", Case " << answer.decisionCase << " **");
 
   m_playbackData.playbackIndex.push_back(answer.nextRepIndex);
   m_bDelay = answer.nextDownloadDelay;
@@ -576,6 +790,194 @@ void TcpStreamClient::RequestRepIndex() {
   LogAdaptation(answer);
 }
 
+// 64 bit finalizer of MurmurHash3, spreads the keys on the hash ring
+static uint64_t MixHash(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+void TcpStreamClient::BuildHashRing() {
+  const uint64_t virtualNodes = 64;
+  m_hashRing.clear();
+  for (uint64_t i = 0; i < m_servers.size(); i++) {
+    for (uint64_t j = 0; j < virtualNodes; j++) {
+      m_hashRing[MixHash((i << 32) | j)] = i;
+    }
+  }
+}
+
+uint32_t TcpStreamClient::SelectServer() {
+  if (m_servers.size() == 1) {
+    return 0;
+  }
+  if (m_serverSelection == HASH) {
+    uint64_t key = MixHash(
+        ((uint64_t)m_videoData.userInfo.at(m_segmentCounter) << 32) ^
+        (uint64_t)m_segmentCounter);
+    // walk clockwise to the first connected server
+    std::map<uint64_t, uint32_t>::const_iterator it =
+        m_hashRing.lower_bound(key);
+    for (uint32_t i = 0; i < m_hashRing.size(); i++, ++it) {
+      if (it == m_hashRing.end()) {
+        it = m_hashRing.begin();
+      }
+      if (m_servers.at(it->second).connected) {
+        return it->second;
+      }
+    }
+    return m_server;
+  }
+  uint32_t best = m_server;
+  for (uint32_t i = 0; i < m_servers.size(); i++) {
+    const streamServer &candidate = m_servers.at(i);
+    if (!candidate.connected) {
+      continue;
+    }
+    if (candidate.rtt < 0) {
+      // no sample yet, try it
+      return i;
+    }
+    const streamServer &current = m_servers.at(best);
+    if (!current.connected) {
+      best = i;
+    } else if (m_serverSelection == RTT) {
+      if (candidate.rtt < current.rtt) {
+        best = i;
+      }
+    } else if (candidate.backlogBytes < current.backlogBytes ||
+               (candidate.backlogBytes == current.backlogBytes &&
+                candidate.activeRequests < current.activeRequests)) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+int64_t TcpStreamClient::GetPlaybackDeadline() {
+  int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  if (m_playbackData.playbackStart.empty() || m_bufferUnderrun) {
+    return timeNow;
+  }
+  // the segment is needed once the segment currently played and all segments
+  // waiting in the buffer have been played
+  int64_t currentLeft =
+      std::max(m_playbackData.playbackStart.back() +
+                   (int64_t)m_videoData.segmentDuration - timeNow,
+               (int64_t)0);
+  return timeNow + currentLeft +
+         m_segmentsInBuffer * (int64_t)m_videoData.segmentDuration;
+}
+
+void TcpStreamClient::RequestSegment() {
+  NS_LOG_FUNCTION(this);
+  uint32_t server = SelectServer();
+  if (server != m_server) {
+    // the push was announced to the previous server
+    CancelPush();
+    m_server = server;
+    m_socket = m_servers.at(server).socket;
+  }
+  m_servers.at(m_server).segments++;
+  if (!m_faceRepIndex.empty()) {
+    // every face is a separate object, requested one after the other;
+    // pushes announce whole segments, so there are none
+    CancelPush();
+    m_currentFace = 0;
+    m_faceBytesEnd = 0;
+    RequestFace();
+    return;
+  }
+  int64_t segmentSize = GetSegmentBytes();
+  std::ostringstream request;
+  bool accept =
+      m_pushSegment == m_segmentCounter && m_pushRepIndex == m_currentRepIndex;
+  if (accept) {
+    // the server is already sending this segment, take over what arrived
+    m_pushAccepted = true;
+    m_bytesReceived = m_pushBytesPending;
+    if (m_pushBytesPending > 0) {
+      m_transmissionStartReceivingSegment = m_pushFirstByte;
+    }
+    m_pushedBytesUsed += m_pushBytesPending;
+    request << "confirm";
+  } else {
+    // a request for another segment makes the server drop the push
+    request << segmentSize;
+  }
+  m_pushSegment = -1;
+  m_pushBytesPending = 0;
+  request << " " << GetPlaybackDeadline() << " " << m_schedulingWeight << " "
+          << m_videoData.userInfo.at(m_segmentCounter) << " "
+          << m_currentRepIndex << " " << m_segmentCounter;
+  if (m_serverPush && m_segmentCounter < m_lastSegmentIndex) {
+    m_pushSegment = m_segmentCounter + 1;
+    m_pushRepIndex = m_currentRepIndex;
+    int64_t pushViewpoint = m_videoData.userInfo.at(m_pushSegment);
+    request << " " << pushViewpoint << " " << m_pushRepIndex << " "
+            << m_pushSegment << " "
+            << m_videoData.segmentSize.at(pushViewpoint)
+                   .at(m_pushRepIndex)
+                   .at(m_pushSegment);
+  }
+  std::string message = request.str();
+  Send(message);
+  if (accept && m_bytesReceived == segmentSize) {
+    Simulator::ScheduleNow(&TcpStreamClient::SegmentReceivedHandle, this);
+  }
+}
+
+void TcpStreamClient::RequestFace() {
+  NS_LOG_FUNCTION(this);
+  int64_t faceSize = m_videoData.segmentSize.at(m_currentFace)
+                         .at(m_faceRepIndex.at(m_currentFace))
+                         .at(m_segmentCounter);
+  m_faceBytesEnd += faceSize;
+  std::ostringstream request;
+  request << faceSize << " " << GetPlaybackDeadline() << " "
+          << m_schedulingWeight << " " << m_currentFace << " "
+          << m_faceRepIndex.at(m_currentFace) << " " << m_segmentCounter;
+  std::string message = request.str();
+  if (m_currentFace == 0) {
+    Send(message);
+  } else {
+    // the segment was requested with its first face
+    PreparePacket(message);
+    m_socket->Send(Create<Packet>(m_data, m_dataSize));
+  }
+}
+
+int64_t TcpStreamClient::GetSegmentBytes() {
+  if (m_faceRepIndex.empty()) {
+    return m_videoData.segmentSize
+        .at(m_videoData.userInfo.at(m_segmentCounter))
+        .at(m_currentRepIndex)
+        .at(m_segmentCounter);
+  }
+  int64_t bytes = 0;
+  for (uint32_t face = 0; face < m_faceRepIndex.size(); face++) {
+    bytes += m_videoData.segmentSize.at(face)
+                 .at(m_faceRepIndex.at(face))
+                 .at(m_segmentCounter);
+  }
+  return bytes;
+}
+
+void TcpStreamClient::CancelPush() {
+  NS_LOG_FUNCTION(this);
+  if (m_pushSegment < 0) {
+    return;
+  }
+  m_pushSegment = -1;
+  m_pushBytesPending = 0;
+  std::string message = "cancel";
+  PreparePacket(message);
+  m_socket->Send(Create<Packet>(m_data, m_dataSize));
+}
+
 template <typename T>
 void TcpStreamClient::Send(T &message) {
   NS_LOG_FUNCTION(this);
@@ -589,19 +991,72 @@ void TcpStreamClient::Send(T &message) {
 void TcpStreamClient::HandleRead(Ptr<Socket> socket) {
   NS_LOG_FUNCTION(this << socket);
   Ptr<Packet> packet;
-  if (m_bytesReceived == 0) {
-    m_transmissionStartReceivingSegment = Simulator::Now().GetMicroSeconds();
-  }
+  int64_t timeNow = Simulator::Now().GetMicroSeconds();
   uint32_t packetSize;
+  uint32_t server = 0;
+  while (server < m_servers.size() && m_servers.at(server).socket != socket) {
+    server++;
+  }
+  if (server == m_servers.size()) {
+    return;
+  }
   while ((packet = socket->Recv())) {
     packetSize = packet->GetSize();
-    m_bytesReceived += packetSize;
-    LogThroughput(packetSize);
-    if (m_bytesReceived ==
-        m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-            .at(m_currentRepIndex)
-            .at(m_segmentCounter)) {
+    // split the packet into the bytes of the segment being downloaded and
+    // bytes the server pushed on its own
+    uint32_t pushedSize = 0;
+    uint32_t segmentBytes = 0;
+    ByteTagIterator tags = packet->GetByteTagIterator();
+    while (tags.HasNext()) {
+      ByteTagIterator::Item item = tags.Next();
+      if (item.GetTypeId() == TcpStreamLoadTag::GetTypeId()) {
+        TcpStreamLoadTag load;
+        item.GetTag(load);
+        m_servers.at(server).activeRequests = load.GetActiveRequests();
+        m_servers.at(server).backlogBytes = load.GetBacklogBytes();
+        continue;
+      }
+      if (item.GetTypeId() != TcpStreamPushTag::GetTypeId()) {
+        continue;
+      }
+      TcpStreamPushTag tag;
+      item.GetTag(tag);
+      uint32_t bytes = item.GetEnd() - item.GetStart();
+      pushedSize += bytes;
+      if (server != m_server) {
+        // a push the previous server had already sent when it was cancelled
+        m_pushedBytesDiscarded += bytes;
+      } else if (m_pushAccepted && tag.GetSegment() == m_segmentCounter) {
+        segmentBytes += bytes;
+        m_pushedBytesUsed += bytes;
+      } else if (tag.GetSegment() == m_pushSegment) {
+        if (m_pushBytesPending == 0) {
+          m_pushFirstByte = timeNow;
+        }
+        m_pushBytesPending += bytes;
+      } else {
+        m_pushedBytesDiscarded += bytes;
+      }
+    }
+    segmentBytes += packetSize - pushedSize;
+    if (m_bytesReceived == 0 && segmentBytes > 0) {
+      m_transmissionStartReceivingSegment = timeNow;
+      if (!m_pushAccepted) {
+        streamServer &current = m_servers.at(m_server);
+        double sample = timeNow - (int64_t)m_downloadRequestSent;
+        current.rtt =
+            current.rtt < 0 ? sample : 0.875 * current.rtt + 0.125 * sample;
+      }
+    }
+    m_bytesReceived += segmentBytes;
+    bandwidthAlgo->PacketReceived(timeNow, packetSize);
+    LogThroughput(packetSize - pushedSize, pushedSize);
+    if (segmentBytes > 0 && m_bytesReceived == GetSegmentBytes()) {
       SegmentReceivedHandle();
+    } else if (segmentBytes > 0 && !m_faceRepIndex.empty() &&
+               m_bytesReceived == m_faceBytesEnd) {
+      m_currentFace++;
+      RequestFace();
     }
   }
 }
@@ -610,17 +1065,24 @@ void TcpStreamClient::HandleRead(Ptr<Socket> socket) {
 std::string TcpStreamClient::ChoseInfoPath(int64_t infoindex) {
   NS_LOG_FUNCTION(this);
 
-  return "SegmentSize.txt";
+  std::stringstream files(m_segmentSizeFiles);
+  std::string file;
+  for (int64_t i = 0; std::getline(files, file, ','); i++) {
+    if (i == infoindex) return file;
+  }
+  return "";
 }
 void TcpStreamClient::GetInfo() {
-  std::ifstream myinfo("UserInfo.txt");
+  std::ifstream myinfo(m_userInfoFile.c_str());
   for (int64_t s; myinfo >> s;) m_videoData.userInfo.push_back(s);
 }
 
 int TcpStreamClient::ReadInBitrateValues() {
   NS_LOG_FUNCTION(this);
   GetInfo();
-  for (int64_t i = 0; i < 1; i++) {  // useinfo circle
+  int64_t viewpoints =
+      std::count(m_segmentSizeFiles.begin(), m_segmentSizeFiles.end(), ',') + 1;
+  for (int64_t i = 0; i < viewpoints; i++) {  // useinfo circle
     std::ifstream myfile;
     segmentSizeFile = ChoseInfoPath(i);
     myfile.open(segmentSizeFile.c_str());
@@ -656,13 +1118,34 @@ int TcpStreamClient::ReadInBitrateValues() {
 
   NS_ASSERT_MSG(!m_videoData.segmentSize.empty(),
                 "No segment sizes read from file.");
+  for (uint32_t i = 0; i < m_videoData.segmentSize.size(); i++) {
+    m_videoData.ladders.push_back(BitrateLadder(
+        m_videoData.segmentSize[i], m_videoData.averageBitrate[i]));
+  }
+  // segments without a viewpoint in the user info file, e.g. if it is
+  // empty, are watched from viewpoint 0 unless a viewport predictor says
+  // otherwise
+  if (m_videoData.userInfo.size() < m_videoData.segmentSize[0][0].size()) {
+    m_videoData.userInfo.resize(m_videoData.segmentSize[0][0].size(), 0);
+  }
+  for (uint32_t i = 0; i < m_videoData.userInfo.size(); i++) {
+    if (m_videoData.userInfo.at(i) < 0 ||
+        m_videoData.userInfo.at(i) >= viewpoints) {
+      NS_FATAL_ERROR("The user info file " << m_userInfoFile
+                                           << " names viewpoint "
+                                           << m_videoData.userInfo.at(i)
+                                           << " for segment " << i
+                                           << ", but there are " << viewpoints
+                                           << " segment size files");
+    }
+  }
   return 1;
 }
 
 void TcpStreamClient::SegmentReceivedHandle() {
   NS_LOG_FUNCTION(this);
   m_transmissionEndReceivingSegment = Simulator::Now().GetMicroSeconds();
-  lastEndTime = (int64_t)m_transmissionEndReceivingSegment / 1000;
+  m_lastEndTime = (int64_t)m_transmissionEndReceivingSegment / 1000;
   m_bufferData.timeNow.push_back(m_transmissionEndReceivingSegment);
   if (m_segmentCounter > 0) {
     m_bufferData.bufferLevelOld.push_back(
@@ -676,13 +1159,12 @@ void TcpStreamClient::SegmentReceivedHandle() {
   m_bufferData.bufferLevelNew.push_back(m_bufferData.bufferLevelOld.back() +
                                         m_videoData.segmentDuration);
 
-  m_throughput.bytesReceived.push_back(
-      m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-          .at(m_currentRepIndex)
-          .at(m_segmentCounter));
+  m_throughput.bytesReceived.push_back(GetSegmentBytes());
   m_throughput.transmissionStart.push_back(m_transmissionStartReceivingSegment);
   m_throughput.transmissionRequested.push_back(m_downloadRequestSent);
   m_throughput.transmissionEnd.push_back(m_transmissionEndReceivingSegment);
+  m_throughput.handoverTime.push_back(GetHandoverTime(
+      m_transmissionStartReceivingSegment, m_transmissionEndReceivingSegment));
 
   LogDownload();
 
@@ -690,6 +1172,7 @@ void TcpStreamClient::SegmentReceivedHandle() {
 
   m_segmentsInBuffer++;
   m_bytesReceived = 0;
+  m_pushAccepted = false;
   if (m_segmentCounter == m_lastSegmentIndex) {
     m_bDelay = 0;
   }
@@ -704,6 +1187,7 @@ bool TcpStreamClient::PlaybackHandle() {
   if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex &&
       !m_bufferUnderrun) {
     m_bufferUnderrun = true;
+    m_underruns.push_back(std::make_pair(timeNow, (int64_t)-1));
     bufferUnderrunLog << std::setfill(' ') << std::setw(9)
                       << timeNow / (double)1000000 << " ";
     bufferUnderrunLog.flush();
@@ -711,6 +1195,7 @@ bool TcpStreamClient::PlaybackHandle() {
   } else if (m_segmentsInBuffer > 0) {
     if (m_bufferUnderrun) {
       m_bufferUnderrun = false;
+      m_underruns.back().second = timeNow;
       bufferUnderrunLog << std::setfill(' ') << std::setw(9)
                         << timeNow / (double)1000000 << "\n";
       bufferUnderrunLog.flush();
@@ -743,44 +1228,152 @@ void TcpStreamClient::SetRemote(Ipv6Address ip, uint16_t port) {
   m_peerPort = port;
 }
 
+void TcpStreamClient::AddServer(Address ip, uint16_t port) {
+  NS_LOG_FUNCTION(this << ip << port);
+  m_additionalServers.push_back(std::make_pair(ip, port));
+}
+
+void TcpStreamClient::SetCoordinators(
+    const std::map<uint16_t, Ptr<CellCoordinator>> &coordinators) {
+  NS_LOG_FUNCTION(this);
+  m_coordinators = coordinators;
+}
+
 void TcpStreamClient::DoDispose(void) {
   NS_LOG_FUNCTION(this);
+  if (algo != 0) {
+    algo->Dispose();
+    algo = 0;
+  }
+  if (bandwidthAlgo != 0) {
+    bandwidthAlgo->Dispose();
+    bandwidthAlgo = 0;
+  }
+  if (userinfoAlgo != 0) {
+    userinfoAlgo->Dispose();
+    userinfoAlgo = 0;
+  }
+  m_coordinator = 0;
+  m_coordinators.clear();
   Application::DoDispose();
 }
 
 void TcpStreamClient::StartApplication(void) {
   NS_LOG_FUNCTION(this);
   if (m_socket == 0) {
+    std::vector<std::pair<Address, uint16_t>> servers(
+        1, std::make_pair(m_peerAddress, m_peerPort));
+    servers.insert(servers.end(), m_additionalServers.begin(),
+                   m_additionalServers.end());
     TypeId tid = TypeId::LookupByName("ns3::TcpSocketFactory");
-    m_socket = Socket::CreateSocket(GetNode(), tid);
-    if (Ipv4Address::IsMatchingType(m_peerAddress) == true) {
-      m_socket->Connect(InetSocketAddress(
-          Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
-    } else if (Ipv6Address::IsMatchingType(m_peerAddress) == true) {
-      m_socket->Connect(Inet6SocketAddress(
-          Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+    for (uint32_t i = 0; i < servers.size(); i++) {
+      streamServer server;
+      server.address = servers.at(i).first;
+      server.port = servers.at(i).second;
+      server.socket = Socket::CreateSocket(GetNode(), tid);
+      server.connected = false;
+      server.rtt = -1;
+      server.activeRequests = 0;
+      server.backlogBytes = 0;
+      server.segments = 0;
+      if (Ipv4Address::IsMatchingType(server.address) == true) {
+        server.socket->Connect(InetSocketAddress(
+            Ipv4Address::ConvertFrom(server.address), server.port));
+      } else if (Ipv6Address::IsMatchingType(server.address) == true) {
+        server.socket->Connect(Inet6SocketAddress(
+            Ipv6Address::ConvertFrom(server.address), server.port));
+      }
+      server.socket->SetConnectCallback(
+          MakeCallback(&TcpStreamClient::ConnectionSucceeded, this),
+          MakeCallback(&TcpStreamClient::ConnectionFailed, this));
+      server.socket->SetRecvCallback(
+          MakeCallback(&TcpStreamClient::HandleRead, this));
+      m_servers.push_back(server);
     }
-    m_socket->SetConnectCallback(
-        MakeCallback(&TcpStreamClient::ConnectionSucceeded, this),
-        MakeCallback(&TcpStreamClient::ConnectionFailed, this));
-    m_socket->SetRecvCallback(MakeCallback(&TcpStreamClient::HandleRead, this));
+    m_server = 0;
+    m_socket = m_servers.at(0).socket;
+    BuildHashRing();
+  }
+  if (m_coordinator != 0) {
+    AttachToCoordinator();
+    m_coordinated = true;
+  }
+}
+
+void TcpStreamClient::AttachToCoordinator() {
+  NS_LOG_FUNCTION(this);
+  const int64_t viewpoint = m_videoData.userInfo.at(
+      std::min(m_segmentCounter, m_lastSegmentIndex));
+  if (algo->RequestsAllViewpoints()) {
+    // a segment is all faces: rep r of the ladder is every face at r
+    std::vector<double> bitrates(m_highestRepIndex + 1, 0);
+    for (uint32_t i = 0; i < m_videoData.ladders.size(); i++) {
+      const BitrateLadder &ladder = m_videoData.ladders[i];
+      for (int64_t rep = 0; rep <= m_highestRepIndex; rep++) {
+        bitrates.at(rep) += ladder.GetBitrate(
+            std::min(rep, ladder.GetHighestRepIndex()));
+      }
+    }
+    m_coordinator->Attach(m_clientId, bitrates, m_schedulingWeight);
+    m_coordinatedViewpoint = -1;
+  } else {
+    m_coordinator->Attach(m_clientId,
+                          m_videoData.ladders.at(viewpoint).GetBitrates(),
+                          m_schedulingWeight);
+    m_coordinatedViewpoint = viewpoint;
   }
 }
 
 void TcpStreamClient::StopApplication() {
   NS_LOG_FUNCTION(this);
+  if (m_serverPush) {
+    NS_LOG_INFO("Client " << m_clientId << ": pushed bytes used "
+                          << m_pushedBytesUsed << ", discarded "
+                          << m_pushedBytesDiscarded);
+  }
 
-  if (m_socket != 0) {
-    m_socket->Close();
-    m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
-    m_socket = 0;
+  if (m_servers.size() > 1) {
+    for (uint32_t i = 0; i < m_servers.size(); i++) {
+      NS_LOG_INFO("Client " << m_clientId << ": server " << i << " "
+                            << m_servers.at(i).address << ", segments "
+                            << m_servers.at(i).segments
+                            << ", response time (us) "
+                            << m_servers.at(i).rtt);
+    }
   }
+
+  if (m_coordinated) {
+    m_coordinator->Detach(m_clientId);
+    m_coordinated = false;
+  }
+
+  for (uint32_t i = 0; i < m_servers.size(); i++) {
+    if (m_servers.at(i).socket != 0) {
+      m_servers.at(i).socket->Close();
+      m_servers.at(i).socket->SetRecvCallback(
+          MakeNullCallback<void, Ptr<Socket>>());
+      m_servers.at(i).socket = 0;
+    }
+  }
+  m_socket = 0;
   downloadLog.close();
   playbackLog.close();
   adaptationLog.close();
   bufferLog.close();
   throughputLog.close();
   bufferUnderrunLog.close();
+  // a handover still ongoing is logged as unfinished, and those whose window
+  // is still open up to now
+  EndHandover(handoverUnfinished);
+  for (uint32_t i = 0; i < m_handovers.size(); i++) {
+    if (m_handovers.at(i).end >= 0 &&
+        m_handovers.at(i).end + m_handoverRebufferWindow >
+            Simulator::Now().GetMicroSeconds()) {
+      LogHandover(i);
+    }
+  }
+  handoverLog.close();
+  m_handoverLogName.clear();
 }
 
 template <typename T>
@@ -802,8 +1395,16 @@ void TcpStreamClient::PreparePacket(T &message) {
 void TcpStreamClient::ConnectionSucceeded(Ptr<Socket> socket) {
   NS_LOG_FUNCTION(this << socket);
   NS_LOG_LOGIC("Tcp Stream Client connection succeeded");
-  controllerEvent event = init;
-  Controller(event);
+  for (uint32_t i = 0; i < m_servers.size(); i++) {
+    if (m_servers.at(i).socket == socket) {
+      m_servers.at(i).connected = true;
+    }
+  }
+  // start streaming as soon as there is a server to download from
+  if (m_connectedServers++ == 0) {
+    controllerEvent event = init;
+    Controller(event);
+  }
 }
 
 void TcpStreamClient::ConnectionFailed(Ptr<Socket> socket) {
@@ -811,32 +1412,30 @@ void TcpStreamClient::ConnectionFailed(Ptr<Socket> socket) {
   NS_LOG_LOGIC("Tcp Stream Client connection failed");
 }
 
-void TcpStreamClient::LogThroughput(uint32_t packetSize) {
+void TcpStreamClient::LogThroughput(uint32_t packetSize, uint32_t pushedSize) {
   NS_LOG_FUNCTION(this);
 
   throughputLog << std::setfill(' ') << std::setw(8) << std::fixed
                 << std::setprecision(3)
                 << Simulator::Now().GetMicroSeconds() / (double)1000000
-                << std::setfill(' ') << std::setw(10) << packetSize << "\n";
-  throughputLog.flush();
+                << std::setfill(' ') << std::setw(10) << packetSize;
+  if (m_serverPush) {
+    throughputLog << std::setfill(' ') << std::setw(10) << pushedSize;
+  }
+  // one line per packet: left to the buffer of the stream
+  throughputLog << "\n";
 }
 
 void TcpStreamClient::LogDownload() {
   NS_LOG_FUNCTION(this);
 
+  const int64_t segmentBytes = GetSegmentBytes();
   double Throughput =
-      8 *
-      m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-          .at(m_currentRepIndex)
-          .at(m_segmentCounter) /
+      8 * segmentBytes /
       (m_transmissionEndReceivingSegment / (double)1000000 -
        m_transmissionStartReceivingSegment / (double)1000000);
   double instantBitrate =
-      8 *
-      m_videoData.segmentSize.at(m_videoData.userInfo.at(m_segmentCounter))
-          .at(m_currentRepIndex)
-          .at(m_segmentCounter) *
-      1000000 / (double)m_segmentDuration;
+      8 * segmentBytes * 1000000 / (double)m_segmentDuration;
   downloadLog << std::setfill(' ') << std::setw(5) << m_segmentCounter
               << std::setfill(' ') << std::setw(10) << std::fixed
               << std::setprecision(3) << m_downloadRequestSent / (double)1000000
@@ -846,11 +1445,7 @@ void TcpStreamClient::LogDownload() {
               << std::setfill(' ') << std::setw(9) << std::fixed
               << std::setprecision(3)
               << m_transmissionEndReceivingSegment / (double)1000000
-              << std::setfill(' ') << std::setw(10)
-              << m_videoData.segmentSize
-                     .at(m_videoData.userInfo.at(m_segmentCounter))
-                     .at(m_currentRepIndex)
-                     .at(m_segmentCounter)
+              << std::setfill(' ') << std::setw(10) << segmentBytes
               << std::setfill(' ') << std::setw(12) << std::fixed
               << std::setprecision(0) << Throughput << "\t" << std::setfill(' ')
               << std::setw(12) << m_videoData.userInfo.at(m_segmentCounter)
@@ -895,8 +1490,13 @@ void TcpStreamClient::LogAdaptation(algorithmReply answer) {
                 << answer.nextDownloadDelay / (double)1000 << std::setfill(' ')
                 << std::setw(6) << answer.decisionCase << std::setfill(' ')
                 << std::setw(6) << answer.delayDecisionCase << std::setfill(' ')
-                << std::setw(9) << m_videoData.userInfo.at(m_segmentCounter)
-                << "\n";
+                << std::setw(9) << m_videoData.userInfo.at(m_segmentCounter);
+  // the representation of every face, if they are separate objects
+  for (uint32_t face = 0; face < answer.faceRepIndex.size(); face++) {
+    adaptationLog << std::setfill(' ') << std::setw(4)
+                  << answer.faceRepIndex.at(face) + 1;
+  }
+  adaptationLog << "\n";
   adaptationLog.flush();
 }
 
@@ -961,6 +1561,133 @@ void TcpStreamClient::InitializeLogFiles(std::string simulationId,
                       simulationId + "_" + "cl" + clientId + "_" +
                       "bufferUnderrunLog.txt";
   bufferUnderrunLog.open(buLog.c_str());
+
+  m_handoverLogName = "mylogs/" + m_algoName + "/" + numberOfClients + "/sim" +
+                      simulationId + "_" + "cl" + clientId + "_" +
+                      "handoverLog.txt";
+}
+
+void TcpStreamClient::NotifyHandoverStart(uint64_t imsi, uint16_t cellId,
+                                          uint16_t rnti,
+                                          uint16_t targetCellId) {
+  NS_LOG_FUNCTION(this << imsi << cellId << rnti << targetCellId);
+  // a handover the RRC never reported the end of is over now
+  EndHandover(handoverUnfinished);
+  handoverRecord record;
+  record.start = Simulator::Now().GetMicroSeconds();
+  record.end = -1;
+  record.outcome = handoverOngoing;
+  record.source = cellId;
+  record.target = targetCellId;
+  record.prebuffered = m_prebuffered;
+  m_handovers.push_back(record);
+  m_prebuffered = 0;
+}
+
+void TcpStreamClient::NotifyHandoverEndOk(uint64_t imsi, uint16_t cellId,
+                                          uint16_t rnti) {
+  NS_LOG_FUNCTION(this << imsi << cellId << rnti);
+  // the client is now shared with the clients of the target cell
+  std::map<uint16_t, Ptr<CellCoordinator>>::const_iterator coordinator =
+      m_coordinators.find(cellId);
+  if (coordinator != m_coordinators.end() &&
+      coordinator->second != m_coordinator) {
+    if (m_coordinated) {
+      m_coordinator->Detach(m_clientId);
+    }
+    m_coordinator = coordinator->second;
+    if (m_coordinated) {
+      AttachToCoordinator();
+    }
+  }
+  EndHandover(handoverOk);
+}
+
+void TcpStreamClient::NotifyHandoverEndError(uint64_t imsi, uint16_t cellId,
+                                             uint16_t rnti) {
+  NS_LOG_FUNCTION(this << imsi << cellId << rnti);
+  NS_LOG_WARN("Handover of IMSI " << imsi << " to cell " << cellId
+                                  << " failed");
+  EndHandover(handoverFailed);
+}
+
+void TcpStreamClient::EndHandover(handoverOutcome outcome) {
+  NS_LOG_FUNCTION(this << outcome);
+  if (m_handovers.empty() || m_handovers.back().end >= 0) {
+    return;
+  }
+  m_handovers.back().end = Simulator::Now().GetMicroSeconds();
+  m_handovers.back().outcome = outcome;
+  Simulator::Schedule(MicroSeconds(m_handoverRebufferWindow),
+                      &TcpStreamClient::LogHandover, this,
+                      (uint32_t)m_handovers.size() - 1);
+}
+
+void TcpStreamClient::NotifyUeMeasurements(uint16_t rnti, uint16_t cellId,
+                                           double rsrp, double rsrq,
+                                           bool servingCell,
+                                           uint8_t componentCarrierId) {
+  // the primary carrier decides on the handover
+  if (componentCarrierId != 0) {
+    return;
+  }
+  m_handoverPredictor.Measure(Simulator::Now().GetMicroSeconds(), cellId,
+                              rsrp, servingCell);
+}
+
+void TcpStreamClient::LogHandover(uint32_t index) {
+  NS_LOG_FUNCTION(this << index);
+  if (!handoverLog.is_open()) {
+    // the application has stopped and logged the open windows already
+    if (m_handoverLogName.empty()) {
+      return;
+    }
+    handoverLog.open(m_handoverLogName.c_str());
+  }
+  const handoverRecord &record = m_handovers.at(index);
+  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t windowEnd =
+      std::min(record.end + m_handoverRebufferWindow, timeNow);
+  int64_t rebufferTime = 0;
+  for (uint32_t i = 0; i < m_underruns.size(); i++) {
+    const int64_t start = std::max(m_underruns.at(i).first, record.start);
+    const int64_t end = m_underruns.at(i).second < 0
+                            ? windowEnd
+                            : std::min(m_underruns.at(i).second, windowEnd);
+    if (end > start) {
+      rebufferTime += end - start;
+    }
+  }
+  const char *outcome = record.outcome == handoverOk       ? "ok"
+                        : record.outcome == handoverFailed ? "failed"
+                                                           : "unfinished";
+  handoverLog << std::setfill(' ') << std::setw(9)
+              << record.start / (double)1000000 << " " << std::setw(9)
+              << record.end / (double)1000000 << " " << std::setw(3)
+              << record.source << " " << std::setw(3) << record.target << " "
+              << std::setw(10) << outcome << " " << std::setw(4)
+              << record.prebuffered << " " << std::setw(9)
+              << rebufferTime / (double)1000000 << "\n";
+  handoverLog.flush();
+}
+
+int64_t TcpStreamClient::GetHandoverTime(int64_t start, int64_t end) const {
+  int64_t handoverTime = 0;
+  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  for (uint32_t i = m_handovers.size(); i-- > 0;) {
+    const int64_t handoverEnd =
+        m_handovers.at(i).end < 0 ? timeNow : m_handovers.at(i).end;
+    // the handovers before end earlier still
+    if (handoverEnd <= start) {
+      break;
+    }
+    const int64_t overlap =
+        std::min(handoverEnd, end) - std::max(m_handovers.at(i).start, start);
+    if (overlap > 0) {
+      handoverTime += overlap;
+    }
+  }
+  return handoverTime;
 }
 
 }  // Namespace ns3
@@ -21,14 +21,21 @@
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include "adapation-bola.h"
 #include "adapation-constbitrate.h"
 #include "adapation-festive.h"
+#include "adapation-mpc.h"
 #include "adapation-sara.h"
 #include "adapation-tobasco.h"
 #include "adapation-tomato.h"
+#include "adapation-viewport.h"
+#include "adapation-neural.h"
 #include "bandwidth-avginchunk.h"
 #include "bandwidth-avgintime.h"
+#include "bandwidth-ensemble.h"
 #include "bandwidth-harmonic.h"
+#include "bandwidth-kalman.h"
 #include "bandwidth-longavg.h"
 #include "bandwidth-wharmonic.h"
 #include "ns3/application.h"
@@ -39,6 +46,8 @@
 #include "ns3/traced-callback.h"
 #include "tcp-stream-adaptation.h"
 #include "tcp-stream-bandwidth.h"
+#include "tcp-stream-coordinator.h"
+#include "tcp-stream-handover.h"
 #include "tcp-stream-interface.h"
 #include "tcp-stream-userinfo.h"
 #include "userinfo-prediction.h"
@@ -48,6 +57,49 @@ namespace ns3 {
 class Socket;
 class Packet;
 
+/**
+ * \ingroup tcpStream
+ * \brief What the client knows about one of the servers it may download from.
+ */
+struct streamServer {
+  Address address;   //!< address of the server
+  uint16_t port;     //!< port of the server
+  Ptr<Socket> socket;  //!< connection to the server
+  bool connected;    //!< true once the connection is established
+  double rtt;  //!< smoothed time in microseconds from sending a request to
+               //!< the first byte of the response, -1 before the first one
+  uint32_t activeRequests;  //!< requests the server was serving at its last
+                            //!< load report
+  uint64_t backlogBytes;    //!< bytes the server had left to send for them
+  uint32_t segments;        //!< segments requested from the server
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief How a handover of the UE of a client ended.
+ */
+enum handoverOutcome {
+  handoverOngoing,     //!< it has not ended yet
+  handoverOk,          //!< the UE is connected to the target cell
+  handoverFailed,      //!< the UE could not connect to the target cell
+  handoverUnfinished   //!< it had not ended when the next one started or
+                       //!< the application stopped
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief A handover of the UE of a client.
+ */
+struct handoverRecord {
+  int64_t start;  //!< microseconds, when the UE left the source cell
+  int64_t end;    //!< microseconds, when it ended, -1 while ongoing
+  handoverOutcome outcome;  //!< how it ended
+  uint16_t source;  //!< cell Id
+  uint16_t target;  //!< cell Id
+  uint32_t prebuffered;  //!< decisions the cap to build up the buffer
+                         //!< lowered since the previous handover
+};
+
 /**
  * \ingroup tcpStream
  * \brief A Tcp Stream client
@@ -64,18 +116,45 @@ class TcpStreamClient : public Application {
   TcpStreamClient();
   virtual ~TcpStreamClient();
 
+  /**
+   * \brief How the client chooses the server for the next segment.
+   */
+  enum serverSelection {
+    RTT,   //!< the server with the lowest smoothed response time
+    LOAD,  //!< the server with the lowest reported backlog
+    HASH   //!< consistent hashing on viewpoint and segment index
+  };
+
   /**
    * \brief Set the adaptation algorithm which this client instance should use.
    *
-   * A new adaptation algorithm object is created, by calling a constructor of
-   * an existing subclass of AdaptationAlgorithm.
+   * The adaptation algorithm, bandwidth estimator and viewport predictor are
+   * created through their AlgorithmRegistry. algorithm is either one of the
+   * presets (tobasco, tobascoL, tomato, festive, sara, mpc, bola, viewport,
+   * neural, constbitrateT, constbitrateL, constbitrateW, constbitrateH,
+   * constbitrateWH), which fix all three, or the TypeId name of an
+   * adaptation algorithm, e.g. ns3::SaraAlgorithm, which is combined with
+   * the estimator and predictor of the BandwidthAlgorithm and
+   * UserinfoAlgorithm attributes.
    *
-   * \param algorithm the name of the algorithm to use for instantiating an
-   * adaptation algorithm object.
+   * \param algorithm the name of the preset or adaptation algorithm to use.
    */
   void Initialise(std::string algorithm, uint16_t clientId,
                   const Ptr<PhyRxStatsCalculator> ccrossLayerInfo);
 
+  /**
+   * \brief Resolve an algorithm name as Initialise does.
+   * \param algorithm the name of the preset or adaptation algorithm
+   * \param adaptation set to the adaptation algorithm
+   * \param bandwidth set to the bandwidth estimator of a preset, unchanged
+   * for an adaptation algorithm
+   * \param userinfo set to the viewport predictor of a preset, unchanged for
+   * an adaptation algorithm
+   * \return false if algorithm names neither
+   */
+  static bool LookupAlgorithms(std::string algorithm, TypeId &adaptation,
+                               TypeId &bandwidth, TypeId &userinfo);
+
   /**
    * \brief Set the remote address and port
    * \param ip remote IPv4 address
@@ -95,10 +174,61 @@ class TcpStreamClient : public Application {
    */
   void SetRemote(Address ip, uint16_t port);
   /**
-   * \brief Set the remote address and port
-   * \param ip remote IP address
-   * \param port remote port
+   * \brief Add a server the client may download segments from, in addition
+   * to the remote address. The client connects to all servers and chooses one
+   * of them for every segment according to ServerSelection.
+   * \param ip server IP address
+   * \param port server port
    */
+  void AddServer(Address ip, uint16_t port);
+
+  /**
+   * \brief Set the coordinators of the cells the UE may be served by. At a
+   * handover the client leaves the coordinator of the source cell and joins
+   * the one of the target cell; the Coordinator attribute is the one of the
+   * cell the UE is attached to at the start.
+   * \param coordinators the coordinator of every cell, by cell Id
+   */
+  void SetCoordinators(
+      const std::map<uint16_t, Ptr<CellCoordinator>> &coordinators);
+
+  /**
+   * \brief Trace sink of the HandoverStart source of the LteUeRrc of the UE.
+   * \param imsi of the UE
+   * \param cellId the source cell
+   * \param rnti of the UE in the source cell
+   * \param targetCellId the target cell
+   */
+  void NotifyHandoverStart(uint64_t imsi, uint16_t cellId, uint16_t rnti,
+                           uint16_t targetCellId);
+  /**
+   * \brief Trace sink of the HandoverEndOk source of the LteUeRrc of the UE.
+   * \param imsi of the UE
+   * \param cellId the target cell
+   * \param rnti of the UE in the target cell
+   */
+  void NotifyHandoverEndOk(uint64_t imsi, uint16_t cellId, uint16_t rnti);
+  /**
+   * \brief Trace sink of the HandoverEndError source of the LteUeRrc of the
+   * UE.
+   * \param imsi of the UE
+   * \param cellId the target cell
+   * \param rnti of the UE in the target cell
+   */
+  void NotifyHandoverEndError(uint64_t imsi, uint16_t cellId, uint16_t rnti);
+  /**
+   * \brief Trace sink of the ReportUeMeasurements source of the LteUePhy of
+   * the UE, which feeds the handover prediction.
+   * \param rnti of the UE
+   * \param cellId the cell measured
+   * \param rsrp in dBm
+   * \param rsrq in dB
+   * \param servingCell true for the serving cell
+   * \param componentCarrierId of the measurement
+   */
+  void NotifyUeMeasurements(uint16_t rnti, uint16_t cellId, double rsrp,
+                            double rsrq, bool servingCell,
+                            uint8_t componentCarrierId);
 
  protected:
   virtual void DoDispose(void);
@@ -128,9 +258,12 @@ class TcpStreamClient : public Application {
     init
   };
 
-  AdaptationAlgorithm *algo;
-  BandwidthAlgorithm *bandwidthAlgo;  // add in 12-27
-  UserinfoAlgorithm *userinfoAlgo;    // add in 12-28
+  Ptr<AdaptationAlgorithm> algo;
+  Ptr<BandwidthAlgorithm> bandwidthAlgo;  // add in 12-27
+  Ptr<UserinfoAlgorithm> userinfoAlgo;    // add in 12-28
+  TypeId m_adaptationTid;  //!< Adaptation algorithm if no preset is used
+  TypeId m_bandwidthTid;   //!< Bandwidth estimator if no preset is used
+  TypeId m_userinfoTid;    //!< Viewport predictor if no preset is used
   Ptr<PhyRxStatsCalculator> m_crossLayerInfo;
 
   virtual void StartApplication(void);
@@ -223,6 +356,47 @@ playbackFinished-> terminal is performed, as explained before.
    */
   template <typename T>
   void Send(T &message);
+  /**
+   * \brief Request the next segment from the server.
+   *
+   * The request contains the size of the segment m_segmentCounter in
+   * representation m_currentRepIndex, followed by its playback deadline and
+   * m_schedulingWeight, which the server uses to schedule its transmissions,
+   * and the viewpoint, representation and index of the segment.
+   * If the server is already pushing this segment in this representation, the
+   * push is confirmed instead. With m_serverPush, the request also announces
+   * the next segment in the current representation for the server to push.
+   */
+  void RequestSegment();
+  /**
+   * \brief Tell the server to stop pushing the announced segment, because the
+   * next download is delayed.
+   */
+  void CancelPush();
+  /**
+   * \brief The point in time in microseconds when the segment to be requested
+   * next is needed for playback.
+   *
+   * This is the current time if playback has not started yet or is stalled,
+   * otherwise the time when the segment currently played and all segments
+   * waiting in the buffer have been played.
+   */
+  int64_t GetPlaybackDeadline();
+  /**
+   * \brief Choose the server to request the segment m_segmentCounter from.
+   *
+   * Only connected servers are chosen. With RTT and LOAD, servers without a
+   * sample yet are tried first.
+   *
+   * \return the index of the server in m_servers
+   */
+  uint32_t SelectServer();
+  /**
+   * \brief Place every server on the hash ring with a number of virtual
+   * nodes, so segments are spread evenly and a server going away only moves
+   * its own segments.
+   */
+  void BuildHashRing();
   /**
    * \brief Handle a packet reception.
    *
@@ -311,9 +485,10 @@ playbackFinished-> terminal is performed, as explained before.
    * \brief Log throughput information about single arriving TCP packets
    *
    * - arrival time of packet
-   * - size of packet
+   * - size of packet, without the bytes the server pushed
+   * - bytes of the packet the server pushed, only logged with m_serverPush
    */
-  void LogThroughput(uint32_t packetSize);
+  void LogThroughput(uint32_t packetSize, uint32_t pushedSize);
   /*
    * \brief Log information about playback process
    *
@@ -334,6 +509,28 @@ playbackFinished-> terminal is performed, as explained before.
    * provided.
    */
   void LogAdaptation(algorithmReply answer);
+  /**
+   * \brief Log a handover once HandoverRebufferWindow has passed after it,
+   * with the rebuffering time from its start to the end of the window.
+   * \param index of the handover in m_handovers
+   */
+  void LogHandover(uint32_t index);
+  /**
+   * \brief End the ongoing handover, if any, now and log it once
+   * HandoverRebufferWindow has passed.
+   * \param outcome how it ended
+   */
+  void EndHandover(handoverOutcome outcome);
+  /**
+   * \brief Attach to m_coordinator with the ladder the client streams: the
+   * one of the viewpoint of the next segment, or that of every face together
+   * if the algorithm requests all of them.
+   */
+  void AttachToCoordinator();
+  /**
+   * \return the time in microseconds of the handovers within start to end
+   */
+  int64_t GetHandoverTime(int64_t start, int64_t end) const;
   /*
    * \brief Open log output files with streams.
    *
@@ -347,12 +544,31 @@ playbackFinished-> terminal is performed, as explained before.
   std::string ChoseInfoPath(int64_t infoindex);
   void GetInfo();
 
+  /**
+   * \brief Get the size in bytes of the segment being downloaded, i.e. the
+   * sum of its faces if every face is a separate object.
+   */
+  int64_t GetSegmentBytes();
+  /**
+   * \brief Request face m_currentFace of the segment being downloaded.
+   */
+  void RequestFace();
+
   uint32_t m_dataSize;  //!< packet payload size
   uint8_t *m_data;      //!< packet payload data
 
-  Ptr<Socket> m_socket;   //!< Socket
+  Ptr<Socket> m_socket;   //!< Socket of the server currently downloaded from
   Address m_peerAddress;  //!< Remote peer address
   uint16_t m_peerPort;    //!< Remote peer port
+  std::vector<std::pair<Address, uint16_t>>
+      m_additionalServers;  //!< Servers added with AddServer
+  std::vector<streamServer> m_servers;  //!< The remote peer followed by the
+                                        //!< additional servers
+  uint32_t m_server;  //!< Index of the server currently downloaded from
+  uint32_t m_connectedServers;  //!< Number of servers connected so far
+  serverSelection m_serverSelection;  //!< How the server is chosen
+  std::map<uint64_t, uint32_t>
+      m_hashRing;  //!< Position on the ring -> index of the server
 
   uint16_t m_clientId;      //!< The Id of this client, for logging purposes
   uint16_t m_simulationId;  //!< The Id of this simulation, for logging purposes
@@ -386,6 +602,38 @@ playbackFinished-> terminal is performed, as explained before.
   int64_t
       m_highestRepIndex;  //!< This is the index of the highest representation
   uint64_t m_segmentDuration;  //!< The duration of a segment in microseconds
+  double m_schedulingWeight;   //!< The weight sent with every request for the
+                               //!< server's weighted-fair scheduler
+  bool m_serverPush;        //!< True if the server may push the next segment
+  int64_t m_pushSegment;    //!< Index of the segment announced for push, -1
+                            //!< if none
+  int64_t m_pushRepIndex;   //!< Representation of the announced segment
+  int64_t m_pushBytesPending;  //!< Bytes of the announced segment received
+                               //!< before it was confirmed
+  int64_t m_pushFirstByte;  //!< Point in time in microseconds when the first
+                            //!< byte of the announced segment arrived
+  bool m_pushAccepted;      //!< True if the segment being downloaded is a
+                            //!< confirmed push
+  uint64_t m_pushedBytesUsed;       //!< Pushed bytes that became part of a
+                                    //!< downloaded segment
+  uint64_t m_pushedBytesDiscarded;  //!< Pushed bytes of segments that were
+                                    //!< not confirmed
+  std::string m_segmentSizeFiles;  //!< Comma separated segment size files,
+                                   //!< one per viewpoint
+  std::string m_userInfoFile;  //!< File with the viewpoint of every segment
+  Ptr<CellCoordinator> m_coordinator;  //!< Shares the cell among the
+                                       //!< clients, 0 if there is none
+  std::map<uint16_t, Ptr<CellCoordinator>>
+      m_coordinators;  //!< The coordinator of every cell, by cell Id
+  bool m_coordinated;  //!< Whether the client is attached to m_coordinator
+  int64_t m_coordinatedViewpoint;  //!< Viewpoint whose ladder m_coordinator
+                                   //!< sizes the client on, -1 for all faces
+  std::vector<int64_t>
+      m_faceRepIndex;  //!< Representation of every face of the segment being
+                       //!< downloaded, empty if it is one object
+  uint32_t m_currentFace;  //!< Index of the face being downloaded
+  int64_t m_faceBytesEnd;  //!< Value of m_bytesReceived at which the current
+                           //!< face is complete
 
   std::string infoStatusTemp;              // add
   std::string segmentSizeFile;             // add
@@ -403,6 +651,26 @@ playbackFinished-> terminal is performed, as explained before.
       throughputLog;  //!< Output stream for logging throughput information
   std::ofstream bufferUnderrunLog;  //!< Output stream for logging starting and
                                     //!< ending of buffer underruns
+  std::ofstream handoverLog;  //!< Output stream for logging handovers, opened
+                              //!< at the first one
+  std::string m_handoverLogName;  //!< File of handoverLog
+
+  std::vector<handoverRecord> m_handovers;  //!< The handovers of the UE
+  std::vector<std::pair<int64_t, int64_t>>
+      m_underruns;  //!< Start and end in microseconds of every buffer
+                    //!< underrun, for the handover log
+  HandoverPredictor m_handoverPredictor;  //!< Predicts the next handover
+  int64_t m_handoverHorizon;  //!< Build up the buffer if a handover is
+                              //!< predicted within this time in
+                              //!< microseconds, never if 0
+  double m_handoverHysteresis;  //!< dB, of the A3 handover of the eNBs
+  int64_t m_handoverTimeToTrigger;  //!< microseconds, of the A3 handover
+  double m_handoverPrebufferFactor;  //!< Share of the estimate the bitrate is
+                                     //!< capped at to build up the buffer
+  int64_t m_handoverRebufferWindow;  //!< microseconds after a handover whose
+                                     //!< buffer underruns are attributed to it
+  uint32_t m_prebuffered;  //!< Decisions the pre-buffering lowered since
+                           //!< the last handover
 
   uint64_t m_downloadRequestSent =
       0;  //!< Logging the point in time in microseconds when a download request
@@ -416,6 +684,12 @@ playbackFinished-> terminal is performed, as explained before.
                           //!< microseconds
 
   Ptr<PhyRxStatsCalculator> cm_crossLayerInfo;
+  uint64_t m_imsi;  //!< IMSI of the UE, whose transport blocks
+                    //!< cm_crossLayerInfo reports
+  std::vector<std::pair<int64_t, int64_t>>
+      m_pauses;  //!< Begin and end in ms of the pauses between downloads
+  int64_t m_traceBegin;   //!< ms, when the first decision was made
+  int64_t m_lastEndTime;  //!< ms, when the last segment was received
 };
 
 }  // namespace ns3
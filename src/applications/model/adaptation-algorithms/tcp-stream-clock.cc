@@ -0,0 +1,37 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-clock.h"
+
+namespace ns3 {
+
+int64_t AlgorithmClock::Now(void) {
+  const int64_t *now = GetThreadClock();
+  return now != 0 ? *now : Simulator::Now().GetMicroSeconds();
+}
+
+void AlgorithmClock::SetThreadClock(const int64_t *now) {
+  GetThreadClock() = now;
+}
+
+const int64_t *&AlgorithmClock::GetThreadClock(void) {
+  static thread_local const int64_t *now = 0;
+  return now;
+}
+
+} // namespace ns3
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_CLOCK_H
+#define TCP_STREAM_CLOCK_H
+
+#include "ns3/simulator.h"
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief The time the adaptation algorithms, bandwidth estimators and
+ * viewport predictors decide at.
+ *
+ * Inside the simulator this is Simulator::Now(). Programs which drive the
+ * algorithms without the simulator, like the trace-driven evaluator in
+ * scratch/abr-eval, point the calling thread at their own clock instead, so
+ * that several threads can each run a streaming session of their own.
+ */
+class AlgorithmClock {
+public:
+  /**
+   * \return the time in microseconds
+   */
+  static int64_t Now(void);
+
+  /**
+   * \brief Make the algorithms called from this thread read the time from
+   * now, in microseconds, instead of the simulator.
+   * \param now the clock of the thread, 0 to use the simulator again
+   */
+  static void SetThreadClock(const int64_t *now);
+
+private:
+  /**
+   * \return the clock of the calling thread, 0 if it uses the simulator
+   */
+  static const int64_t *&GetThreadClock(void);
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_CLOCK_H */
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "tcp-stream-coordinator.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("CellCoordinator");
+NS_OBJECT_ENSURE_REGISTERED(CellCoordinator);
+
+TypeId CellCoordinator::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::CellCoordinator")
+          .SetParent<Object>()
+          .SetGroupName("Applications")
+          .AddConstructor<CellCoordinator>()
+          .AddAttribute("Interval",
+                        "Time between two measurements of the cell load",
+                        TimeValue(MilliSeconds(500)),
+                        MakeTimeAccessor(&CellCoordinator::m_interval),
+                        MakeTimeChecker(MilliSeconds(1)))
+          .AddAttribute(
+              "SafetyFactor",
+              "Share of the estimated capacity which is divided among the "
+              "clients",
+              DoubleValue(0.9),
+              MakeDoubleAccessor(&CellCoordinator::m_safetyFactor),
+              MakeDoubleChecker<double>(0.0))
+          .AddAttribute(
+              "Smoothing",
+              "Weight of a new capacity sample in the moving average",
+              DoubleValue(0.3),
+              MakeDoubleAccessor(&CellCoordinator::m_smoothing),
+              MakeDoubleChecker<double>(0.0, 1.0));
+  return tid;
+}
+
+CellCoordinator::CellCoordinator()
+    : m_safetyFactor(0.9), m_smoothing(0.3), m_cellId(0), m_dlBandwidth(0),
+      m_lastLoad(), m_capacity(0) {
+  NS_LOG_FUNCTION(this);
+}
+
+void CellCoordinator::SetCell(Ptr<PhyRxStatsCalculator> phyRxStats,
+                              uint16_t cellId, uint16_t dlBandwidth) {
+  NS_LOG_FUNCTION(this << cellId << dlBandwidth);
+  m_phyRxStats = phyRxStats;
+  m_cellId = cellId;
+  m_dlBandwidth = dlBandwidth;
+  m_amc = CreateObject<LteAmc>();
+  m_lastLoad = m_phyRxStats->GetDlCellLoad(m_cellId);
+}
+
+void CellCoordinator::Attach(uint32_t clientId,
+                             const std::vector<double> &bitrates,
+                             double weight) {
+  NS_LOG_FUNCTION(this << clientId << weight);
+  NS_ASSERT_MSG(!bitrates.empty(), "A client needs a representation");
+  const bool attached = m_clients.find(clientId) != m_clients.end();
+  coordinatedClient &client = m_clients[clientId];
+  client.bitrates = bitrates;
+  client.weight = weight;
+  if (!attached) {
+    client.cap = 0;
+  }
+  if (!m_updateEvent.IsRunning() && m_phyRxStats != 0) {
+    m_lastLoad = m_phyRxStats->GetDlCellLoad(m_cellId);
+    m_updateEvent =
+        Simulator::Schedule(m_interval, &CellCoordinator::Update, this);
+  }
+}
+
+void CellCoordinator::Detach(uint32_t clientId) {
+  NS_LOG_FUNCTION(this << clientId);
+  m_clients.erase(clientId);
+  if (m_clients.empty()) {
+    m_updateEvent.Cancel();
+  }
+}
+
+double CellCoordinator::GetCap(uint32_t clientId) const {
+  std::map<uint32_t, coordinatedClient>::const_iterator it =
+      m_clients.find(clientId);
+  return it == m_clients.end() ? 0 : it->second.cap;
+}
+
+double CellCoordinator::GetCapacity(void) const { return m_capacity; }
+
+std::vector<int64_t> CellCoordinator::Allocate(
+    const std::vector<const std::vector<double> *> &bitrates,
+    const std::vector<double> &weights, double budget) {
+  const uint32_t clients = bitrates.size();
+  std::vector<int64_t> allocation(clients, 0);
+  double spent = 0;
+  for (uint32_t c = 0; c < clients; c++) {
+    spent += bitrates[c]->front();
+  }
+  // every higher representation of a client is a candidate, not only the
+  // next one, so an uneven step in a ladder does not stall the client
+  while (true) {
+    int64_t bestClient = -1;
+    int64_t bestRep = 0;
+    double bestRatio = 0;
+    for (uint32_t c = 0; c < clients; c++) {
+      const std::vector<double> &ladder = *bitrates[c];
+      const double current = ladder[allocation[c]];
+      for (uint32_t r = allocation[c] + 1; r < ladder.size(); r++) {
+        double extra = ladder[r] - current;
+        if (spent + extra > budget) {
+          break;
+        }
+        double gain = weights[c] * std::log(ladder[r] / current);
+        double ratio =
+            extra > 0 ? gain / extra : std::numeric_limits<double>::max();
+        if (gain > 0 && ratio > bestRatio) {
+          bestClient = c;
+          bestRep = r;
+          bestRatio = ratio;
+        }
+      }
+    }
+    if (bestClient < 0) {
+      break;
+    }
+    spent += (*bitrates[bestClient])[bestRep] -
+             (*bitrates[bestClient])[allocation[bestClient]];
+    allocation[bestClient] = bestRep;
+  }
+  return allocation;
+}
+
+void CellCoordinator::Update(void) {
+  NS_LOG_FUNCTION(this);
+  PhyRxStatsCalculator::CellLoad load = m_phyRxStats->GetDlCellLoad(m_cellId);
+  uint64_t tbs = 0;
+  double bits = 0;
+  for (uint32_t mcs = 0; mcs < PhyRxStatsCalculator::kDlMcsCount; mcs++) {
+    uint64_t count = load.mcsTbs[mcs] - m_lastLoad.mcsTbs[mcs];
+    if (count > 0) {
+      tbs += count;
+      bits += (double)count * m_amc->GetDlTbSizeFromMcs(mcs, m_dlBandwidth);
+    }
+  }
+  if (tbs > 0) {
+    // a TTI is 1 ms
+    double sample = 1000.0 * bits / tbs;
+    m_capacity = m_capacity > 0 ? m_smoothing * sample +
+                                      (1 - m_smoothing) * m_capacity
+                                : sample;
+  }
+  m_lastLoad = load;
+
+  if (m_capacity > 0) {
+    std::vector<const std::vector<double> *> bitrates;
+    std::vector<double> weights;
+    std::map<uint32_t, coordinatedClient>::iterator it;
+    for (it = m_clients.begin(); it != m_clients.end(); ++it) {
+      bitrates.push_back(&it->second.bitrates);
+      weights.push_back(it->second.weight);
+    }
+    std::vector<int64_t> allocation =
+        Allocate(bitrates, weights, m_safetyFactor * m_capacity);
+    uint32_t c = 0;
+    for (it = m_clients.begin(); it != m_clients.end(); ++it, ++c) {
+      it->second.cap = it->second.bitrates[allocation[c]];
+    }
+    NS_LOG_INFO("Cell " << m_cellId << ": capacity " << m_capacity
+                        << " bps, " << m_clients.size() << " clients");
+  }
+
+  if (!m_clients.empty()) {
+    m_updateEvent =
+        Simulator::Schedule(m_interval, &CellCoordinator::Update, this);
+  }
+}
+
+void CellCoordinator::DoDispose(void) {
+  NS_LOG_FUNCTION(this);
+  m_updateEvent.Cancel();
+  m_phyRxStats = 0;
+  m_amc = 0;
+  m_clients.clear();
+  Object::DoDispose();
+}
+
+} // namespace ns3
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TCP_STREAM_COORDINATOR_H
+#define TCP_STREAM_COORDINATOR_H
+
+#include "ns3/event-id.h"
+#include "ns3/lte-amc.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/phy-rx-stats-calculator.h"
+#include "ns3/ptr.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Shares the downlink of a cell among the clients streaming in it.
+ *
+ * Every Interval the coordinator reads the MCS of the transport blocks its
+ * cell delivered from the PhyRxStatsCalculator and estimates the capacity of
+ * the cell as the average size of a transport block over all resource blocks
+ * of the cell at these MCS, per TTI of 1 ms, smoothed with the weight
+ * Smoothing. The estimate follows the channel quality of the UEs the cell
+ * schedules but not how much they download, so neither the caps nor clients
+ * pausing with a full buffer pull it down. SafetyFactor times the capacity
+ * is then divided among
+ * the attached clients: starting from the lowest representation of every
+ * client, the upgrade with the highest gain in weight * ln(bitrate) per bit
+ * is granted while it fits, which maximises the summed utility, i.e. the
+ * aggregate quality under proportional fairness. The bitrate a client is
+ * granted is its cap until the next update.
+ *
+ * A TcpStreamClient with a Coordinator attaches when it starts and detaches
+ * when it stops, with the ladder of the viewpoint it streams, attaching again
+ * when that changes, or with the sums of the bitrates of all faces if its
+ * algorithm requests every face of a segment. Before every decision it
+ * passes the smaller of its bandwidth estimate and its cap to
+ * AdaptationAlgorithm::GetNextRep. It also passes the highest representation
+ * below the cap of every viewpoint to AdaptationAlgorithm::SetMaxRepIndex,
+ * so buffer-based algorithms which ignore the estimate follow the cap as
+ * well, or, for all faces, the cap itself to
+ * AdaptationAlgorithm::SetMaxBitrate, which bounds the faces together.
+ */
+class CellCoordinator : public Object {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  CellCoordinator();
+
+  /**
+   * \brief Measure the load of a cell.
+   * \param phyRxStats the PHY statistics of the simulation
+   * \param cellId the cell whose load is measured
+   * \param dlBandwidth the downlink bandwidth of the cell in resource blocks
+   */
+  void SetCell(Ptr<PhyRxStatsCalculator> phyRxStats, uint16_t cellId,
+               uint16_t dlBandwidth);
+
+  /**
+   * \brief Add a client to the clients sharing the cell, or replace the
+   * ladder and weight of one already attached, which keeps its cap until the
+   * next update.
+   * \param clientId the client
+   * \param bitrates the average bitrates of its representations in bps,
+   * lowest first
+   * \param weight the share of the client relative to the other clients
+   */
+  void Attach(uint32_t clientId, const std::vector<double> &bitrates,
+              double weight);
+
+  /**
+   * \brief Remove a client, its share goes to the others with the next
+   * update.
+   */
+  void Detach(uint32_t clientId);
+
+  /**
+   * \return the bitrate in bps the client should not exceed, 0 while the
+   * capacity of the cell is unknown
+   */
+  double GetCap(uint32_t clientId) const;
+
+  /**
+   * \return the estimated downlink capacity of the cell in bps
+   */
+  double GetCapacity(void) const;
+
+  /**
+   * \brief Divide a budget among clients.
+   * \param bitrates the bitrate ladder of every client
+   * \param weights the weight of every client
+   * \param budget the bitrate in bps all clients may use together
+   * \return the representation of every client; the lowest ones if even
+   * they exceed the budget
+   */
+  static std::vector<int64_t>
+  Allocate(const std::vector<const std::vector<double> *> &bitrates,
+           const std::vector<double> &weights, double budget);
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  /**
+   * \brief Measure the capacity since the last update and recompute the
+   * caps.
+   */
+  void Update(void);
+
+  /**
+   * \brief A client sharing the cell.
+   */
+  struct coordinatedClient {
+    std::vector<double> bitrates; //!< its ladder in bps
+    double weight;
+    double cap; //!< bps, 0 if not allocated yet
+  };
+
+  Time m_interval;
+  double m_safetyFactor; //!< share of the capacity which is allocated
+  double m_smoothing;    //!< weight of a new capacity sample
+  Ptr<PhyRxStatsCalculator> m_phyRxStats;
+  uint16_t m_cellId;
+  uint16_t m_dlBandwidth; //!< in resource blocks
+  Ptr<LteAmc> m_amc;      //!< for the transport block sizes
+  PhyRxStatsCalculator::CellLoad m_lastLoad; //!< load at the last update
+  double m_capacity;                          //!< bps, 0 if unknown
+  std::map<uint32_t, coordinatedClient> m_clients;
+  EventId m_updateEvent;
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_COORDINATOR_H */
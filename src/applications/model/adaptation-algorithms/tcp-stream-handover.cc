@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-handover.h"
+#include <algorithm>
+
+namespace ns3 {
+
+HandoverPredictor::HandoverPredictor()
+    : m_hysteresis(3.0), m_timeToTrigger(256000), m_smoothing(0.3),
+      m_maxAge(1000000), m_hasServing(false), m_serving(0) {}
+
+HandoverPredictor::HandoverPredictor(double hysteresis,
+                                     int64_t timeToTrigger, double smoothing)
+    : m_hysteresis(hysteresis), m_timeToTrigger(timeToTrigger),
+      m_smoothing(smoothing), m_maxAge(1000000), m_hasServing(false),
+      m_serving(0) {}
+
+void HandoverPredictor::Measure(int64_t time, uint16_t cellId, double rsrp,
+                                bool serving) {
+  if (serving) {
+    m_hasServing = true;
+    m_serving = cellId;
+  }
+  std::map<uint16_t, cellState>::iterator it = m_cells.find(cellId);
+  if (it == m_cells.end() || time - it->second.time > m_maxAge) {
+    cellState state = {time, rsrp, 0.0};
+    m_cells[cellId] = state;
+    return;
+  }
+  cellState &state = it->second;
+  if (time <= state.time) {
+    return;
+  }
+  const double level = state.rsrp + m_smoothing * (rsrp - state.rsrp);
+  const double slope = (level - state.rsrp) * 1000000.0 / (time - state.time);
+  state.slope += m_smoothing * (slope - state.slope);
+  state.rsrp = level;
+  state.time = time;
+}
+
+int64_t HandoverPredictor::TimeToHandover(int64_t time) const {
+  if (!m_hasServing) {
+    return -1;
+  }
+  std::map<uint16_t, cellState>::const_iterator serving =
+      m_cells.find(m_serving);
+  if (serving == m_cells.end() || time - serving->second.time > m_maxAge) {
+    return -1;
+  }
+  int64_t next = -1;
+  for (std::map<uint16_t, cellState>::const_iterator it = m_cells.begin();
+       it != m_cells.end(); it++) {
+    if (it->first == m_serving || time - it->second.time > m_maxAge) {
+      continue;
+    }
+    const double margin = it->second.rsrp - serving->second.rsrp;
+    const double closing = it->second.slope - serving->second.slope;
+    int64_t until;
+    if (margin >= m_hysteresis) {
+      until = m_timeToTrigger;
+    } else if (closing > 0) {
+      until = (int64_t)((m_hysteresis - margin) / closing * 1000000.0) +
+              m_timeToTrigger;
+    } else {
+      continue;
+    }
+    next = next < 0 ? until : std::min(next, until);
+  }
+  return next;
+}
+
+} // namespace ns3
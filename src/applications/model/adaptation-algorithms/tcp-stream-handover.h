@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_HANDOVER_H
+#define TCP_STREAM_HANDOVER_H
+
+#include <stdint.h>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Predicts the next handover of a UE from its RSRP measurements.
+ *
+ * The UE measures the RSRP of its serving cell and of the neighbours it
+ * hears every measurement period. The predictor smooths the level and the
+ * slope of every cell and extrapolates the margin of the best neighbour over
+ * the serving cell linearly: an A3 handover is triggered once the margin
+ * has exceeded the hysteresis for the time to trigger.
+ */
+class HandoverPredictor {
+public:
+  HandoverPredictor();
+
+  /**
+   * \param hysteresis of the A3 event in dB
+   * \param timeToTrigger of the A3 event in microseconds
+   * \param smoothing weight of a new measurement in the smoothed level and
+   * slope, in (0, 1]
+   */
+  HandoverPredictor(double hysteresis, int64_t timeToTrigger,
+                    double smoothing);
+
+  /**
+   * \param time of the measurement in microseconds
+   * \param cellId the cell measured
+   * \param rsrp its RSRP in dBm
+   * \param serving true for the serving cell
+   */
+  void Measure(int64_t time, uint16_t cellId, double rsrp, bool serving);
+
+  /**
+   * \return the predicted time in microseconds from time to the next
+   * handover, -1 if none is expected
+   */
+  int64_t TimeToHandover(int64_t time) const;
+
+private:
+  struct cellState {
+    int64_t time; //!< of the last measurement, in microseconds
+    double rsrp;  //!< smoothed, in dBm
+    double slope; //!< smoothed, in dB/s
+  };
+
+  double m_hysteresis;
+  int64_t m_timeToTrigger;
+  double m_smoothing;
+  int64_t m_maxAge; //!< measurements older than this are ignored
+  bool m_hasServing;
+  uint16_t m_serving;
+  std::map<uint16_t, cellState> m_cells;
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_HANDOVER_H */
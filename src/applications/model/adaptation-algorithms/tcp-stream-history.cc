@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "tcp-stream-history.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+ThroughputHistory::ThroughputHistory() {
+  // the prefix sums start with the empty prefix
+  m_bytes.push_back(0);
+  m_busyTime.push_back(0);
+}
+
+void ThroughputHistory::Add(int64_t start, int64_t end, int64_t bytes) {
+  NS_ASSERT_MSG(m_start.empty() ||
+                    (start >= m_start.back() && end >= m_end.back()),
+                "Downloads must be added in the order they happen");
+  m_start.push_back(start);
+  m_end.push_back(end);
+  m_bytes.push_back(m_bytes.back() + bytes);
+  m_busyTime.push_back(m_busyTime.back() + (end - start));
+}
+
+uint32_t ThroughputHistory::GetSize(void) const { return m_start.size(); }
+
+bool ThroughputHistory::Find(int64_t t1, int64_t t2, uint32_t &first,
+                             uint32_t &last) const {
+  first = std::lower_bound(m_end.begin(), m_end.end(), t1) - m_end.begin();
+  last = std::upper_bound(m_start.begin(), m_start.end(), t2) -
+         m_start.begin();
+  return first < last;
+}
+
+double ThroughputHistory::GetThroughput(uint32_t first,
+                                        uint32_t last) const {
+  int64_t busyTime = m_busyTime[last] - m_busyTime[first];
+  if (busyTime <= 0) {
+    return 0;
+  }
+  return 8.0 * (m_bytes[last] - m_bytes[first]) * 1000000.0 / busyTime;
+}
+
+double ThroughputHistory::GetAverage(int64_t t1, int64_t t2) const {
+  uint32_t first, last;
+  if (!Find(t1, t2, first, last)) {
+    first = 0;
+    last = GetSize();
+  }
+  return GetThroughput(first, last);
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TCP_STREAM_HISTORY_H
+#define TCP_STREAM_HISTORY_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief The downloads of a session, indexed by time.
+ *
+ * Downloads are added in the order they happen, so their start and end
+ * times are both sorted. Next to them the history keeps the prefix sums of
+ * the bytes and of the busy time, the time spent downloading. The downloads
+ * overlapping a time window [t1, t2] are then found with two binary
+ * searches, the last one ending at t1 or later and the first one starting
+ * after t2, and their throughput is two subtractions: O(log n) however long
+ * the session, where scanning the downloads was O(n).
+ */
+class ThroughputHistory {
+public:
+  ThroughputHistory();
+
+  /**
+   * \brief Add a download, which must not start before the previous one.
+   * \param start time in microseconds of its first byte
+   * \param end time in microseconds of its last byte
+   * \param bytes its size
+   */
+  void Add(int64_t start, int64_t end, int64_t bytes);
+
+  uint32_t GetSize(void) const;
+
+  /**
+   * \brief Find the downloads at least partly in [t1, t2].
+   * \param first set to the first of them
+   * \param last set to the one after the last of them
+   * \return false if there are none
+   */
+  bool Find(int64_t t1, int64_t t2, uint32_t &first, uint32_t &last) const;
+
+  /**
+   * \return the bytes of the downloads [first, last) over their busy time,
+   * in bps, 0 if they took no time
+   */
+  double GetThroughput(uint32_t first, uint32_t last) const;
+
+  /**
+   * \return the throughput in bps of all downloads at least partly in
+   * [t1, t2], of all downloads if there are none
+   */
+  double GetAverage(int64_t t1, int64_t t2) const;
+
+private:
+  std::vector<int64_t> m_start;    //!< microseconds
+  std::vector<int64_t> m_end;      //!< microseconds
+  std::vector<int64_t> m_bytes;    //!< bytes before each download
+  std::vector<int64_t> m_busyTime; //!< microseconds before each download
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_HISTORY_H */
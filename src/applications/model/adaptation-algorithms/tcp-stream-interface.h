@@ -18,6 +18,8 @@
 #ifndef TCP_STREAM_INTERFACE_H
 #define TCP_STREAM_INTERFACE_H
 
+#include "tcp-stream-ladder.h"
+
 namespace ns3 {
 
 /*! \class algorithmReply tcp-stream-interface.h "model/tcp-stream-interface.h"
@@ -50,6 +52,11 @@ struct algorithmReply {
                              //!< segment shall be requested from server, only
                              //!< for logging purposes
   double estimateTh;
+  std::vector<int64_t>
+      faceRepIndex; //!< representation level index of every viewpoint, for
+                    //!< algorithms which request every viewpoint (e.g. cube
+                    //!< face) of a segment as a separate object, empty
+                    //!< otherwise
 };
 
 struct bandwidthAlgoReply // added in 12-27
@@ -57,6 +64,8 @@ struct bandwidthAlgoReply // added in 12-27
   int64_t bandwidthAlgoIndex; //!< bandwidthAvg = 1 bandwidthCrosslayer = 2
                               //!< default = 0
   double bandwidthEstimate;   //!< bandwidth estimation value
+  double bandwidthVariance = 0; //!< variance of the estimate in bps^2, 0 if
+                                //!< the estimator gives none
   int64_t decisionTime; //!< time in microsends when the bandwidth algorithm
                         //!< works, only for logging purposes
   int64_t
@@ -69,6 +78,10 @@ struct userinfoAlgoReply // added in 12-28
 {
   int64_t decisionTime; //!< time in microsends when the bandwidth algorithm
                         //!< works, only for logging purposes
+  int64_t viewpoint;    //!< predicted viewpoint of the segment to request,
+                        //!< -1 to keep the one of videoData::userInfo
+  double yaw;           //!< predicted yaw in degrees, for logging purposes
+  double pitch;         //!< predicted pitch in degrees, for logging purposes
 };
 /*! \class throughputData tcp-stream-interface.h "model/tcp-stream-interface.h"
  *  \ingroup tcpStream
@@ -90,6 +103,10 @@ struct throughputData {
                        //!< packet of a segment was received
   std::vector<int64_t>
       bytesReceived; //!< Number of bytes received, i.e. segment size
+  std::vector<int64_t>
+      handoverTime; //!< Time in microseconds between transmissionStart and
+                    //!< transmissionEnd the UE spent in handovers, when the
+                    //!< client is told of them; may be shorter than the others
 };
 
 /*! \class bufferData tcp-stream-interface.h "model/tcp-stream-interface.h"
@@ -135,6 +152,10 @@ struct videoData {
   int64_t segmentDuration; //!< duration of a segment in microseconds
   std::vector<int64_t> repIndex; // repIndex choosen
   std::vector<int64_t> userInfo; // userViewPoint
+  std::vector<BitrateLadder>
+      ladders; //!< index of the sizes and bitrates of every viewpoint,
+               //!< built from segmentSize and averageBitrate once they are
+               //!< read
 };
 
 /*! \class playbackData tcp-stream-interface.h "model/tcp-stream-interface.h"
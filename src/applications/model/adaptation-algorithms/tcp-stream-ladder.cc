@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-ladder.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+BitrateLadder::BitrateLadder() : m_reps(0), m_segments(0) {}
+
+BitrateLadder::BitrateLadder(
+    const std::vector<std::vector<int64_t>> &segmentSize,
+    const std::vector<double> &averageBitrate)
+    : m_reps(segmentSize.size()),
+      m_segments(segmentSize.empty() ? 0 : segmentSize[0].size()),
+      m_bitrates(averageBitrate) {
+  NS_ASSERT_MSG(averageBitrate.size() == segmentSize.size(),
+                "Every representation needs an average bitrate");
+  m_sizes.reserve(m_reps * m_segments);
+  m_prefix.reserve(m_reps * (m_segments + 1));
+  for (int64_t rep = 0; rep < m_reps; rep++) {
+    NS_ASSERT_MSG((int64_t)segmentSize[rep].size() == m_segments,
+                  "All representations need the same number of segments");
+    NS_ASSERT_MSG(rep == 0 || m_bitrates[rep] >= m_bitrates[rep - 1],
+                  "The representations have to be sorted by bitrate");
+    int64_t sum = 0;
+    m_prefix.push_back(0);
+    for (int64_t segment = 0; segment < m_segments; segment++) {
+      m_sizes.push_back(segmentSize[rep][segment]);
+      sum += segmentSize[rep][segment];
+      m_prefix.push_back(sum);
+    }
+  }
+
+  m_max.push_back(m_sizes);
+  for (int64_t span = 2; span <= m_segments; span *= 2) {
+    const std::vector<int64_t> &half = m_max.back();
+    std::vector<int64_t> level(m_sizes.size(), 0);
+    for (int64_t rep = 0; rep < m_reps; rep++) {
+      const int64_t base = rep * m_segments;
+      for (int64_t segment = 0; segment + span <= m_segments; segment++) {
+        level[base + segment] = std::max(half[base + segment],
+                                         half[base + segment + span / 2]);
+      }
+    }
+    m_max.push_back(level);
+  }
+
+  m_unsorted.reserve(m_segments + 1);
+  m_unsorted.push_back(0);
+  for (int64_t segment = 0; segment < m_segments; segment++) {
+    bool sorted = true;
+    for (int64_t rep = 1; rep < m_reps && sorted; rep++) {
+      sorted = segmentSize[rep][segment] >= segmentSize[rep - 1][segment];
+    }
+    m_unsorted.push_back(m_unsorted.back() + (sorted ? 0 : 1));
+  }
+}
+
+int64_t BitrateLadder::GetHighestRepIndex(void) const { return m_reps - 1; }
+
+int64_t BitrateLadder::GetSegmentCount(void) const { return m_segments; }
+
+double BitrateLadder::GetBitrate(int64_t rep) const {
+  NS_ASSERT(rep >= 0 && rep < m_reps);
+  return m_bitrates[rep];
+}
+
+const std::vector<double> &BitrateLadder::GetBitrates(void) const {
+  return m_bitrates;
+}
+
+int64_t BitrateLadder::GetSize(int64_t rep, int64_t segment) const {
+  NS_ASSERT(rep >= 0 && rep < m_reps && segment >= 0 &&
+            segment < m_segments);
+  return m_sizes[rep * m_segments + segment];
+}
+
+int64_t BitrateLadder::GetSize(int64_t rep, int64_t first,
+                               int64_t count) const {
+  NS_ASSERT(rep >= 0 && rep < m_reps && first >= 0);
+  const int64_t end = std::min(first + count, m_segments);
+  if (end <= first) {
+    return 0;
+  }
+  const int64_t base = rep * (m_segments + 1);
+  return m_prefix[base + end] - m_prefix[base + first];
+}
+
+int64_t BitrateLadder::GetMaxSize(int64_t rep, int64_t first,
+                                  int64_t count) const {
+  NS_ASSERT(rep >= 0 && rep < m_reps && first >= 0);
+  const int64_t end = std::min(first + count, m_segments);
+  if (end <= first) {
+    return 0;
+  }
+  // two runs of the largest power of two that fits cover the segments
+  uint32_t level = 0;
+  while (((int64_t)2 << level) <= end - first) {
+    level++;
+  }
+  const int64_t base = rep * m_segments;
+  return std::max(m_max[level][base + first],
+                  m_max[level][base + end - ((int64_t)1 << level)]);
+}
+
+int64_t BitrateLadder::GetHighestRepBelow(double bitrate) const {
+  int64_t rep =
+      std::upper_bound(m_bitrates.begin(), m_bitrates.end(), bitrate) -
+      m_bitrates.begin() - 1;
+  return std::max<int64_t>(rep, 0);
+}
+
+bool BitrateLadder::IsSorted(int64_t first, int64_t count) const {
+  NS_ASSERT(first >= 0);
+  const int64_t end = std::min(first + count, m_segments);
+  if (end <= first) {
+    return true;
+  }
+  return m_unsorted[end] == m_unsorted[first];
+}
+
+int64_t BitrateLadder::GetHighestRepFitting(int64_t first, int64_t count,
+                                            double bytes, int64_t lowest,
+                                            int64_t highest) const {
+  lowest = std::max<int64_t>(lowest, 0);
+  highest = std::min(highest, m_reps - 1);
+  if (IsSorted(first, count)) {
+    return SearchFitting(first, count, bytes, lowest, highest);
+  }
+  for (int64_t rep = highest; rep >= lowest; rep--) {
+    if (GetSize(rep, first, count) <= bytes) {
+      return rep;
+    }
+  }
+  return lowest - 1;
+}
+
+int64_t BitrateLadder::GetLastRepFitting(int64_t first, int64_t count,
+                                         double bytes, int64_t lowest,
+                                         int64_t highest) const {
+  lowest = std::max<int64_t>(lowest, 0);
+  highest = std::min(highest, m_reps - 1);
+  if (IsSorted(first, count)) {
+    return SearchFitting(first, count, bytes, lowest, highest);
+  }
+  for (int64_t rep = lowest; rep <= highest; rep++) {
+    if (GetSize(rep, first, count) > bytes) {
+      return rep - 1;
+    }
+  }
+  return highest;
+}
+
+int64_t BitrateLadder::SearchFitting(int64_t first, int64_t count,
+                                     double bytes, int64_t lowest,
+                                     int64_t highest) const {
+  // the sizes grow with the representation, so the ones that fit are a
+  // prefix of lowest to highest
+  int64_t fits = lowest - 1;
+  while (lowest <= highest) {
+    int64_t middle = lowest + (highest - lowest) / 2;
+    if (GetSize(middle, first, count) <= bytes) {
+      fits = middle;
+      lowest = middle + 1;
+    } else {
+      highest = middle - 1;
+    }
+  }
+  return fits;
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_LADDER_H
+#define TCP_STREAM_LADDER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Index over the representations of one viewpoint of a video.
+ *
+ * Built once when the segment sizes are read, and queried by the adaptation
+ * algorithms instead of walking videoData::segmentSize and
+ * videoData::averageBitrate:
+ * - the sizes are stored contiguously, representation by representation;
+ * - prefix sums of the sizes of every representation give the size of any
+ *   run of segments in O(1);
+ * - a sparse table of every representation gives the largest segment of any
+ *   run in O(1);
+ * - the highest representation below a bitrate is a binary search;
+ * - so is the highest representation whose next segments fit a byte budget,
+ *   where the sizes of those segments grow with the representation.
+ *
+ * The representations are expected in the order of increasing bitrate, as in
+ * the segment size files. Single segments of a higher representation may
+ * still be smaller than those of a lower one; runs containing such a segment
+ * are searched linearly.
+ */
+class BitrateLadder {
+public:
+  BitrateLadder();
+
+  /**
+   * \param segmentSize the size in bytes of every segment j of every
+   * representation i, segmentSize[i][j]
+   * \param averageBitrate the average bitrate of every representation
+   */
+  BitrateLadder(const std::vector<std::vector<int64_t>> &segmentSize,
+                const std::vector<double> &averageBitrate);
+
+  int64_t GetHighestRepIndex(void) const;
+  int64_t GetSegmentCount(void) const;
+
+  double GetBitrate(int64_t rep) const;
+  const std::vector<double> &GetBitrates(void) const;
+
+  /**
+   * \return the size in bytes of segment of representation rep
+   */
+  int64_t GetSize(int64_t rep, int64_t segment) const;
+
+  /**
+   * \return the size in bytes of the count segments of representation rep
+   * from first on, cut at the last segment
+   */
+  int64_t GetSize(int64_t rep, int64_t first, int64_t count) const;
+
+  /**
+   * \return the size in bytes of the largest of the count segments of
+   * representation rep from first on, cut at the last segment
+   */
+  int64_t GetMaxSize(int64_t rep, int64_t first, int64_t count) const;
+
+  /**
+   * \return the highest representation whose average bitrate is at most
+   * bitrate, 0 if there is none
+   */
+  int64_t GetHighestRepBelow(double bitrate) const;
+
+  /**
+   * \return the highest representation among lowest to highest whose count
+   * segments from first on take at most bytes, lowest - 1 if there is none
+   */
+  int64_t GetHighestRepFitting(int64_t first, int64_t count, double bytes,
+                               int64_t lowest, int64_t highest) const;
+
+  /**
+   * \return the highest representation r among lowest to highest such that
+   * the count segments from first on of every representation from lowest to
+   * r take at most bytes, lowest - 1 if those of lowest do not
+   */
+  int64_t GetLastRepFitting(int64_t first, int64_t count, double bytes,
+                            int64_t lowest, int64_t highest) const;
+
+  /**
+   * \return true if the size of each of the count segments from first on
+   * grows with the representation
+   */
+  bool IsSorted(int64_t first, int64_t count) const;
+
+private:
+  /**
+   * \return the highest representation among lowest to highest whose count
+   * segments from first on take at most bytes, lowest - 1 if there is none,
+   * for segments whose sizes grow with the representation
+   */
+  int64_t SearchFitting(int64_t first, int64_t count, double bytes,
+                        int64_t lowest, int64_t highest) const;
+
+  int64_t m_reps;
+  int64_t m_segments;
+  std::vector<double> m_bitrates;
+  std::vector<int64_t> m_sizes;  //!< m_sizes[rep * m_segments + segment]
+  std::vector<int64_t> m_prefix; //!< sums of the sizes before every segment,
+                                 //!< m_segments + 1 per representation
+  /**
+   * m_max[level][rep * m_segments + segment] is the largest of the 2^level
+   * segments from segment on
+   */
+  std::vector<std::vector<int64_t>> m_max;
+  std::vector<int64_t> m_unsorted; //!< number of segments before every
+                                   //!< segment whose sizes do not grow with
+                                   //!< the representation, m_segments + 1
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_LADDER_H */
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "tcp-stream-profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+namespace ns3 {
+
+bool DecisionProfiler::s_enabled = false;
+
+namespace {
+const char *const g_stageNames[DecisionProfiler::STAGES] = {
+    "UserinfoAlgo", "BandwidthAlgo", "GetPhyRate", "GetNextRep"};
+} // namespace
+
+void DecisionProfiler::Enable(bool enabled) { s_enabled = enabled; }
+
+DecisionProfiler::histogram *DecisionProfiler::GetHistograms(void) {
+  static histogram histograms[STAGES];
+  return histograms;
+}
+
+void DecisionProfiler::Reset(void) {
+  std::memset(GetHistograms(), 0, STAGES * sizeof(histogram));
+}
+
+// the bins below 8 ns are 1 ns wide, above every power of two is split into
+// eight bins by the three bits after the leading one
+uint32_t DecisionProfiler::GetBin(int64_t nanoseconds) {
+  uint64_t value = std::max<int64_t>(nanoseconds, 0);
+  if (value < 8) {
+    return value;
+  }
+  uint32_t exponent = 63 - __builtin_clzll(value);
+  return (exponent - 2) * 8 + ((value >> (exponent - 3)) & 7);
+}
+
+int64_t DecisionProfiler::GetBinUpperBound(uint32_t bin) {
+  if (bin < 8) {
+    return bin;
+  }
+  uint32_t exponent = bin / 8 + 2;
+  uint64_t lowest = (uint64_t)(8 + bin % 8) << (exponent - 3);
+  return lowest + ((uint64_t)1 << (exponent - 3)) - 1;
+}
+
+void DecisionProfiler::Record(stage s, int64_t nanoseconds) {
+  histogram &h = GetHistograms()[s];
+  h.calls++;
+  h.total += nanoseconds;
+  h.max = std::max(h.max, nanoseconds);
+  h.bins[GetBin(nanoseconds)]++;
+}
+
+int64_t DecisionProfiler::GetQuantile(const histogram &h, double q) {
+  uint64_t rank = std::max<uint64_t>(1, std::ceil(q * h.calls));
+  uint64_t seen = 0;
+  for (uint32_t bin = 0; bin < BINS; bin++) {
+    seen += h.bins[bin];
+    if (seen >= rank) {
+      return std::min(GetBinUpperBound(bin), h.max);
+    }
+  }
+  return h.max;
+}
+
+void DecisionProfiler::PrintStats(std::ostream &os) {
+  os << "Stage          Calls    p50(us)    p99(us)    max(us)   mean(us)\n";
+  for (uint32_t s = 0; s < STAGES; s++) {
+    const histogram &h = GetHistograms()[s];
+    os << std::left << std::setfill(' ') << std::setw(13) << g_stageNames[s]
+       << std::right << " " << std::setw(7) << h.calls << std::fixed
+       << std::setprecision(3);
+    if (h.calls == 0) {
+      os << "          -          -          -          -\n";
+      continue;
+    }
+    os << " " << std::setw(10) << GetQuantile(h, 0.5) / 1000.0 << " "
+       << std::setw(10) << GetQuantile(h, 0.99) / 1000.0 << " "
+       << std::setw(10) << h.max / 1000.0 << " " << std::setw(10)
+       << (double)h.total / h.calls / 1000.0 << "\n";
+  }
+}
+
+} // namespace ns3
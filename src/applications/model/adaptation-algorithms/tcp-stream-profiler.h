@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TCP_STREAM_PROFILER_H
+#define TCP_STREAM_PROFILER_H
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Wall-clock latency of the stages of an adaptation decision.
+ *
+ * TcpStreamClient::RequestRepIndex times the viewport predictor, the bandwidth
+ * estimator, the cross-layer rate of the PHY statistics and the adaptation
+ * algorithm with a DecisionTimer each. The latencies of all clients are
+ * collected in one log-linear histogram per stage, eight bins per power of
+ * two, i.e. quantiles within 12.5%, so recording is a handful of integer
+ * operations and no allocation. Profiling is off by default; then a timer
+ * only tests a flag and never reads the clock.
+ *
+ * The simulator is single-threaded, so are the histograms.
+ */
+class DecisionProfiler {
+public:
+  /**
+   * \brief The stages of a decision.
+   */
+  enum stage {
+    USERINFO,  //!< UserinfoAlgorithm::UserinfoAlgo
+    BANDWIDTH, //!< BandwidthAlgorithm::BandwidthAlgo
+    PHY_RATE,  //!< cross-layer rate from the PHY statistics
+    NEXT_REP,  //!< AdaptationAlgorithm::GetNextRep
+    STAGES     //!< number of stages
+  };
+
+  /**
+   * \brief Switch the recording on or off; recorded latencies are kept.
+   */
+  static void Enable(bool enabled);
+
+  static bool IsEnabled(void) { return s_enabled; }
+
+  /**
+   * \brief Add a call of a stage which took nanoseconds.
+   */
+  static void Record(stage s, int64_t nanoseconds);
+
+  /**
+   * \brief Forget all recorded latencies.
+   */
+  static void Reset(void);
+
+  /**
+   * \brief Print the calls, p50, p99, maximum and mean latency of every stage
+   * in microseconds, one line per stage.
+   */
+  static void PrintStats(std::ostream &os);
+
+private:
+  static const uint32_t BINS = 8 * 62; //!< covers every int64_t
+
+  /**
+   * \brief The latencies of a stage.
+   */
+  struct histogram {
+    uint64_t calls;
+    int64_t total; //!< nanoseconds
+    int64_t max;   //!< nanoseconds
+    uint64_t bins[BINS];
+  };
+
+  static uint32_t GetBin(int64_t nanoseconds);
+  static int64_t GetBinUpperBound(uint32_t bin);
+
+  /**
+   * \return the latency below which a share q of the calls stayed, in
+   * nanoseconds
+   */
+  static int64_t GetQuantile(const histogram &h, double q);
+
+  static histogram *GetHistograms(void);
+
+  static bool s_enabled;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Records the time from its construction to its destruction for a
+ * stage, if the DecisionProfiler is enabled.
+ */
+class DecisionTimer {
+public:
+  explicit DecisionTimer(DecisionProfiler::stage s)
+      : m_stage(s), m_running(DecisionProfiler::IsEnabled()) {
+    if (m_running) {
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~DecisionTimer() {
+    if (m_running) {
+      DecisionProfiler::Record(
+          m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - m_start)
+                       .count());
+    }
+  }
+
+private:
+  DecisionTimer(const DecisionTimer &);
+  DecisionTimer &operator=(const DecisionTimer &);
+
+  const DecisionProfiler::stage m_stage;
+  const bool m_running;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_PROFILER_H */
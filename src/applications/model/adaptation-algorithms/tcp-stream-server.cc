@@ -18,6 +18,7 @@
 
 #include "tcp-stream-server.h"
 #include "ns3/address-utils.h"
+#include "ns3/enum.h"
 #include "ns3/global-value.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
@@ -34,6 +35,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "tcp-stream-client.h"
+#include "tcp-stream-tag.h"
+#include <limits>
 #include <ns3/core-module.h>
 
 namespace ns3 {
@@ -51,11 +54,98 @@ TypeId TcpStreamServer::GetTypeId(void) {
           .AddAttribute("Port", "Port on which we listen for incoming packets.",
                         UintegerValue(9),
                         MakeUintegerAccessor(&TcpStreamServer::m_port),
-                        MakeUintegerChecker<uint16_t>());
+                        MakeUintegerChecker<uint16_t>())
+          .AddAttribute(
+              "Scheduler",
+              "How the send credit is shared between the connections: none "
+              "writes every segment as fast as its socket accepts it, edf "
+              "serves the earliest playback deadline first, wfq shares the "
+              "credit according to the weights of the requests.",
+              EnumValue(TcpStreamServer::NONE),
+              MakeEnumAccessor(&TcpStreamServer::m_schedulerMode),
+              MakeEnumChecker(TcpStreamServer::NONE, "none",
+                              TcpStreamServer::EDF, "edf",
+                              TcpStreamServer::WFQ, "wfq"))
+          .AddAttribute(
+              "SendRate",
+              "Aggregate rate at which the scheduler hands out send credit",
+              DataRateValue(DataRate("100Mbps")),
+              MakeDataRateAccessor(&TcpStreamServer::m_sendRate),
+              MakeDataRateChecker())
+          .AddAttribute("BurstTime",
+                        "The scheduler saves up send credit while no socket "
+                        "can take it, up to this time at SendRate",
+                        TimeValue(MilliSeconds(1)),
+                        MakeTimeAccessor(&TcpStreamServer::m_burstTime),
+                        MakeTimeChecker())
+          .AddAttribute("Quantum",
+                        "Bytes a connection of weight 1 may send per turn of "
+                        "the deficit round robin of the wfq scheduler",
+                        UintegerValue(1500),
+                        MakeUintegerAccessor(&TcpStreamServer::m_quantum),
+                        MakeUintegerChecker<uint32_t>(1));
   return tid;
 }
 
-TcpStreamServer::TcpStreamServer() { NS_LOG_FUNCTION(this); }
+TcpStreamServerConnection::TcpStreamServerConnection(TcpStreamServer *server,
+                                                     Ptr<Socket> socket,
+                                                     const Address &peer,
+                                                     uint32_t index)
+    : m_server(server), m_socket(socket), m_peer(peer), m_index(index),
+      m_open(true), m_queued(false), m_edfKey(0), m_loadActive(false),
+      m_loadBytes(0), m_credit(0),
+      m_nextPushBytes(0) {
+  m_data.currentTxBytes = 0;
+  m_data.packetSizeToReturn = 0;
+  m_data.send = false;
+  m_data.requestTime = 0;
+  m_data.deadline = -1;
+  m_data.weight = 1;
+  m_data.push = false;
+  m_data.pushConfirmed = false;
+  const segmentKey unknown = {-1, -1, -1};
+  m_data.key = unknown;
+  m_data.ready = true;
+  m_data.sentTime = -1;
+  m_nextPush = m_data.key;
+  m_stats.bytesSent = 0;
+  m_stats.requestsReceived = 0;
+  m_stats.requestsServed = 0;
+  m_stats.queueingDelaySum = 0;
+  m_stats.queueingDelayMax = 0;
+  m_stats.serviceTimeSum = 0;
+  m_stats.deadlineMisses = 0;
+  m_stats.pushedBytes = 0;
+  m_stats.pushesStarted = 0;
+  m_stats.pushesConfirmed = 0;
+  m_stats.pushesCancelled = 0;
+}
+
+void TcpStreamServerConnection::HandleRead(Ptr<Socket> socket) {
+  m_server->HandleRead(this);
+}
+
+void TcpStreamServerConnection::HandleSend(Ptr<Socket> socket,
+                                           uint32_t txSpace) {
+  m_server->HandleSend(this);
+}
+
+void TcpStreamServerConnection::HandlePeerClose(Ptr<Socket> socket) {
+  m_server->HandlePeerClose(this);
+}
+
+void TcpStreamServerConnection::HandlePeerError(Ptr<Socket> socket) {
+  m_server->HandlePeerError(this);
+}
+
+TcpStreamServer::TcpStreamServer()
+    : m_openConnections(0), m_schedulerMode(NONE), m_quantum(1500),
+      m_tokens(0), m_tokenTime(0), m_wfqNext(0),
+      m_wfqTurn(false) {
+  NS_LOG_FUNCTION(this);
+  m_load.activeRequests = 0;
+  m_load.backlogBytes = 0;
+}
 
 TcpStreamServer::~TcpStreamServer() {
   NS_LOG_FUNCTION(this);
@@ -65,9 +155,77 @@ TcpStreamServer::~TcpStreamServer() {
 
 void TcpStreamServer::DoDispose(void) {
   NS_LOG_FUNCTION(this);
+  Simulator::Cancel(m_schedulerEvent);
+  LogConnectionStats();
+  // the socket callbacks hold raw pointers to the connections, unbind them
+  // before the connections are released
+  for (std::vector<Ptr<TcpStreamServerConnection>>::iterator it =
+           m_connections.begin();
+       it != m_connections.end(); ++it) {
+    (*it)->m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    (*it)->m_socket->SetSendCallback(
+        MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+    (*it)->m_socket->SetCloseCallbacks(
+        MakeNullCallback<void, Ptr<Socket>>(),
+        MakeNullCallback<void, Ptr<Socket>>());
+    (*it)->m_socket = 0;
+  }
+  m_connections.clear();
   Application::DoDispose();
 }
 
+std::vector<connectionStats> TcpStreamServer::GetConnectionStats(void) const {
+  std::vector<connectionStats> stats;
+  stats.reserve(m_connections.size());
+  for (std::vector<Ptr<TcpStreamServerConnection>>::const_iterator it =
+           m_connections.begin();
+       it != m_connections.end(); ++it) {
+    stats.push_back((*it)->m_stats);
+  }
+  return stats;
+}
+
+loadReport TcpStreamServer::GetLoad(void) const { return m_load; }
+
+void TcpStreamServer::UpdateLoad(TcpStreamServerConnection *connection) {
+  const callbackData &data = connection->m_data;
+  const bool active = connection->m_open && data.send &&
+                      (!data.push || data.pushConfirmed);
+  const uint64_t bytes =
+      active ? data.packetSizeToReturn - data.currentTxBytes : 0;
+  if (active && !connection->m_loadActive) {
+    m_load.activeRequests++;
+  } else if (!active && connection->m_loadActive) {
+    m_load.activeRequests--;
+  }
+  m_load.backlogBytes = m_load.backlogBytes + bytes - connection->m_loadBytes;
+  connection->m_loadActive = active;
+  connection->m_loadBytes = bytes;
+}
+
+void TcpStreamServer::LogConnectionStats(void) const {
+  for (uint32_t i = 0; i < m_connections.size(); i++) {
+    const connectionStats &stats = m_connections.at(i)->m_stats;
+    NS_LOG_INFO("Connection " << i << " " << m_connections.at(i)->m_peer
+                              << ": bytes " << stats.bytesSent << ", requests "
+                              << stats.requestsReceived << ", served "
+                              << stats.requestsServed
+                              << ", avg queueing delay (us) "
+                              << (stats.requestsServed > 0
+                                      ? stats.queueingDelaySum /
+                                            stats.requestsServed
+                                      : 0)
+                              << ", max queueing delay (us) "
+                              << stats.queueingDelayMax
+                              << ", deadline misses "
+                              << stats.deadlineMisses << ", pushed bytes "
+                              << stats.pushedBytes << ", pushes "
+                              << stats.pushesStarted << ", confirmed "
+                              << stats.pushesConfirmed << ", cancelled "
+                              << stats.pushesCancelled);
+  }
+}
+
 void TcpStreamServer::StartApplication(void) {
   NS_LOG_FUNCTION(this);
 
@@ -92,13 +250,11 @@ void TcpStreamServer::StartApplication(void) {
   m_socket->SetAcceptCallback(
       MakeNullCallback<bool, Ptr<Socket>, const Address &>(),
       MakeCallback(&TcpStreamServer::HandleAccept, this));
-  m_socket->SetCloseCallbacks(
-      MakeCallback(&TcpStreamServer::HandlePeerClose, this),
-      MakeCallback(&TcpStreamServer::HandlePeerError, this));
 }
 
 void TcpStreamServer::StopApplication() {
   NS_LOG_FUNCTION(this);
+  Simulator::Cancel(m_schedulerEvent);
 
   if (m_socket != 0) {
     m_socket->Close();
@@ -110,93 +266,393 @@ void TcpStreamServer::StopApplication() {
   }
 }
 
-void TcpStreamServer::HandleRead(Ptr<Socket> socket) {
-  NS_LOG_FUNCTION(this << socket);
+void TcpStreamServer::HandleRead(TcpStreamServerConnection *connection) {
+  NS_LOG_FUNCTION(this << connection->m_socket);
   Ptr<Packet> packet;
   Address from;
-  packet = socket->RecvFrom(from);
-  int64_t packetSizeToReturn = GetCommand(packet);
-  // these values will be accessible by the clients Address from.
-  m_callbackData[from].currentTxBytes = 0;
-  m_callbackData[from].packetSizeToReturn = packetSizeToReturn;
-  m_callbackData[from].send = true;
+  packet = connection->m_socket->RecvFrom(from);
+  segmentRequest request = GetCommand(packet);
+  callbackData &data = connection->m_data;
 
-  HandleSend(socket, socket->GetTxAvailable());
+  if (request.cancel) {
+    AbortPush(connection);
+    connection->m_nextPushBytes = 0;
+    UpdateLoad(connection);
+    return;
+  }
+  connection->m_nextPush = request.pushKey;
+  connection->m_nextPushBytes = request.pushBytes;
+
+  if (request.confirm) {
+    if (!data.push || data.pushConfirmed || !(request.key == data.key)) {
+      // nothing pushed is waiting for this confirmation
+      NS_LOG_WARN("Confirmation of segment " << request.key.segment
+                  << " without a matching push");
+    } else {
+      connection->m_stats.pushesConfirmed++;
+      // the pushed segment is now a regular one, the confirmation is its
+      // request and it gets the deadline the client asked for
+      connection->m_stats.requestsReceived++;
+      data.pushConfirmed = true;
+      data.requestTime = Simulator::Now().GetMicroSeconds();
+      data.deadline = request.deadline;
+      data.weight = request.weight;
+      UpdateLoad(connection);
+      if (data.send) {
+        Transmit(connection);
+        return;
+      }
+      // its last byte was written before the confirmation arrived
+      CountServed(connection, data.sentTime);
+    }
+    if (StartPush(connection)) {
+      Transmit(connection);
+    }
+    return;
+  }
+
+  // a new request replaces a push that is still going on
+  AbortPush(connection);
+  data.currentTxBytes = 0;
+  data.packetSizeToReturn = request.bytes;
+  data.send = true;
+  data.requestTime = Simulator::Now().GetMicroSeconds();
+  data.deadline = request.deadline;
+  data.weight = request.weight;
+  data.push = false;
+  data.pushConfirmed = false;
+  data.key = request.key;
+  data.ready = true;
+  data.sentTime = -1;
+  connection->m_stats.requestsReceived++;
+  UpdateLoad(connection);
+  PrepareSegment(connection);
+  Transmit(connection);
 }
 
-void TcpStreamServer::HandleSend(Ptr<Socket> socket, uint32_t txSpace) {
-  Address from;
-  socket->GetPeerName(from);
-  // look up values for the connected client and whose values are stored in from
-  if (m_callbackData[from].currentTxBytes ==
-      m_callbackData[from].packetSizeToReturn) {
-    m_callbackData[from].currentTxBytes = 0;
-    m_callbackData[from].packetSizeToReturn = 0;
-    m_callbackData[from].send = false;
+void TcpStreamServer::Transmit(TcpStreamServerConnection *connection) {
+  if (m_schedulerMode == NONE) {
+    HandleSend(connection);
+  } else {
+    Enqueue(connection);
+  }
+}
+
+void TcpStreamServer::HandleSend(TcpStreamServerConnection *connection) {
+  // with a scheduler, the socket is only written to in ScheduleTransmissions,
+  // which goes on now that the socket has room again
+  if (m_schedulerMode != NONE) {
+    if (connection->m_queued && !m_schedulerEvent.IsRunning()) {
+      m_schedulerEvent = Simulator::ScheduleNow(
+          &TcpStreamServer::ScheduleTransmissions, this);
+    }
     return;
   }
-  if (socket->GetTxAvailable() > 0 && m_callbackData[from].send) {
-    int32_t toSend;
-    toSend = std::min(socket->GetTxAvailable(),
-                      m_callbackData[from].packetSizeToReturn -
-                          m_callbackData[from].currentTxBytes);
-    Ptr<Packet> packet = Create<Packet>(toSend);
-    int amountSent = socket->Send(packet, 0);
-    if (amountSent > 0) {
-      m_callbackData[from].currentTxBytes += amountSent;
+  // We exit this part, when no bytes have been sent, as the send side buffer
+  // is full. The "HandleSend" callback will fire when some buffer space has
+  // freed up.
+  while (SendBytes(connection, std::numeric_limits<uint32_t>::max()) > 0) {
+  }
+}
+
+uint32_t TcpStreamServer::SendBytes(TcpStreamServerConnection *connection,
+                                    uint32_t maxBytes) {
+  callbackData &data = connection->m_data;
+  Ptr<Socket> socket = connection->m_socket;
+  if (!data.send || !data.ready || !connection->m_open || maxBytes == 0 ||
+      socket->GetTxAvailable() == 0) {
+    return 0;
+  }
+  uint32_t toSend =
+      std::min(std::min(socket->GetTxAvailable(), maxBytes),
+               data.packetSizeToReturn - data.currentTxBytes);
+  Ptr<Packet> packet = Create<Packet>(toSend);
+  if (data.push) {
+    packet->AddByteTag(TcpStreamPushTag(data.key.segment));
+  }
+  packet->AddByteTag(
+      TcpStreamLoadTag(m_load.activeRequests, m_load.backlogBytes));
+  int amountSent = socket->Send(packet, 0);
+  if (amountSent <= 0) {
+    return 0;
+  }
+  int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  connectionStats &stats = connection->m_stats;
+  if (data.currentTxBytes == 0 && (!data.push || data.pushConfirmed)) {
+    int64_t queueingDelay = timeNow - data.requestTime;
+    stats.queueingDelaySum += queueingDelay;
+    stats.queueingDelayMax = std::max(stats.queueingDelayMax, queueingDelay);
+  }
+  data.currentTxBytes += amountSent;
+  stats.bytesSent += amountSent;
+  if (data.push) {
+    stats.pushedBytes += amountSent;
+  }
+  if (data.currentTxBytes == data.packetSizeToReturn) {
+    data.sentTime = timeNow;
+    // an unconfirmed push is counted when the confirmation arrives
+    if (!data.push || data.pushConfirmed) {
+      CountServed(connection, timeNow);
     }
-    // We exit this part, when no bytes have been sent, as the send side buffer
-    // is full. The "HandleSend" callback will fire when some buffer space has
-    // freed up.
-    else {
-      return;
+    data.currentTxBytes = 0;
+    data.packetSizeToReturn = 0;
+    data.send = false;
+    // the connection would sit idle until the client's next request arrives,
+    // use that time for the segment the client announced
+    StartPush(connection);
+  }
+  UpdateLoad(connection);
+  return amountSent;
+}
+
+bool TcpStreamServer::StartPush(TcpStreamServerConnection *connection) {
+  if (connection->m_nextPushBytes <= 0 || !connection->m_open) {
+    return false;
+  }
+  callbackData &data = connection->m_data;
+  data.currentTxBytes = 0;
+  data.packetSizeToReturn = connection->m_nextPushBytes;
+  data.send = true;
+  data.requestTime = Simulator::Now().GetMicroSeconds();
+  data.deadline = -1;
+  data.push = true;
+  data.pushConfirmed = false;
+  data.key = connection->m_nextPush;
+  data.ready = true;
+  data.sentTime = -1;
+  connection->m_nextPushBytes = 0;
+  connection->m_stats.pushesStarted++;
+  UpdateLoad(connection);
+  PrepareSegment(connection);
+  return true;
+}
+
+void TcpStreamServer::CountServed(TcpStreamServerConnection *connection,
+                                  int64_t sentTime) {
+  const callbackData &data = connection->m_data;
+  connectionStats &stats = connection->m_stats;
+  stats.requestsServed++;
+  // a push may be written completely before it is confirmed
+  stats.serviceTimeSum += std::max(sentTime - data.requestTime, (int64_t)0);
+  if (data.deadline >= 0 && sentTime > data.deadline) {
+    stats.deadlineMisses++;
+  }
+}
+
+void TcpStreamServer::AbortPush(TcpStreamServerConnection *connection) {
+  callbackData &data = connection->m_data;
+  if (data.send && data.push) {
+    connection->m_stats.pushesCancelled++;
+    data.currentTxBytes = 0;
+    data.packetSizeToReturn = 0;
+    data.send = false;
+  }
+  data.push = false;
+  UpdateLoad(connection);
+}
+
+int64_t
+TcpStreamServer::GetEdfKey(TcpStreamServerConnection *connection) const {
+  const callbackData &data = connection->m_data;
+  if (data.deadline < 0 || (data.push && !data.pushConfirmed)) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return data.deadline;
+}
+
+void TcpStreamServer::Enqueue(TcpStreamServerConnection *connection) {
+  if (!connection->m_queued) {
+    connection->m_queued = true;
+    if (m_schedulerMode == EDF) {
+      connection->m_edfKey = GetEdfKey(connection);
+      m_edfQueue.insert(
+          std::make_pair(connection->m_edfKey, connection->m_index));
+    } else {
+      connection->m_credit = 0;
+      m_wfqQueue.push_back(connection->m_index);
     }
+  } else if (m_schedulerMode == EDF &&
+             GetEdfKey(connection) != connection->m_edfKey) {
+    // a new request or a confirmed push changed the deadline
+    m_edfQueue.erase(std::make_pair(connection->m_edfKey, connection->m_index));
+    connection->m_edfKey = GetEdfKey(connection);
+    m_edfQueue.insert(
+        std::make_pair(connection->m_edfKey, connection->m_index));
+  }
+  if (!m_schedulerEvent.IsRunning()) {
+    m_schedulerEvent =
+        Simulator::ScheduleNow(&TcpStreamServer::ScheduleTransmissions, this);
   }
 }
 
-void TcpStreamServer::HandleAccept(Ptr<Socket> s, const Address &from) {
-  NS_LOG_FUNCTION(this << s << from);
-  callbackData cbd;
-  cbd.currentTxBytes = 0;
-  cbd.packetSizeToReturn = 0;
-  cbd.send = false;
-  m_callbackData[from] = cbd;
-  m_connectedClients.push_back(from);
-  s->SetRecvCallback(MakeCallback(&TcpStreamServer::HandleRead, this));
-  s->SetSendCallback(MakeCallback(&TcpStreamServer::HandleSend, this));
-}
-
-void TcpStreamServer::HandlePeerClose(Ptr<Socket> socket) {
-  NS_LOG_FUNCTION(this << socket);
-  Address from;
-  socket->GetPeerName(from);
-  for (std::vector<Address>::iterator it = m_connectedClients.begin();
-       it != m_connectedClients.end(); ++it) {
-    if (*it == from) {
-      m_connectedClients.erase(it);
-      // No more clients left in m_connectedClients, simulation is done.
-      if (m_connectedClients.size() == 0) {
-        Simulator::Stop();
+void TcpStreamServer::ScheduleTransmissions(void) {
+  NS_LOG_FUNCTION(this);
+  // the bucket holds at least a quantum, so a turn can always be served
+  const double rate = m_sendRate.GetBitRate() / 8.0;  // bytes per second
+  const double burst =
+      std::max(rate * m_burstTime.GetSeconds(), (double)m_quantum);
+  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  m_tokens = std::min(m_tokens + rate * (timeNow - m_tokenTime) / 1000000.0,
+                      burst);
+  m_tokenTime = timeNow;
+
+  if (m_schedulerMode == EDF) {
+    std::set<std::pair<int64_t, uint32_t>>::iterator it = m_edfQueue.begin();
+    while (it != m_edfQueue.end() && m_tokens >= 1) {
+      TcpStreamServerConnection *connection =
+          PeekPointer(m_connections.at(it->second));
+      m_tokens -= SendBytes(connection, (uint32_t)m_tokens);
+      if (!connection->m_data.send || !connection->m_open) {
+        connection->m_queued = false;
+        m_edfQueue.erase(it++);
+      } else if (GetEdfKey(connection) != it->first) {
+        // the segment was sent and a push without deadline followed it, the
+        // push goes to the back of the queue
+        m_edfQueue.erase(it++);
+        connection->m_edfKey = GetEdfKey(connection);
+        m_edfQueue.insert(
+            std::make_pair(connection->m_edfKey, connection->m_index));
+      } else {
+        ++it;
       }
-      return;
     }
+  } else if (m_schedulerMode == WFQ) {
+    // connections visited in a row which could not send, the round ends when
+    // none of them can
+    uint32_t idle = 0;
+    while (!m_wfqQueue.empty() && m_tokens >= 1 && idle < m_wfqQueue.size()) {
+      if (m_wfqNext >= m_wfqQueue.size()) {
+        m_wfqNext = 0;
+      }
+      TcpStreamServerConnection *connection =
+          PeekPointer(m_connections.at(m_wfqQueue.at(m_wfqNext)));
+      if (!connection->m_data.send || !connection->m_open) {
+        // nothing pending any more, the deficit is dropped with it
+        connection->m_queued = false;
+        connection->m_credit = 0;
+        m_wfqQueue.erase(m_wfqQueue.begin() + m_wfqNext);
+        m_wfqTurn = false;
+        continue;
+      }
+      if (!m_wfqTurn) {
+        if (!connection->m_data.ready ||
+            connection->m_socket->GetTxAvailable() == 0) {
+          // its turn passes, it keeps its deficit
+          idle++;
+          m_wfqNext++;
+          continue;
+        }
+        connection->m_credit += m_quantum * connection->m_data.weight;
+        m_wfqTurn = true;
+      }
+      uint32_t sent = SendBytes(
+          connection, (uint32_t)std::min(connection->m_credit, m_tokens));
+      connection->m_credit -= sent;
+      m_tokens -= sent;
+      idle = sent > 0 ? 0 : idle + 1;
+      if (m_tokens < 1 && sent > 0 && connection->m_data.send) {
+        // the turn goes on once there is credit again
+        break;
+      }
+      if (connection->m_data.send) {
+        // the deficit is used up or the socket is full
+        m_wfqNext++;
+        m_wfqTurn = false;
+      }
+    }
+  }
+
+  // without credit, go on once a quantum has built up; otherwise every
+  // socket is full and HandleSend goes on
+  if ((!m_edfQueue.empty() || !m_wfqQueue.empty()) && m_tokens < 1) {
+    m_schedulerEvent = Simulator::Schedule(
+        Seconds((m_quantum - m_tokens) / rate),
+        &TcpStreamServer::ScheduleTransmissions, this);
+  }
+}
+
+void TcpStreamServer::HandleAccept(Ptr<Socket> s, const Address &from) {
+  NS_LOG_FUNCTION(this << s << from);
+  Ptr<TcpStreamServerConnection> connection =
+      Create<TcpStreamServerConnection>(this, s, from, m_connections.size());
+  m_connections.push_back(connection);
+  m_openConnections++;
+  // the connections are owned by m_connections, so the callbacks can be bound
+  // to the plain pointer
+  TcpStreamServerConnection *context = PeekPointer(connection);
+  s->SetRecvCallback(
+      MakeCallback(&TcpStreamServerConnection::HandleRead, context));
+  s->SetSendCallback(
+      MakeCallback(&TcpStreamServerConnection::HandleSend, context));
+  s->SetCloseCallbacks(
+      MakeCallback(&TcpStreamServerConnection::HandlePeerClose, context),
+      MakeCallback(&TcpStreamServerConnection::HandlePeerError, context));
+}
+
+void TcpStreamServer::HandlePeerClose(TcpStreamServerConnection *connection) {
+  NS_LOG_FUNCTION(this << connection->m_socket);
+  if (!connection->m_open) {
+    return;
   }
+  connection->m_open = false;
+  connection->m_data.send = false;
+  UpdateLoad(connection);
+  m_openConnections--;
+  // No more clients left, simulation is done.
+  if (m_openConnections == 0) {
+    Simulator::Stop();
+  }
+}
+
+void TcpStreamServer::HandlePeerError(TcpStreamServerConnection *connection) {
+  NS_LOG_FUNCTION(this << connection->m_socket);
 }
 
-void TcpStreamServer::HandlePeerError(Ptr<Socket> socket) {
-  NS_LOG_FUNCTION(this << socket);
+void TcpStreamServer::PrepareSegment(TcpStreamServerConnection *connection) {
 }
 
-int64_t TcpStreamServer::GetCommand(Ptr<Packet> packet) {
-  int64_t packetSizeToReturn;
-  uint8_t *buffer = new uint8_t[packet->GetSize()];
-  packet->CopyData(buffer, packet->GetSize());
-  std::stringstream ss;
-  ss << buffer;
-  std::string str;
-  ss >> str;
-  std::stringstream convert(str);
-  convert >> packetSizeToReturn;
-  return packetSizeToReturn;
+segmentRequest TcpStreamServer::GetCommand(Ptr<Packet> packet) {
+  const segmentKey unknown = {-1, -1, -1};
+  segmentRequest request;
+  request.confirm = false;
+  request.cancel = false;
+  request.bytes = 0;
+  request.deadline = -1;
+  request.weight = 1;
+  request.key = unknown;
+  request.pushKey = unknown;
+  request.pushBytes = 0;
+  std::vector<uint8_t> buffer(packet->GetSize() + 1, 0);
+  packet->CopyData(buffer.data(), packet->GetSize());
+  std::stringstream ss((const char *)buffer.data());
+  std::string command;
+  ss >> command;
+  if (command == "cancel") {
+    request.cancel = true;
+    return request;
+  } else if (command == "confirm") {
+    request.confirm = true;
+  } else {
+    std::stringstream convert(command);
+    convert >> request.bytes;
+  }
+  // older clients only send the number of bytes, the remaining fields keep
+  // their defaults; an invalid field falls back to its own default only
+  if (!(ss >> request.deadline)) {
+    request.deadline = -1;
+  }
+  if (!(ss >> request.weight) || request.weight <= 0) {
+    request.weight = 1;
+  }
+  if (!(ss >> request.key.viewpoint >> request.key.rep >>
+        request.key.segment)) {
+    request.key = unknown;
+  }
+  if (!(ss >> request.pushKey.viewpoint >> request.pushKey.rep >>
+        request.pushKey.segment >> request.pushBytes)) {
+    request.pushKey = unknown;
+    request.pushBytes = 0;
+  }
+  return request;
 }
 } // Namespace ns3
@@ -21,11 +21,15 @@
 
 #include "ns3/address.h"
 #include "ns3/application.h"
+#include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/traced-callback.h"
-#include <map>
+#include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -38,6 +42,31 @@ class PropagationDelayModel;
  * \defgroup tcpStream TcpStream
  */
 
+/**
+ * \ingroup tcpStream
+ * \brief identifies a segment of the video.
+ */
+struct segmentKey {
+  int64_t viewpoint; //!< viewpoint the segment belongs to, -1 if unknown
+  int64_t rep;       //!< representation level of the segment, -1 if unknown
+  int64_t segment;   //!< index of the segment, -1 if unknown
+
+  bool operator<(const segmentKey &other) const {
+    if (viewpoint != other.viewpoint) {
+      return viewpoint < other.viewpoint;
+    }
+    if (rep != other.rep) {
+      return rep < other.rep;
+    }
+    return segment < other.segment;
+  }
+
+  bool operator==(const segmentKey &other) const {
+    return viewpoint == other.viewpoint && rep == other.rep &&
+           segment == other.segment;
+  }
+};
+
 /**
  * \ingroup tcpStream
  * \brief data strucute the server uses to manage the following data for every
@@ -51,6 +80,123 @@ struct callbackData {
                                //!< returned to the client
   bool send; //!< true as long as there are still bytes left to be sent for the
              //!< current segment
+  int64_t requestTime; //!< point in time in microseconds when the request for
+                       //!< the current segment arrived
+  int64_t deadline; //!< point in time in microseconds when the client needs
+                    //!< the current segment for playback, -1 if unknown
+  double weight;    //!< share of the send credit the client asked for in
+                    //!< weighted-fair mode
+  bool push; //!< true if the current segment is pushed without a request
+  bool pushConfirmed; //!< true once the client confirmed the pushed segment
+  segmentKey key;     //!< the segment currently being sent
+  bool ready; //!< false while the bytes of the segment are not available yet
+  int64_t sentTime; //!< point in time in microseconds the last byte of the
+                    //!< segment was written to the socket, -1 until then
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief a segment request as sent by the client.
+ *
+ * The request is a string of space separated fields: the number of bytes to
+ * return, followed by the optional deadline in microseconds of simulation time,
+ * the optional weight, the optional viewpoint, representation and index of the
+ * requested segment and the optional viewpoint, representation, index and
+ * size of the segment the server may push once this one is sent. Instead of
+ * the number of bytes, the first field may be "confirm", which accepts the
+ * segment currently pushed and is followed by the same optional fields, or
+ * "cancel", which stops the push.
+ */
+struct segmentRequest {
+  bool confirm;     //!< the client accepts the pushed segment
+  bool cancel;      //!< the client does not want the pushed segment
+  int64_t bytes;    //!< number of bytes to return to the client
+  int64_t deadline; //!< playback deadline in microseconds, -1 if not given
+  double weight;    //!< scheduling weight, 1 if not given
+  segmentKey key;   //!< the requested segment
+  segmentKey pushKey; //!< the segment to push next
+  int64_t pushBytes;  //!< size of the segment to push next, 0 if none
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief statistics the server keeps for every connection.
+ *
+ * A pushed segment counts as a request once the client confirms it, with the
+ * confirmation as its arrival.
+ */
+struct connectionStats {
+  uint64_t bytesSent;        //!< total number of bytes written to the socket
+  uint32_t requestsReceived; //!< number of segment requests received
+  uint32_t requestsServed;   //!< number of segment requests completely
+                             //!< written to the socket
+  int64_t queueingDelaySum;  //!< sum of the time in microseconds between the
+                             //!< arrival of a request and the first byte of
+                             //!< its response being written to the socket
+  int64_t queueingDelayMax;  //!< highest such delay in microseconds
+  int64_t serviceTimeSum; //!< sum of the time in microseconds between the
+                          //!< arrival of a request and the last byte of its
+                          //!< response being written to the socket
+  uint32_t deadlineMisses; //!< number of requests whose last byte was written
+                           //!< to the socket after their deadline
+  uint64_t pushedBytes;     //!< bytes written for pushed segments
+  uint32_t pushesStarted;   //!< number of segments pushed
+  uint32_t pushesConfirmed; //!< number of pushed segments the client accepted
+  uint32_t pushesCancelled; //!< number of pushes stopped before their last
+                            //!< byte was written
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief load of a server, as reported to the clients with every packet.
+ */
+struct loadReport {
+  uint32_t activeRequests; //!< requested or confirmed segments not yet
+                           //!< completely written to the socket
+  uint64_t backlogBytes;   //!< bytes left to write for them
+};
+
+class TcpStreamServer;
+
+/**
+ * \ingroup tcpStream
+ * \brief Context of one accepted client connection.
+ *
+ * The server creates one of these for every accepted socket and binds the
+ * socket's receive, send and close callbacks to it, so each callback reaches
+ * the state of its connection directly instead of looking it up by the peer
+ * address.
+ */
+class TcpStreamServerConnection
+    : public SimpleRefCount<TcpStreamServerConnection> {
+public:
+  TcpStreamServerConnection(TcpStreamServer *server, Ptr<Socket> socket,
+                            const Address &peer, uint32_t index);
+
+  void HandleRead(Ptr<Socket> socket);
+  void HandleSend(Ptr<Socket> socket, uint32_t txSpace);
+  void HandlePeerClose(Ptr<Socket> socket);
+  void HandlePeerError(Ptr<Socket> socket);
+
+  TcpStreamServer *m_server; //!< the server this connection belongs to
+  Ptr<Socket> m_socket;      //!< the accepted socket
+  Address m_peer;            //!< address of the connected client
+  uint32_t m_index;          //!< position of this connection in the server's
+                             //!< list of connections
+  bool m_open;               //!< false once the peer closed the connection
+  bool m_queued;   //!< true while the connection waits in the send scheduler
+  int64_t m_edfKey; //!< key of the connection in the EDF queue
+  bool m_loadActive;  //!< true if the connection counts as an active request
+                      //!< in the load of the server
+  uint64_t m_loadBytes; //!< bytes it adds to the backlog of the server
+  double m_credit; //!< deficit of the connection in the deficit round robin:
+                   //!< bytes it may still send, carried as long as it has a
+                   //!< segment pending
+  segmentKey m_nextPush;   //!< the segment to push once the current one is
+                           //!< sent
+  int64_t m_nextPushBytes; //!< size of that segment, 0 if there is none
+  callbackData m_data;     //!< state of the segment currently being sent
+  connectionStats m_stats; //!< statistics of this connection
 };
 
 /**
@@ -70,78 +216,205 @@ public:
   TcpStreamServer();
   virtual ~TcpStreamServer();
 
+  /**
+   * \brief How the server shares its send credit between connections.
+   */
+  enum schedulerMode {
+    NONE, //!< write every segment as fast as its socket accepts it
+    EDF,  //!< earliest deadline first
+    WFQ   //!< weighted fair, deficit round robin over the request weights
+  };
+
+  /**
+   * \brief Get the statistics of every connection accepted so far.
+   * \return one entry per accepted connection, in order of acceptance
+   */
+  std::vector<connectionStats> GetConnectionStats(void) const;
+
+  /**
+   * \brief Get the current load of the server. Unconfirmed pushes do not
+   * count.
+   */
+  loadReport GetLoad(void) const;
+
 protected:
   virtual void DoDispose(void);
-
-private:
   virtual void StartApplication(void);
   virtual void StopApplication(void);
 
   /**
-   * \brief Handle a packet reception, and set SendCallback to HandlSend.
+   * \brief Make the bytes of the segment about to be sent on connection
+   * available.
+   *
+   * Called whenever a requested or pushed segment is set up in the
+   * callbackData of the connection. The server has every segment, so it does
+   * nothing. Subclasses which first have to get the segment from elsewhere set
+   * connection->m_data.ready to false and call Transmit once the segment is
+   * available.
+   */
+  virtual void PrepareSegment(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief Get the current segment of connection going, either by writing it
+   * right away or by handing it to the scheduler.
+   */
+  void Transmit(TcpStreamServerConnection *connection);
+
+  std::vector<Ptr<TcpStreamServerConnection>>
+      m_connections; //!< Every connection accepted so far, in order of
+                     //!< acceptance. The socket callbacks are bound to these.
+
+private:
+  friend class TcpStreamServerConnection;
+
+  /**
+   * \brief Handle a packet reception on a connection.
    *
-   * This function is called by lower layers. The received packet's content
-   * gets deserialized by GetCommand (Ptr<Packet> packet). If the packets
-   * content contains a string composed of an int with value n, then n bytes
-   * will be sent back to the sender.
+   * This function is called by lower layers through the connection the socket
+   * is bound to. The received packet's content gets deserialized by
+   * GetCommand (Ptr<Packet> packet). If the packets content contains a string
+   * composed of an int with value n, then n bytes will be sent back to the
+   * sender. Without a scheduler they are sent right away, otherwise the
+   * connection is handed to the scheduler together with the deadline and
+   * weight of the request.
    *
-   * \param socket the socket the packet was received to.
+   * \param connection the connection the packet was received on.
    */
-  void HandleRead(Ptr<Socket> socket);
+  void HandleRead(TcpStreamServerConnection *connection);
 
   /**
-   * \brief send packetSizeToReturn bytes to the client connected to socket.
+   * \brief send the remaining bytes of the current segment to the client of
+   * connection.
    *
-   * This function is called once by HandleRead (Ptr<Socket> socket) after a
-   * send of n (i.e. a segment of n) bytes was requested by the client. If n >
+   * This function is called once by HandleRead after a send of n (i.e. a
+   * segment of n) bytes was requested by the client. If the remaining bytes >
    * socket->GetTxAvailable (), (this is the current space available in the
    * buffer in bytes), then socket->GetTxAvailable () bytes are written into the
-   * buffer. This function will get called again through the SendCallback when
-   * space in the buffer has freed up.
-   * The amount of sent bytes for this particular segment and for the client
-   * connected with this socket is stored in m_callbackData
-   * [from].currentTxBytes, so the server can access the already sent bytes
-   * through the value of from, which is provided by socket, because there is a
-   * socket instance for every connected client. m_callbackData [from].send
-   * indicates for the client with address from that the server has not yet sent
-   * m_callbackData [from].packetSizeToReturn bytes. When the number of bytes
-   * should be sent is reached, m_callbackData [from].send will be set to false
-   * and the server stops sending bytes to the client until he requests another
-   * segment.
+   * buffer. This function will get called again through the SendCallback of
+   * the connection when space in the buffer has freed up.
+   * The amount of sent bytes for this particular segment is stored in the
+   * callbackData of the connection, which the SendCallback is bound to, so no
+   * lookup is needed on this path. connection->m_data.send indicates that the
+   * server has not yet sent connection->m_data.packetSizeToReturn bytes. When
+   * the number of bytes that should be sent is reached, it will be set to
+   * false and the server stops sending bytes to the client until he requests
+   * another segment. When a scheduler is configured, the writes are done by
+   * ScheduleTransmissions instead and this function does nothing.
+   *
+   * \param connection the connection the request for a segment was received
+   * on and where the server will send the segment to.
+   */
+  void HandleSend(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief Write up to maxBytes of the current segment of connection to its
+   * socket, bounded by the space available in the socket's send buffer.
+   *
+   * \return the number of bytes written
+   */
+  uint32_t SendBytes(TcpStreamServerConnection *connection, uint32_t maxBytes);
+
+  /**
+   * \brief Start pushing the segment the client announced with its last
+   * request or confirmation, if any.
+   *
+   * \return true if a push was started
+   */
+  bool StartPush(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief Count the current segment of connection as served, its last byte
+   * having been written at sentTime.
+   */
+  void CountServed(TcpStreamServerConnection *connection, int64_t sentTime);
+
+  /**
+   * \brief Bring the share of connection in the load of the server up to
+   * date. Called after every change of its segment state, so reporting the
+   * load costs nothing per packet.
+   */
+  void UpdateLoad(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief Stop the push currently in progress on connection, if any.
+   */
+  void AbortPush(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief The key of connection in the EDF queue. Segments without a
+   * deadline and pushed segments not yet confirmed come last.
+   */
+  int64_t GetEdfKey(TcpStreamServerConnection *connection) const;
+
+  /**
+   * \brief Add a connection with a pending segment to the send scheduler and
+   * start the scheduler if it is idle.
+   */
+  void Enqueue(TcpStreamServerConnection *connection);
+
+  /**
+   * \brief Hand out the send credit built up so far.
    *
-   * \param socket the socket the request for a segment was received to and
-   * where the server will send packetSizeToReturn bytes to. \param
-   * packetSizeToReturn the full segment size in bytes that has to be returned
-   * to the client
+   * The credit grows at m_sendRate up to m_burstTime of it. In EDF mode the
+   * connections are served in order of their deadline, in WFQ mode by deficit
+   * round robin: a connection whose socket has room gets m_quantum times its
+   * weight when its turn comes and sends up to its deficit. Either way the
+   * round goes on until the credit is used up or no socket has room. The
+   * function runs again when a socket has room again (HandleSend), when a
+   * segment is queued (Enqueue) and, if the credit ran out, when it has grown
+   * by a quantum.
    */
-  void HandleSend(Ptr<Socket> socket, uint32_t packetSizeToReturn);
+  void ScheduleTransmissions(void);
 
   /**
-   * \brief Set callback functions for receive and send.
-   * Add the newly connected client to m_connectedClients and allocate
-   * callbackData structure for this client.
+   * \brief Create the connection context for the newly connected client and
+   * bind the callback functions for receive, send and close to it.
    */
   void HandleAccept(Ptr<Socket> s, const Address &from);
 
-  void HandlePeerClose(Ptr<Socket> socket);
-  void HandlePeerError(Ptr<Socket> socket);
+  /**
+   * \brief Mark the connection as closed. When no open connection is left,
+   * the simulation is done.
+   */
+  void HandlePeerClose(TcpStreamServerConnection *connection);
+  void HandlePeerError(TcpStreamServerConnection *connection);
 
   /**
    * \brief Deserialize what the client has sent us.
    * \param packet the data the client has sent us
-   * \return the deserialized packet content as a string
+   * \return the segment request the client has sent us
+   */
+  segmentRequest GetCommand(Ptr<Packet> packet);
+
+  /**
+   * \brief Log the statistics of every connection.
    */
-  int64_t GetCommand(Ptr<Packet> packet);
+  void LogConnectionStats(void) const;
 
   uint16_t m_port;       //!< Port on which we listen for incoming packets.
   Ptr<Socket> m_socket;  //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
-  std::map<Address, callbackData>
-      m_callbackData; //!< With this it is possible to access the
-                      //!< currentTxBytes, the packetSizeToReturn and the send
-                      //!< boolean through the from value of the client.
-  std::vector<Address> m_connectedClients; //!< Vector which holds the list of
-                                           //!< currently connected clients.
+  uint32_t m_openConnections; //!< Number of connections not yet closed by
+                              //!< the peer.
+  schedulerMode m_schedulerMode; //!< How the send credit is shared
+  DataRate m_sendRate; //!< Aggregate rate at which send credit is handed out
+  Time m_burstTime; //!< The credit builds up to this time at m_sendRate
+  uint32_t m_quantum; //!< Bytes a connection of weight 1 gets per turn in WFQ
+                      //!< mode
+  double m_tokens;    //!< Send credit in bytes at m_tokenTime
+  int64_t m_tokenTime; //!< Point in time in microseconds of m_tokens
+  EventId m_schedulerEvent;  //!< Next round of the scheduler
+  loadReport m_load;         //!< Current load, kept by UpdateLoad
+  std::set<std::pair<int64_t, uint32_t>>
+      m_edfQueue; //!< (deadline, connection index) of the connections with a
+                  //!< pending segment in EDF mode
+  std::vector<uint32_t> m_wfqQueue; //!< connection indices with a pending
+                                    //!< segment in WFQ mode, in the order of
+                                    //!< their turns
+  uint32_t m_wfqNext; //!< Position in m_wfqQueue of the connection whose turn
+                      //!< it is
+  bool m_wfqTurn; //!< True if that connection already got its quantum for
+                  //!< this turn
 };
 
 } // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(TcpStreamPushTag);
+NS_OBJECT_ENSURE_REGISTERED(TcpStreamLoadTag);
+
+TypeId TcpStreamPushTag::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::TcpStreamPushTag")
+                          .SetParent<Tag>()
+                          .SetGroupName("Applications")
+                          .AddConstructor<TcpStreamPushTag>();
+  return tid;
+}
+
+TypeId TcpStreamPushTag::GetInstanceTypeId(void) const {
+  return GetTypeId();
+}
+
+TcpStreamPushTag::TcpStreamPushTag() : m_segment(-1) {}
+
+TcpStreamPushTag::TcpStreamPushTag(int64_t segment) : m_segment(segment) {}
+
+uint32_t TcpStreamPushTag::GetSerializedSize(void) const { return 8; }
+
+void TcpStreamPushTag::Serialize(TagBuffer i) const {
+  i.WriteU64((uint64_t)m_segment);
+}
+
+void TcpStreamPushTag::Deserialize(TagBuffer i) {
+  m_segment = (int64_t)i.ReadU64();
+}
+
+void TcpStreamPushTag::Print(std::ostream &os) const {
+  os << "segment=" << m_segment;
+}
+
+int64_t TcpStreamPushTag::GetSegment(void) const { return m_segment; }
+
+TypeId TcpStreamLoadTag::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::TcpStreamLoadTag")
+                          .SetParent<Tag>()
+                          .SetGroupName("Applications")
+                          .AddConstructor<TcpStreamLoadTag>();
+  return tid;
+}
+
+TypeId TcpStreamLoadTag::GetInstanceTypeId(void) const {
+  return GetTypeId();
+}
+
+TcpStreamLoadTag::TcpStreamLoadTag() : m_activeRequests(0), m_backlogBytes(0) {}
+
+TcpStreamLoadTag::TcpStreamLoadTag(uint32_t activeRequests,
+                                   uint64_t backlogBytes)
+    : m_activeRequests(activeRequests), m_backlogBytes(backlogBytes) {}
+
+uint32_t TcpStreamLoadTag::GetSerializedSize(void) const { return 12; }
+
+void TcpStreamLoadTag::Serialize(TagBuffer i) const {
+  i.WriteU32(m_activeRequests);
+  i.WriteU64(m_backlogBytes);
+}
+
+void TcpStreamLoadTag::Deserialize(TagBuffer i) {
+  m_activeRequests = i.ReadU32();
+  m_backlogBytes = i.ReadU64();
+}
+
+void TcpStreamLoadTag::Print(std::ostream &os) const {
+  os << "activeRequests=" << m_activeRequests
+     << " backlogBytes=" << m_backlogBytes;
+}
+
+uint32_t TcpStreamLoadTag::GetActiveRequests(void) const {
+  return m_activeRequests;
+}
+
+uint64_t TcpStreamLoadTag::GetBacklogBytes(void) const {
+  return m_backlogBytes;
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_TAG_H
+#define TCP_STREAM_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Byte tag marking the bytes of a segment the server pushes without
+ * having been asked for it.
+ *
+ * The tag carries the index of the pushed segment, so the client can tell the
+ * pushed bytes apart from the bytes it requested, even when TCP hands both to
+ * it in the same packet.
+ */
+class TcpStreamPushTag : public Tag {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  TcpStreamPushTag();
+  TcpStreamPushTag(int64_t segment);
+
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(TagBuffer i) const;
+  virtual void Deserialize(TagBuffer i);
+  virtual void Print(std::ostream &os) const;
+
+  /**
+   * \return the index of the pushed segment
+   */
+  int64_t GetSegment(void) const;
+
+private:
+  int64_t m_segment; //!< index of the pushed segment
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Byte tag carrying the load report of the server which sent the bytes.
+ *
+ * The server tags every packet it writes with the number of requests it is
+ * serving and the bytes it still has to send for them, so clients choosing
+ * between several servers learn the load of the ones they download from.
+ */
+class TcpStreamLoadTag : public Tag {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  TcpStreamLoadTag();
+  TcpStreamLoadTag(uint32_t activeRequests, uint64_t backlogBytes);
+
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(TagBuffer i) const;
+  virtual void Deserialize(TagBuffer i);
+  virtual void Print(std::ostream &os) const;
+
+  /**
+   * \return the number of requests the server is serving
+   */
+  uint32_t GetActiveRequests(void) const;
+  /**
+   * \return the bytes the server still has to send for them
+   */
+  uint64_t GetBacklogBytes(void) const;
+
+private:
+  uint32_t m_activeRequests; //!< number of requests being served
+  uint64_t m_backlogBytes;   //!< bytes left to send for them
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_TAG_H */
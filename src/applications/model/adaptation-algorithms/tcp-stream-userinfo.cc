@@ -5,6 +5,13 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("UserinfoAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(UserinfoAlgorithm);
 
+TypeId UserinfoAlgorithm::GetTypeId(void) {
+  static TypeId tid = TypeId("ns3::UserinfoAlgorithm")
+                          .SetParent<Object>()
+                          .SetGroupName("Applications");
+  return tid;
+}
+
 UserinfoAlgorithm::UserinfoAlgorithm(const videoData &videoData,
                                      const playbackData &playbackData,
                                      const bufferData &bufferData,
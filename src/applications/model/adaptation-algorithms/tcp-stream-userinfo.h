@@ -4,6 +4,8 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "tcp-stream-algorithm-registry.h"
+#include "tcp-stream-clock.h"
 #include "tcp-stream-interface.h"
 #include <algorithm>
 #include <assert.h>
@@ -15,9 +17,20 @@
 #include <stdint.h>
 
 namespace ns3 {
-// todo
+/**
+ * \ingroup tcpStream
+ * \brief Base class of the viewport predictors.
+ *
+ * Subclasses are created through AlgorithmRegistry<UserinfoAlgorithm>.
+ */
 class UserinfoAlgorithm : public Object {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   UserinfoAlgorithm(const videoData &videoData,
                     const playbackData &playbackData,
                     const bufferData &bufferData,
@@ -0,0 +1,361 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TCP_STREAM_WINDOW_H
+#define TCP_STREAM_WINDOW_H
+
+#include "ns3/assert.h"
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief A FIFO queue on a ring of preallocated slots.
+ *
+ * Pushing into a full ring doubles it, so a ring reserved for the largest
+ * number of elements it will hold never allocates again.
+ */
+template <typename T> class RingBuffer {
+public:
+  RingBuffer() : m_head(0), m_size(0) {}
+
+  /**
+   * \brief Drop all elements and make room for capacity of them.
+   */
+  void Reserve(uint32_t capacity) {
+    m_slots.assign(capacity, T());
+    m_head = 0;
+    m_size = 0;
+  }
+
+  void PushBack(const T &value) {
+    if (m_size == m_slots.size()) {
+      std::vector<T> slots(m_slots.empty() ? 4 : 2 * m_slots.size());
+      for (uint32_t i = 0; i < m_size; i++) {
+        slots[i] = (*this)[i];
+      }
+      m_slots.swap(slots);
+      m_head = 0;
+    }
+    m_slots[(m_head + m_size) % m_slots.size()] = value;
+    m_size++;
+  }
+
+  void PopFront(void) {
+    NS_ASSERT(m_size > 0);
+    m_head = (m_head + 1) % m_slots.size();
+    m_size--;
+  }
+
+  void PopBack(void) {
+    NS_ASSERT(m_size > 0);
+    m_size--;
+  }
+
+  /**
+   * \return the element i places behind the oldest one
+   */
+  const T &operator[](uint32_t i) const {
+    return m_slots[(m_head + i) % m_slots.size()];
+  }
+
+  const T &Front(void) const { return (*this)[0]; }
+  const T &Back(void) const { return (*this)[m_size - 1]; }
+  uint32_t GetSize(void) const { return m_size; }
+  bool IsEmpty(void) const { return m_size == 0; }
+
+private:
+  std::vector<T> m_slots;
+  uint32_t m_head; //!< slot of the oldest element
+  uint32_t m_size;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Arithmetic mean of a SlidingWindow.
+ *
+ * Like every aggregation it is told about each sample that enters the
+ * window with Add and each that leaves it, always the oldest, with Remove,
+ * and keeps just enough state to answer Get in O(1).
+ */
+class ArithmeticMean {
+public:
+  typedef double value_type;
+
+  ArithmeticMean() { Clear(); }
+  void Reserve(uint32_t capacity) {}
+  void Clear(void) {
+    m_count = 0;
+    m_infinite = 0;
+    m_sum = 0;
+  }
+
+  void Add(double value) {
+    m_count++;
+    if (std::isinf(value)) {
+      m_infinite++;
+    } else {
+      m_sum += value;
+    }
+  }
+
+  void Remove(double value) {
+    m_count--;
+    if (std::isinf(value)) {
+      m_infinite--;
+    } else {
+      m_sum -= value;
+    }
+  }
+
+  /**
+   * \return the mean, 0 without samples
+   */
+  double Get(void) const {
+    if (m_infinite > 0) {
+      return INFINITY;
+    }
+    return m_count > 0 ? m_sum / m_count : 0;
+  }
+
+private:
+  uint32_t m_count;
+  uint32_t m_infinite; //!< samples not in the sum, e.g. of a 0 s download
+  double m_sum;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Harmonic mean of a SlidingWindow; 0 while a sample is <= 0.
+ */
+class HarmonicMean {
+public:
+  typedef double value_type;
+
+  HarmonicMean() { Clear(); }
+  void Reserve(uint32_t capacity) {}
+  void Clear(void) {
+    m_count = 0;
+    m_zeros = 0;
+    m_sum = 0;
+  }
+
+  void Add(double value) {
+    m_count++;
+    if (value <= 0) {
+      m_zeros++;
+    } else {
+      m_sum += 1 / value;
+    }
+  }
+
+  void Remove(double value) {
+    m_count--;
+    if (value <= 0) {
+      m_zeros--;
+    } else {
+      m_sum -= 1 / value;
+    }
+  }
+
+  /**
+   * \return the harmonic mean, 0 without samples
+   */
+  double Get(void) const {
+    if (m_count == 0 || m_zeros > 0) {
+      return 0;
+    }
+    return m_sum > 0 ? m_count / m_sum : INFINITY;
+  }
+
+private:
+  uint32_t m_count;
+  uint32_t m_zeros; //!< samples <= 0, which make the mean 0
+  double m_sum;     //!< of the inverse samples
+};
+
+/**
+ * \brief A sample of a WeightedMean.
+ */
+struct weightedSample {
+  double value;
+  double weight;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Mean of the values of a SlidingWindow weighted by their weights,
+ * e.g. the throughput of downloads weighted by their duration, which is the
+ * bytes of all downloads over their total time.
+ */
+class WeightedMean {
+public:
+  typedef weightedSample value_type;
+
+  WeightedMean() { Clear(); }
+  void Reserve(uint32_t capacity) {}
+  void Clear(void) {
+    m_sum = 0;
+    m_weight = 0;
+  }
+
+  void Add(const weightedSample &sample) {
+    m_sum += sample.value * sample.weight;
+    m_weight += sample.weight;
+  }
+
+  void Remove(const weightedSample &sample) {
+    m_sum -= sample.value * sample.weight;
+    m_weight -= sample.weight;
+  }
+
+  /**
+   * \return the weighted mean, 0 if the weights add up to 0
+   */
+  double Get(void) const { return m_weight > 0 ? m_sum / m_weight : 0; }
+
+  double GetWeight(void) const { return m_weight; }
+
+private:
+  double m_sum; //!< of value * weight
+  double m_weight;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Extreme of a SlidingWindow with a monotone queue: a sample is
+ * dropped from the queue as soon as a newer one is strictly more extreme, so
+ * the front of the queue is always the extreme of the window and every
+ * sample is pushed and popped once, O(1) amortised per Add. Equal samples
+ * are all kept: Remove only gets the value of the oldest sample, and pops
+ * the front when it is equal to it, which is then that sample.
+ *
+ * \tparam Less true if its first argument is less extreme than its second
+ */
+template <typename Less> class MonotoneExtreme {
+public:
+  typedef double value_type;
+
+  void Reserve(uint32_t capacity) { m_queue.Reserve(capacity); }
+  void Clear(void) { m_queue.Reserve(0); }
+
+  void Add(double value) {
+    while (!m_queue.IsEmpty() && Less()(m_queue.Back(), value)) {
+      m_queue.PopBack();
+    }
+    m_queue.PushBack(value);
+  }
+
+  // the oldest sample of the window is the front of the queue unless a more
+  // extreme sample dropped it, and then the front differs from it
+  void Remove(double value) {
+    if (!m_queue.IsEmpty() && !Less()(value, m_queue.Front())) {
+      m_queue.PopFront();
+    }
+  }
+
+  /**
+   * \return the extreme, 0 without samples
+   */
+  double Get(void) const { return m_queue.IsEmpty() ? 0 : m_queue.Front(); }
+
+private:
+  RingBuffer<double> m_queue;
+};
+
+struct greaterThan {
+  bool operator()(double a, double b) const { return a > b; }
+};
+
+typedef MonotoneExtreme<greaterThan> Minimum; //!< Minimum of a window
+
+/**
+ * \ingroup tcpStream
+ * \brief The last samples of a series and an aggregate of them.
+ *
+ * A window with a capacity keeps the last capacity samples in preallocated
+ * slots: pushing a sample drops the oldest one, both are O(1) and the
+ * memory stays constant however long the series. A window without a
+ * capacity keeps every sample until the caller drops the oldest one with
+ * PopFront, e.g. once it is older than a time window.
+ *
+ * \tparam Aggregation ArithmeticMean, HarmonicMean, WeightedMean, Minimum
+ * or any class with the same members
+ */
+template <typename Aggregation> class SlidingWindow {
+public:
+  typedef typename Aggregation::value_type value_type;
+
+  /**
+   * \param capacity the number of samples kept, 0 for no limit
+   */
+  explicit SlidingWindow(uint32_t capacity = 0) { SetCapacity(capacity); }
+
+  /**
+   * \brief Drop all samples and keep at most capacity of them from now on,
+   * 0 for no limit.
+   */
+  void SetCapacity(uint32_t capacity) {
+    m_capacity = capacity;
+    m_samples.Reserve(capacity);
+    m_aggregation.Clear();
+    m_aggregation.Reserve(capacity);
+  }
+
+  /**
+   * \brief Add a sample, dropping the oldest one if the window is full.
+   */
+  void Push(const value_type &sample) {
+    if (m_capacity > 0 && m_samples.GetSize() == m_capacity) {
+      PopFront();
+    }
+    m_samples.PushBack(sample);
+    m_aggregation.Add(sample);
+  }
+
+  /**
+   * \brief Drop the oldest sample.
+   */
+  void PopFront(void) {
+    m_aggregation.Remove(m_samples.Front());
+    m_samples.PopFront();
+  }
+
+  /**
+   * \return the aggregate of the samples in the window
+   */
+  double Get(void) const { return m_aggregation.Get(); }
+
+  const Aggregation &GetAggregation(void) const { return m_aggregation; }
+  const value_type &Front(void) const { return m_samples.Front(); }
+  uint32_t GetSize(void) const { return m_samples.GetSize(); }
+  uint32_t GetCapacity(void) const { return m_capacity; }
+  bool IsEmpty(void) const { return m_samples.IsEmpty(); }
+
+private:
+  uint32_t m_capacity;
+  RingBuffer<value_type> m_samples;
+  Aggregation m_aggregation;
+};
+
+} // namespace ns3
+#endif /* TCP_STREAM_WINDOW_H */
@@ -1,24 +1,203 @@
 #include "userinfo-prediction.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <sstream>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("UserPredictionAlgorithm");
 NS_OBJECT_ENSURE_REGISTERED(UserPredictionAlgorithm);
+TCP_STREAM_REGISTER_ALGORITHM(UserinfoAlgorithm, UserPredictionAlgorithm);
+
+// wrap an angle in degrees into [-180, 180)
+static double WrapAngle(double angle) {
+  angle = std::fmod(angle + 180.0, 360.0);
+  if (angle < 0) angle += 360.0;
+  return angle - 180.0;
+}
+
+SlidingRegression::SlidingRegression()
+    : m_sumT(0), m_sumY(0), m_sumTT(0), m_sumTY(0) {}
+
+void SlidingRegression::Add(double t, double y, uint32_t window) {
+  m_samples.push_back(std::make_pair(t, y));
+  m_sumT += t;
+  m_sumY += y;
+  m_sumTT += t * t;
+  m_sumTY += t * y;
+  while (m_samples.size() > window) {
+    const std::pair<double, double> &oldest = m_samples.front();
+    m_sumT -= oldest.first;
+    m_sumY -= oldest.second;
+    m_sumTT -= oldest.first * oldest.first;
+    m_sumTY -= oldest.first * oldest.second;
+    m_samples.pop_front();
+  }
+}
+
+double SlidingRegression::Predict(double t, double lambda) const {
+  const double n = m_samples.size();
+  if (n < 2) {
+    return GetLast();
+  }
+  const double meanT = m_sumT / n;
+  const double meanY = m_sumY / n;
+  const double stt = m_sumTT - n * meanT * meanT;
+  const double sty = m_sumTY - n * meanT * meanY;
+  const double slope = stt + lambda > 0 ? sty / (stt + lambda) : 0.0;
+  return meanY + slope * (t - meanT);
+}
+
+bool SlidingRegression::IsEmpty(void) const { return m_samples.empty(); }
+
+double SlidingRegression::GetLast(void) const {
+  return m_samples.empty() ? 0.0 : m_samples.back().second;
+}
+
+TypeId UserPredictionAlgorithm::GetTypeId(void) {
+  static TypeId tid =
+      TypeId("ns3::UserPredictionAlgorithm")
+          .SetParent<UserinfoAlgorithm>()
+          .SetGroupName("Applications")
+          .AddAttribute(
+              "TraceFile",
+              "Head orientation trace, one \"time yaw pitch\" sample per "
+              "line in seconds of video time and degrees. Empty to keep the "
+              "viewpoints of the user info file",
+              StringValue(""),
+              MakeStringAccessor(&UserPredictionAlgorithm::m_traceFile),
+              MakeStringChecker())
+          .AddAttribute(
+              "Method", "How the head orientation is forecast",
+              EnumValue(UserPredictionAlgorithm::LINEAR),
+              MakeEnumAccessor(&UserPredictionAlgorithm::m_method),
+              MakeEnumChecker(UserPredictionAlgorithm::LAST, "last",
+                              UserPredictionAlgorithm::LINEAR, "linear",
+                              UserPredictionAlgorithm::RIDGE, "ridge"))
+          .AddAttribute(
+              "Window", "Number of recent samples the regression is fit to",
+              UintegerValue(30),
+              MakeUintegerAccessor(&UserPredictionAlgorithm::m_window),
+              MakeUintegerChecker<uint32_t>(2))
+          .AddAttribute(
+              "Lambda",
+              "Ridge penalty on the slope, in square seconds, for the ridge "
+              "method",
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&UserPredictionAlgorithm::m_lambda),
+              MakeDoubleChecker<double>(0.0));
+  return tid;
+}
 
 UserPredictionAlgorithm::UserPredictionAlgorithm(
     const videoData &videoData, const playbackData &playbackData,
     const bufferData &bufferData, const throughputData &throughput)
-    : UserinfoAlgorithm(videoData, playbackData, bufferData, throughput) {
+    : UserinfoAlgorithm(videoData, playbackData, bufferData, throughput),
+      m_method(LINEAR), m_window(30), m_lambda(1.0), m_nextSample(0),
+      m_unwrappedYaw(0) {
   NS_LOG_INFO(this);
 }
 
+void UserPredictionAlgorithm::DoInitialize(void) {
+  if (!m_traceFile.empty()) {
+    std::ifstream trace(m_traceFile.c_str());
+    if (!trace) {
+      NS_FATAL_ERROR("Could not read the head orientation trace "
+                     << m_traceFile);
+    }
+    std::string line;
+    while (std::getline(trace, line)) {
+      std::istringstream fields(line);
+      double time, yaw, pitch;
+      if (fields >> time >> yaw >> pitch) {
+        headSample sample;
+        sample.time = time * 1000000;
+        sample.yaw = yaw;
+        sample.pitch = pitch;
+        m_trace.push_back(sample);
+      }
+    }
+    NS_LOG_INFO("Read " << m_trace.size() << " head orientation samples");
+  }
+  UserinfoAlgorithm::DoInitialize();
+}
+
+void UserPredictionAlgorithm::Ingest(int64_t t) {
+  while (m_nextSample < m_trace.size() && m_trace[m_nextSample].time <= t) {
+    const headSample &sample = m_trace[m_nextSample++];
+    if (m_yaw.IsEmpty()) {
+      m_unwrappedYaw = sample.yaw;
+    } else {
+      m_unwrappedYaw += WrapAngle(sample.yaw - WrapAngle(m_unwrappedYaw));
+    }
+    m_yaw.Add(sample.time / 1000000.0, m_unwrappedYaw, m_window);
+    m_pitch.Add(sample.time / 1000000.0, sample.pitch, m_window);
+  }
+}
+
+int64_t UserPredictionAlgorithm::GetViewpoint(double yaw, double pitch,
+                                              int64_t viewpoints) {
+  if (viewpoints <= 1) {
+    return 0;
+  }
+  const double radian = M_PI / 180.0;
+  if (viewpoints == 6) {
+    const double front = std::cos(pitch * radian) * std::cos(yaw * radian);
+    const double right = std::cos(pitch * radian) * std::sin(yaw * radian);
+    const double up = std::sin(pitch * radian);
+    if (std::fabs(up) >= std::fabs(front) &&
+        std::fabs(up) >= std::fabs(right)) {
+      return up > 0 ? 2 : 3;
+    }
+    if (std::fabs(right) >= std::fabs(front)) {
+      return right > 0 ? 0 : 1;
+    }
+    return front > 0 ? 4 : 5;
+  }
+  int64_t sector = (WrapAngle(yaw) + 180.0) / 360.0 * viewpoints;
+  return std::min(sector, viewpoints - 1);
+}
+
 userinfoAlgoReply
 UserPredictionAlgorithm::UserinfoAlgo(const int64_t segmentCounter,
                                       const int64_t clientId) {
   userinfoAlgoReply answer;
-  const int64_t timeNow = Simulator::Now().GetMicroSeconds();
+  const int64_t timeNow = AlgorithmClock::Now();
   answer.decisionTime = timeNow;
+  answer.viewpoint = -1;
+  answer.yaw = 0;
+  answer.pitch = 0;
+  if (m_trace.empty()) {
+    return answer;
+  }
+
+  // the user has watched the video up to the playback position
+  const int64_t segmentDuration = m_videoData.segmentDuration;
+  int64_t watched = 0;
+  if (!m_playbackData.playbackStart.empty()) {
+    watched = (m_playbackData.playbackStart.size() - 1) * segmentDuration +
+              std::min(timeNow - m_playbackData.playbackStart.back(),
+                       segmentDuration);
+  }
+  Ingest(std::max(watched, m_trace.front().time));
+
+  // forecast the middle of the segment
+  const double target =
+      (segmentCounter * segmentDuration + segmentDuration / 2) / 1000000.0;
+  double yaw = m_yaw.GetLast();
+  double pitch = m_pitch.GetLast();
+  if (m_method != LAST) {
+    const double lambda = m_method == RIDGE ? m_lambda : 0.0;
+    yaw = m_yaw.Predict(target, lambda);
+    pitch = m_pitch.Predict(target, lambda);
+  }
+  answer.yaw = WrapAngle(yaw);
+  answer.pitch = std::max(-90.0, std::min(90.0, pitch));
+  answer.viewpoint =
+      GetViewpoint(answer.yaw, answer.pitch, m_videoData.ladders.size());
   return answer;
 }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
@@ -1,11 +1,72 @@
 #ifndef USERPREDICTION_ALGORITHM_H
 #define USERPREDICTION_ALGORITHM_H
 #include "tcp-stream-userinfo.h"
+#include <deque>
+#include <string>
+#include <vector>
 
 namespace ns3 {
-// todo
+
+/**
+ * \ingroup tcpStream
+ * \brief Least squares line y = a + b t over the last samples of a series.
+ *
+ * Keeps the sums over the window, so adding a sample and dropping the
+ * oldest one are O(1). With a ridge penalty lambda > 0 the slope is shrunk
+ * towards 0: b = S_ty / (S_tt + lambda), with the centred sums S.
+ */
+class SlidingRegression {
+public:
+  SlidingRegression();
+
+  /**
+   * \brief Add a sample, dropping the oldest one if the window is full.
+   */
+  void Add(double t, double y, uint32_t window);
+
+  /**
+   * \return the value of the line at t, or the last sample if there are
+   * fewer than two samples
+   */
+  double Predict(double t, double lambda) const;
+
+  bool IsEmpty(void) const;
+  double GetLast(void) const;
+
+private:
+  std::deque<std::pair<double, double>> m_samples; //!< (t, y) in the window
+  double m_sumT;
+  double m_sumY;
+  double m_sumTT;
+  double m_sumTY;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Head-motion viewport predictor.
+ *
+ * Reads a head orientation trace with one "time yaw pitch" sample per line
+ * (seconds of video time, degrees) and feeds it to the predictor as the
+ * playback advances, one O(1) update per sample. For the segment about to be
+ * requested, the orientation in the middle of the segment is forecast with
+ * the Method
+ * - last: the last orientation,
+ * - linear: least squares over the last Window samples,
+ * - ridge: as linear, with the slope shrunk by Lambda,
+ * where the yaw is unwrapped so that turning across +-180 degrees is a
+ * straight line. The orientation is mapped onto the viewpoints of the video:
+ * with six viewpoints onto the cube faces in the order right, left, up, down,
+ * front, back; with other numbers onto equal yaw sectors starting at -180
+ * degrees. Without a TraceFile the viewpoints of videoData::userInfo are kept.
+ */
 class UserPredictionAlgorithm : public UserinfoAlgorithm {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
   UserPredictionAlgorithm(const videoData &videoData,
                           const playbackData &playbackData,
                           const bufferData &bufferData,
@@ -13,7 +74,53 @@ public:
 
   userinfoAlgoReply UserinfoAlgo(const int64_t segmentCounter,
                                  const int64_t clientId);
+
+  /**
+   * \brief The prediction methods.
+   */
+  enum predictionMethod {
+    LAST,   //!< last value
+    LINEAR, //!< linear regression over the window
+    RIDGE   //!< ridge regression over the window
+  };
+
+  /**
+   * \return the viewpoint, out of viewpoints, that contains the direction
+   * (yaw, pitch) in degrees
+   */
+  static int64_t GetViewpoint(double yaw, double pitch, int64_t viewpoints);
+
+protected:
+  /**
+   * \brief Read the TraceFile.
+   */
+  virtual void DoInitialize(void);
+
+private:
+  /**
+   * \brief Feed the samples up to video time t in microseconds.
+   */
+  void Ingest(int64_t t);
+
+  /**
+   * \brief a sample of the head orientation trace.
+   */
+  struct headSample {
+    int64_t time; //!< video time in microseconds
+    double yaw;   //!< degrees
+    double pitch; //!< degrees
+  };
+
+  std::string m_traceFile;
+  predictionMethod m_method;
+  uint32_t m_window;        //!< number of samples of the regression
+  double m_lambda;          //!< ridge penalty
+  std::vector<headSample> m_trace;
+  uint32_t m_nextSample;    //!< index of the first sample not fed yet
+  double m_unwrappedYaw;    //!< yaw of the last fed sample, unwrapped
+  SlidingRegression m_yaw;
+  SlidingRegression m_pitch;
 };
 
 } // namespace ns3
-#endif /* BUFFERCLEAN_ALGORITHM_H */
\ No newline at end of file
+#endif /* BUFFERCLEAN_ALGORITHM_H */
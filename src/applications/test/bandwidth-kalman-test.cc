@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/bandwidth-kalman.h"
+#include "ns3/test.h"
+#include "ns3/tcp-stream-clock.h"
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * \ingroup tcpStream
+ * \brief A throughput which fluctuates around the same median as a steady
+ * one gets a lower estimate from BandwidthKalmanAlgorithm, because the
+ * filter is less sure of it.
+ */
+class BandwidthKalmanNoiseTestCase : public TestCase {
+public:
+  BandwidthKalmanNoiseTestCase();
+
+private:
+  virtual void DoRun(void);
+
+  /**
+   * \brief Run the estimator over segments of one second, whose throughput
+   * alternates between median * exp(-spread) and median * exp(spread),
+   * ending with the higher one.
+   * \return the estimate after the last segment and its variance
+   */
+  static bandwidthAlgoReply Estimate(double median, double spread);
+};
+
+BandwidthKalmanNoiseTestCase::BandwidthKalmanNoiseTestCase()
+    : TestCase("Kalman estimate of a noisy and a steady throughput") {}
+
+bandwidthAlgoReply BandwidthKalmanNoiseTestCase::Estimate(double median,
+                                                          double spread) {
+  const uint32_t segments = 40;
+  videoData video;
+  video.segmentDuration = 1000000;
+  video.segmentSize.push_back(std::vector<std::vector<int64_t>>(
+      1, std::vector<int64_t>(segments, 500000)));
+  video.averageBitrate.push_back(std::vector<double>(1, 4000000));
+  video.ladders.push_back(
+      BitrateLadder(video.segmentSize[0], video.averageBitrate[0]));
+  video.userInfo.assign(segments, 0);
+  playbackData playback;
+  bufferData buffer;
+  throughputData throughput;
+
+  Ptr<BandwidthAlgorithm> kalman = AlgorithmRegistry<BandwidthAlgorithm>::
+      Create(BandwidthKalmanAlgorithm::GetTypeId(), video, playback, buffer,
+             throughput);
+  kalman->Initialize();
+  int64_t now = 0;
+  AlgorithmClock::SetThreadClock(&now);
+  for (uint32_t s = 0; s < segments; s++) {
+    const double bitrate = median * std::exp(s % 2 == 0 ? -spread : spread);
+    throughput.transmissionRequested.push_back(now);
+    throughput.transmissionStart.push_back(now);
+    now += 1000000;
+    throughput.transmissionEnd.push_back(now);
+    throughput.bytesReceived.push_back((int64_t)(bitrate / 8));
+  }
+  bandwidthAlgoReply reply = kalman->BandwidthAlgo(segments, 0);
+  AlgorithmClock::SetThreadClock(0);
+  kalman->Dispose();
+  return reply;
+}
+
+void BandwidthKalmanNoiseTestCase::DoRun(void) {
+  const bandwidthAlgoReply steady = Estimate(4000000, 0);
+  const bandwidthAlgoReply noisy = Estimate(4000000, 0.5);
+  NS_TEST_ASSERT_MSG_GT(noisy.bandwidthVariance, steady.bandwidthVariance,
+                        "A fluctuating throughput is more uncertain");
+  NS_TEST_ASSERT_MSG_LT(noisy.bandwidthEstimate, steady.bandwidthEstimate,
+                        "A fluctuating throughput gets a lower estimate");
+  NS_TEST_ASSERT_MSG_LT(steady.bandwidthEstimate, 4000000,
+                        "The estimate stays below the median");
+}
+
+/**
+ * \ingroup tcpStream
+ * \brief Tests of BandwidthKalmanAlgorithm.
+ */
+class BandwidthKalmanTestSuite : public TestSuite {
+public:
+  BandwidthKalmanTestSuite();
+};
+
+BandwidthKalmanTestSuite::BandwidthKalmanTestSuite()
+    : TestSuite("tcp-stream-bandwidth-kalman", UNIT) {
+  AddTestCase(new BandwidthKalmanNoiseTestCase, TestCase::QUICK);
+}
+
+static BandwidthKalmanTestSuite g_bandwidthKalmanTestSuite; //!< the suite
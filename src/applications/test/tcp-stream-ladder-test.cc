@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/tcp-stream-ladder.h"
+#include "ns3/test.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup tcpStream
+ * \brief Compare BitrateLadder::GetMaxSize with a scan over every run of
+ * segments, including runs cut at the last segment.
+ */
+class BitrateLadderMaxSizeTestCase : public TestCase {
+public:
+  BitrateLadderMaxSizeTestCase();
+
+private:
+  virtual void DoRun(void);
+};
+
+BitrateLadderMaxSizeTestCase::BitrateLadderMaxSizeTestCase()
+    : TestCase("Largest segment of a run of segments") {}
+
+void BitrateLadderMaxSizeTestCase::DoRun(void) {
+  // 37 segments, not a power of two, with sizes that are not sorted by
+  // representation everywhere
+  const int64_t reps = 4;
+  const int64_t segments = 37;
+  std::vector<std::vector<int64_t>> sizes(reps);
+  std::vector<double> bitrates;
+  uint32_t seed = 12345;
+  for (int64_t rep = 0; rep < reps; rep++) {
+    for (int64_t segment = 0; segment < segments; segment++) {
+      seed = seed * 1103515245 + 12345;
+      sizes[rep].push_back((rep + 1) * 100000 + (seed >> 16) % 150000);
+    }
+    bitrates.push_back((rep + 1) * 1000000.0);
+  }
+  BitrateLadder ladder(sizes, bitrates);
+
+  for (int64_t rep = 0; rep < reps; rep++) {
+    for (int64_t first = 0; first < segments; first++) {
+      for (int64_t count = 1; count <= segments + 3; count++) {
+        const int64_t end = std::min(first + count, segments);
+        const int64_t expected = *std::max_element(
+            sizes[rep].begin() + first, sizes[rep].begin() + end);
+        NS_TEST_ASSERT_MSG_EQ(ladder.GetMaxSize(rep, first, count), expected,
+                              "rep " << rep << ", " << count
+                                     << " segments from " << first);
+      }
+    }
+    NS_TEST_ASSERT_MSG_EQ(ladder.GetMaxSize(rep, 0, 0), 0,
+                          "An empty run has no largest segment");
+    NS_TEST_ASSERT_MSG_EQ(ladder.GetMaxSize(rep, segments, 5), 0,
+                          "A run after the last segment is empty");
+  }
+}
+
+/**
+ * \ingroup tcpStream
+ * \brief Tests of the BitrateLadder index.
+ */
+class BitrateLadderTestSuite : public TestSuite {
+public:
+  BitrateLadderTestSuite();
+};
+
+BitrateLadderTestSuite::BitrateLadderTestSuite()
+    : TestSuite("tcp-stream-ladder", UNIT) {
+  AddTestCase(new BitrateLadderMaxSizeTestCase, TestCase::QUICK);
+}
+
+static BitrateLadderTestSuite g_bitrateLadderTestSuite; //!< the test suite
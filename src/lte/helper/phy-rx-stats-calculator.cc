@@ -27,12 +27,13 @@
 
 namespace ns3 {
 
-std::deque<PhyRxStatsCalculator::Time_Tbs> result;
-
 NS_LOG_COMPONENT_DEFINE("PhyRxStatsCalculator");
 
 NS_OBJECT_ENSURE_REGISTERED(PhyRxStatsCalculator);
 
+const int64_t PhyRxStatsCalculator::kCorrectTbsWindow;
+const uint32_t PhyRxStatsCalculator::kDlMcsCount;
+
 PhyRxStatsCalculator::PhyRxStatsCalculator()
     : m_dlRxFirstWrite(true), m_ulRxFirstWrite(true) {
   NS_LOG_FUNCTION(this);
@@ -84,7 +85,7 @@ void PhyRxStatsCalculator::DlPhyReception(PhyReceptionStatParameters params) {
                        << params.m_correctness);
   NS_LOG_INFO("Write DL Rx Phy Stats in " << GetDlRxOutputFilename().c_str());
 
-  std::ofstream outFile;
+  std::ofstream &outFile = m_dlRxOutFile;
   if (m_dlRxFirstWrite == true) {
     outFile.open(GetDlRxOutputFilename().c_str());
     if (!outFile.is_open()) {
@@ -96,12 +97,8 @@ void PhyRxStatsCalculator::DlPhyReception(PhyReceptionStatParameters params) {
                "time\tcellId\tIMSI\tRNTI\ttxMode\tlayer\tmcs\tsize\trv\tndi\tco"
                "rrect\tccId";
     outFile << std::endl;
-  } else {
-    outFile.open(GetDlRxOutputFilename().c_str(), std::ios_base::app);
-    if (!outFile.is_open()) {
-      NS_LOG_ERROR("Can't open file " << GetDlRxOutputFilename().c_str());
-      return;
-    }
+  } else if (!outFile.is_open()) {
+    return;
   }
 
   //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
@@ -116,14 +113,25 @@ void PhyRxStatsCalculator::DlPhyReception(PhyReceptionStatParameters params) {
   outFile << (uint32_t)params.m_rv << "\t";
   outFile << (uint32_t)params.m_ndi << "\t";
   outFile << (uint32_t)params.m_correctness << "\t";
-  outFile << (uint32_t)params.m_ccId << std::endl;
-  outFile.close();
+  outFile << (uint32_t)params.m_ccId << "\n";
   PhyRxStatsCalculator::Time_Tbs temp;
   temp.timestamp = params.m_timestamp;
   temp.tbsize = params.m_size;
   temp.imsi = params.m_imsi;
-  if (params.m_correctness == (uint32_t)1 && params.m_rv == (uint32_t)0)
-    result.push_front(temp);
+  if (params.m_correctness == (uint32_t)1 && params.m_rv == (uint32_t)0) {
+    std::deque<Time_Tbs> &tbs = m_correctTbs[params.m_imsi];
+    tbs.push_front(temp);
+    while (tbs.back().timestamp < params.m_timestamp - kCorrectTbsWindow) {
+      tbs.pop_back();
+    }
+  }
+  if (params.m_correctness == (uint32_t)1) {
+    CellLoad &load = m_dlCellLoad[params.m_cellId];
+    load.bytes += params.m_size;
+    if (params.m_mcs < kDlMcsCount) {
+      load.mcsTbs[params.m_mcs]++;
+    }
+  }
 }
 
 void PhyRxStatsCalculator::UlPhyReception(PhyReceptionStatParameters params) {
@@ -133,7 +141,7 @@ void PhyRxStatsCalculator::UlPhyReception(PhyReceptionStatParameters params) {
                        << params.m_correctness);
   NS_LOG_INFO("Write UL Rx Phy Stats in " << GetUlRxOutputFilename().c_str());
 
-  std::ofstream outFile;
+  std::ofstream &outFile = m_ulRxOutFile;
   if (m_ulRxFirstWrite == true) {
     outFile.open(GetUlRxOutputFilename().c_str());
     if (!outFile.is_open()) {
@@ -145,12 +153,8 @@ void PhyRxStatsCalculator::UlPhyReception(PhyReceptionStatParameters params) {
         << "% "
            "time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi\tcorrect\tccId";
     outFile << std::endl;
-  } else {
-    outFile.open(GetUlRxOutputFilename().c_str(), std::ios_base::app);
-    if (!outFile.is_open()) {
-      NS_LOG_ERROR("Can't open file " << GetUlRxOutputFilename().c_str());
-      return;
-    }
+  } else if (!outFile.is_open()) {
+    return;
   }
 
   //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
@@ -164,8 +168,7 @@ void PhyRxStatsCalculator::UlPhyReception(PhyReceptionStatParameters params) {
   outFile << (uint32_t)params.m_rv << "\t";
   outFile << (uint32_t)params.m_ndi << "\t";
   outFile << (uint32_t)params.m_correctness << "\t";
-  outFile << (uint32_t)params.m_ccId << std::endl;
-  outFile.close();
+  outFile << (uint32_t)params.m_ccId << "\n";
 }
 
 void PhyRxStatsCalculator::DlPhyReceptionCallback(
@@ -208,14 +211,22 @@ void PhyRxStatsCalculator::UlPhyReceptionCallback(
 /*
 To get TBSize
 */
-std::deque<PhyRxStatsCalculator::Time_Tbs> PhyRxStatsCalculator::GetCorrectTbs(
-    void) {
-  std::deque<PhyRxStatsCalculator::Time_Tbs> result_temp = result;
-  result_temp.resize(5000);
-  result_temp.at((result_temp.size() - 1)).timescale =
-      (double)(result_temp.at(0).timestamp -
-               result_temp.at(result_temp.size() - 1).timestamp);
-  return result_temp;
+const std::deque<PhyRxStatsCalculator::Time_Tbs> &
+PhyRxStatsCalculator::GetCorrectTbs(uint64_t imsi) const {
+  static const std::deque<Time_Tbs> none;
+  std::map<uint64_t, std::deque<Time_Tbs> >::const_iterator it =
+      m_correctTbs.find(imsi);
+  return it == m_correctTbs.end() ? none : it->second;
+}
+
+PhyRxStatsCalculator::CellLoad PhyRxStatsCalculator::GetDlCellLoad(
+    uint16_t cellId) const {
+  std::map<uint16_t, CellLoad>::const_iterator it =
+      m_dlCellLoad.find(cellId);
+  if (it == m_dlCellLoad.end()) {
+    return CellLoad();
+  }
+  return it->second;
 }
 
 }  // namespace ns3
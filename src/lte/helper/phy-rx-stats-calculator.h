@@ -26,6 +26,7 @@
 #include <ns3/lte-common.h>
 #include <deque>
 #include <fstream>
+#include <map>
 #include <string>
 #include "ns3/lte-stats-calculator.h"
 #include "ns3/nstime.h"
@@ -134,10 +135,39 @@ class PhyRxStatsCalculator : public LteStatsCalculator {
     int64_t timestamp;
     uint16_t tbsize;
     uint32_t imsi;
-    double timescale;
   };
 
-  std::deque<Time_Tbs> GetCorrectTbs();
+  /**
+   * \param imsi the UE
+   * \return the correctly received first transmissions of the UE in the
+   * last kCorrectTbsWindow ms, the most recent first
+   */
+  const std::deque<Time_Tbs> &GetCorrectTbs(uint64_t imsi) const;
+
+  /**
+   * The time in ms GetCorrectTbs() reaches back, older transport blocks are
+   * dropped.
+   */
+  static const int64_t kCorrectTbsWindow = 5000;
+
+  /**
+   * The number of downlink MCS, 0 to 28.
+   */
+  static const uint32_t kDlMcsCount = 29;
+
+  /**
+   * The downlink load of a cell since the start of the simulation.
+   */
+  struct CellLoad {
+    uint64_t bytes;  ///< bytes of the correctly received transport blocks
+    uint64_t mcsTbs[kDlMcsCount];  ///< number of them per MCS
+  };
+
+  /**
+   * \param cellId the cell
+   * \return the downlink load of the cell, all 0 if nothing was received
+   */
+  CellLoad GetDlCellLoad(uint16_t cellId) const;
 
   Time_Tbs temp;
 
@@ -157,6 +187,23 @@ class PhyRxStatsCalculator : public LteStatsCalculator {
    * files have not been opened yet
    */
   bool m_ulRxFirstWrite;
+
+  /**
+   * The output files, opened at the first write and kept open, since there
+   * is a line for every transport block of every UE.
+   */
+  std::ofstream m_dlRxOutFile;
+  std::ofstream m_ulRxOutFile;  ///< \see m_dlRxOutFile
+
+  /**
+   * The transport blocks GetCorrectTbs() returns, by IMSI.
+   */
+  std::map<uint64_t, std::deque<Time_Tbs>> m_correctTbs;
+
+  /**
+   * The downlink load of every cell, updated with every reception.
+   */
+  std::map<uint16_t, CellLoad> m_dlCellLoad;
 };
 
 }  // namespace ns3
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Parameter sweeps of scratch/dash on many cores.
+#
+# Expands the grid of the given values of algorithm, simulationId,
+# scenarioId (or scenario files), BandWidth and seed, and runs the
+# simulations in parallel processes, each in its own directory under the
+# output directory, so the logs of mylogs/ and the LTE traces of the runs do
+# not collide. When all runs are done, the QoE of the clients of every run is
+# read from their logs and merged into one table, with the wall time and the
+# peak resident memory of every run.
+#
+# ./waf build
+# ./sweep.py --algorithms=tobasco,festive,tomato --simulationIds=1,2,3,4 \
+#     --seeds=1,2 --jobs=64 --output=sweep
+
+import argparse
+import glob
+import itertools
+import os
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+
+
+def split(values):
+    return [v for v in values.split(',') if v]
+
+
+def find_binary():
+    """The dash program of the last build."""
+    candidates = (glob.glob(os.path.join(ROOT, 'build', 'scratch', 'dash')) +
+                  glob.glob(os.path.join(ROOT, 'build', 'scratch',
+                                         '*-dash-*')))
+    candidates = [c for c in candidates if os.access(c, os.X_OK)]
+    if not candidates:
+        return None
+    return max(candidates, key=os.path.getmtime)
+
+
+def read_columns(path):
+    rows = []
+    try:
+        with open(path) as log:
+            for line in log:
+                fields = line.split()
+                if fields:
+                    rows.append(fields)
+    except IOError:
+        pass
+    return rows
+
+
+def client_qoe(prefix):
+    """QoE of one client from the logs written by TcpStreamClient."""
+    downloads = read_columns(prefix + 'downloadLog.txt')
+    if not downloads:
+        return None
+    adaptation = read_columns(prefix + 'adaptationLog.txt')
+    playback = read_columns(prefix + 'playbackLog.txt')
+    stalls = read_columns(prefix + 'bufferUnderrunLog.txt')
+    handovers = read_columns(prefix + 'handoverLog.txt')
+    # the last column of the download log is the bitrate of the segment
+    bitrate = sum(float(d[-1]) for d in downloads) / len(downloads)
+    reps = [int(a[1]) for a in adaptation]
+    switches = sum(1 for a, b in zip(reps, reps[1:]) if a != b)
+    stall_time = sum(float(s[1]) - float(s[0]) for s in stalls
+                     if len(s) >= 2)
+    startup = (float(playback[0][1]) - float(downloads[0][1])
+               if playback else 0.0)
+    # the last column of the handover log is the rebuffering it caused
+    handover_stall_time = sum(float(h[-1]) for h in handovers)
+    return [bitrate, switches, len(stalls), stall_time, startup,
+            len(handovers), handover_stall_time]
+
+
+def run_qoe(directory):
+    """Mean QoE over the clients of a run, and their number."""
+    clients = []
+    for log in glob.glob(os.path.join(directory, 'mylogs', '*', '*',
+                                      'sim*_cl*_downloadLog.txt')):
+        qoe = client_qoe(log[:-len('downloadLog.txt')])
+        if qoe is not None:
+            clients.append(qoe)
+    if not clients:
+        return 0, [0.0] * 7
+    return len(clients), [sum(c[i] for c in clients) / len(clients)
+                          for i in range(7)]
+
+
+def run_runtime(directory):
+    """Events and events per second of a run, from its runtime report."""
+    for log in glob.glob(os.path.join(directory, 'mylogs', '*', '*',
+                                      'sim*_runtime.txt')):
+        rows = read_columns(log)
+        if len(rows) > 1:
+            return int(rows[1][5]), float(rows[1][6])
+    return 0, 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Run a grid of scratch/dash simulations in parallel.')
+    parser.add_argument('--algorithms', default='tobasco')
+    parser.add_argument('--simulationIds', default='4')
+    parser.add_argument('--scenarioIds', default='0')
+    parser.add_argument('--scenarios', default='',
+                        help='scenario files, instead of the ones of '
+                        'simulationIds and scenarioIds')
+    parser.add_argument('--bandwidths', default='75')
+    parser.add_argument('--seeds', default='1', help='values of RngRun')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count() or 1,
+                        help='simulations running at the same time')
+    parser.add_argument('--output', default='sweep',
+                        help='directory of the runs and of sweep.txt')
+    parser.add_argument('--binary', default='',
+                        help='the dash program, the last build by default')
+    parser.add_argument('args', nargs=argparse.REMAINDER,
+                        help='further arguments of every run, after --')
+    options = parser.parse_args()
+
+    binary = options.binary or find_binary()
+    if not binary:
+        sys.exit('No build of scratch/dash found, run ./waf build first')
+    binary = os.path.abspath(binary)
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.pathsep.join(
+        [os.path.join(ROOT, 'build', 'lib'), os.path.join(ROOT, 'build')] +
+        ([env['LD_LIBRARY_PATH']] if env.get('LD_LIBRARY_PATH') else []))
+    extra = [a for a in options.args if a != '--']
+
+    # every scenario is (name, simulationId, scenario file)
+    if options.scenarios:
+        scenarios = [(os.path.splitext(os.path.basename(s))[0], str(i),
+                      os.path.abspath(s))
+                     for i, s in enumerate(split(options.scenarios))]
+    else:
+        scenarios = [('sim%s-%s' % (sim, sce), sim,
+                      os.path.join(ROOT, 'scenarios',
+                                   'sim%s-%s.txt' % (sim, sce)))
+                     for sim in split(options.simulationIds)
+                     for sce in split(options.scenarioIds)]
+    grid = list(itertools.product(split(options.algorithms), scenarios,
+                                  split(options.bandwidths),
+                                  split(options.seeds)))
+
+    output = os.path.abspath(options.output)
+    runs = []
+    for number, (algorithm, (name, simulation_id, scenario), bandwidth,
+                 seed) in enumerate(grid):
+        directory = os.path.join(output, 'run%04d' % number)
+        os.makedirs(directory, exist_ok=True)
+        # the fading traces are found relative to the ns-3 folder
+        link = os.path.join(directory, 'src')
+        if not os.path.lexists(link):
+            os.symlink(os.path.join(ROOT, 'src'), link)
+        command = [binary,
+                   '--adaptationAlgo=' + algorithm,
+                   '--simulationId=' + simulation_id,
+                   '--scenario=' + scenario,
+                   '--BandWidth=' + bandwidth,
+                   '--RngRun=' + seed,
+                   '--segmentSizeFiles=' + os.path.join(ROOT,
+                                                        'SegmentSize.txt'),
+                   '--userInfoFile=' + os.path.join(ROOT, 'UserInfo.txt')
+                   ] + extra
+        runs.append({'directory': directory, 'command': command,
+                     'params': [algorithm, name, bandwidth, seed]})
+
+    # keep jobs processes running, reap them with their resource usage
+    pending = list(reversed(runs))
+    running = {}
+    start_all = time.time()
+    while pending or running:
+        while pending and len(running) < options.jobs:
+            run = pending.pop()
+            log = os.path.join(run['directory'], 'stdout.txt')
+            with open(log, 'w') as out:
+                process = subprocess.Popen(run['command'],
+                                           cwd=run['directory'], env=env,
+                                           stdout=out,
+                                           stderr=subprocess.STDOUT)
+            # kept so that subprocess does not reap it before wait4
+            run['process'] = process
+            run['start'] = time.time()
+            running[process.pid] = run
+        pid, status, usage = os.wait4(-1, 0)
+        if pid not in running:
+            continue
+        run = running.pop(pid)
+        run['wall'] = time.time() - run['start']
+        run['rss'] = usage.ru_maxrss / 1024.0  # kB on Linux
+        run['status'] = os.waitstatus_to_exitcode(status) \
+            if hasattr(os, 'waitstatus_to_exitcode') else status >> 8
+        print('%s %s: exit %d, %.1f s, %.0f MB' % (
+            os.path.basename(run['directory']), ' '.join(run['params']),
+            run['status'], run['wall'], run['rss']))
+        sys.stdout.flush()
+
+    table = os.path.join(output, 'sweep.txt')
+    with open(table, 'w') as out:
+        out.write('Run Algorithm Scenario BandWidth Seed Exit WallTime '
+                  'PeakRSS Events EventsPerSecond Clients AvgBitrate '
+                  'Switches Rebuffers RebufferTime StartupDelay Handovers '
+                  'HandoverRebufferTime\n')
+        for run in runs:
+            clients, qoe = run_qoe(run['directory'])
+            events, rate = run_runtime(run['directory'])
+            out.write('%s %s %d %.1f %.0f %d %.0f %d %.0f %.2f %.2f %.3f '
+                      '%.3f %.2f %.3f\n' % (
+                          os.path.basename(run['directory']),
+                          ' '.join(run['params']), run['status'],
+                          run['wall'], run['rss'], events, rate, clients,
+                          qoe[0], qoe[1], qoe[2], qoe[3], qoe[4], qoe[5],
+                          qoe[6]))
+    print('%d runs on %d processes in %.1f s, written to %s' % (
+        len(runs), options.jobs, time.time() - start_all, table))
+    return 0 if all(run['status'] == 0 for run in runs) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())